@@ -0,0 +1,289 @@
+// End-to-end benchmark: synthetic supercell scaling suite for the spin configuration search.
+//
+// Every bundled example structure is expanded into N x M x K supercells in memory and the
+// read, symmetry, search and write phases are timed at increasing magnetic-site counts and
+// thread counts. One JSON object is emitted per measurement so release-to-release results
+// can be diffed or loaded straight into a spreadsheet/pandas.
+
+#include "amcheck.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <array>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#ifndef AMCHECK_EXAMPLE_DIR
+#define AMCHECK_EXAMPLE_DIR "example_input"
+#endif
+
+using namespace amcheck;
+
+namespace {
+
+struct BenchArguments {
+    std::string example_dir = AMCHECK_EXAMPLE_DIR;
+    std::vector<std::string> structures = {"FeF2", "BaMnO3", "Mn5Si3", "YMnO3"};
+    std::vector<std::array<int, 3>> supercells = {{1, 1, 1}, {1, 1, 2}, {1, 2, 2}, {2, 2, 2}};
+    std::vector<unsigned int> threads;
+    size_t max_configurations = 1 << 14;
+    double tolerance = DEFAULT_TOLERANCE;
+    std::string output;
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Peak resident set size of the whole process in kilobytes (0 where unsupported)
+long peak_rss_kb() {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+    return usage.ru_maxrss;         // kilobytes on Linux
+#endif
+#endif
+}
+
+std::vector<std::string> split_list(const std::string& value, char separator = ',') {
+    std::vector<std::string> items;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, separator)) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+std::string to_poscar_text(const CrystalStructure& structure) {
+    // Round-trip through write_vasp_file's format so the read phase parses realistic input
+    std::ostringstream out;
+    out << "supercell\n1.0\n" << std::fixed << std::setprecision(10);
+    for (int i = 0; i < 3; ++i) {
+        out << "  " << structure.cell(i, 0) << "  " << structure.cell(i, 1) << "  " << structure.cell(i, 2) << "\n";
+    }
+
+    std::vector<std::string> elements;
+    std::vector<int> counts;
+    for (const auto& atom : structure.atoms) {
+        if (elements.empty() || elements.back() != atom.chemical_symbol) {
+            elements.push_back(atom.chemical_symbol);
+            counts.push_back(0);
+        }
+        counts.back()++;
+    }
+    for (const auto& element : elements) out << element << " ";
+    out << "\n";
+    for (int count : counts) out << count << " ";
+    out << "\nDirect\n";
+    for (const auto& atom : structure.atoms) {
+        out << "  " << atom.position[0] << "  " << atom.position[1] << "  " << atom.position[2] << "\n";
+    }
+    return out.str();
+}
+
+void print_usage() {
+    std::cout << "Usage: amcheck_bench [OPTIONS]\n"
+              << "   --example-dir <dir>      Directory with the bundled *.poscar files\n"
+              << "                            (default: " << AMCHECK_EXAMPLE_DIR << ")\n"
+              << "   --structures <a,b,...>   Structures to benchmark (default: FeF2,BaMnO3,Mn5Si3,YMnO3)\n"
+              << "   --supercells <NxMxK,...> Supercells to build (default: 1x1x1,1x1x2,1x2x2,2x2x2)\n"
+              << "   --threads <1,2,4,...>    Thread counts (default: powers of two up to all cores)\n"
+              << "   --max-configs <n>        Configurations per strong-scaling run (default: 16384)\n"
+              << "   -t, --tolerance <value>  Numerical tolerance (default: " << DEFAULT_TOLERANCE << ")\n"
+              << "   -o, --output <file>      Write JSON lines to file instead of stdout\n";
+}
+
+BenchArguments parse_arguments(int argc, char* argv[]) {
+    BenchArguments args;
+
+    auto require_value = [&](int& i, const std::string& name) -> std::string {
+        if (i + 1 >= argc) {
+            throw std::invalid_argument(name + " requires a value");
+        }
+        return argv[++i];
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            print_usage();
+            std::exit(0);
+        } else if (arg == "--example-dir") {
+            args.example_dir = require_value(i, arg);
+        } else if (arg == "--structures") {
+            args.structures = split_list(require_value(i, arg));
+        } else if (arg == "--supercells") {
+            args.supercells.clear();
+            for (const auto& item : split_list(require_value(i, arg))) {
+                std::vector<std::string> dims = split_list(item, 'x');
+                if (dims.size() != 3) {
+                    throw std::invalid_argument("Supercell must look like NxMxK: " + item);
+                }
+                args.supercells.push_back({std::stoi(dims[0]), std::stoi(dims[1]), std::stoi(dims[2])});
+            }
+        } else if (arg == "--threads") {
+            args.threads.clear();
+            for (const auto& item : split_list(require_value(i, arg))) {
+                args.threads.push_back(static_cast<unsigned int>(std::stoul(item)));
+            }
+        } else if (arg == "--max-configs") {
+            args.max_configurations = std::stoull(require_value(i, arg));
+        } else if (arg == "-t" || arg == "--tolerance") {
+            args.tolerance = std::stod(require_value(i, arg));
+        } else if (arg == "-o" || arg == "--output") {
+            args.output = require_value(i, arg);
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+
+    if (args.threads.empty()) {
+        const unsigned int max_threads = resolve_thread_count(0);
+        for (unsigned int t = 1; t < max_threads; t *= 2) {
+            args.threads.push_back(t);
+        }
+        args.threads.push_back(max_threads);
+    }
+    std::sort(args.threads.begin(), args.threads.end());
+    args.threads.erase(std::unique(args.threads.begin(), args.threads.end()), args.threads.end());
+
+    if (args.max_configurations == 0) {
+        throw std::invalid_argument("--max-configs must be positive");
+    }
+
+    return args;
+}
+
+struct PhaseTimes {
+    double read = 0.0;
+    double symmetry = 0.0;
+    double write = 0.0;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        BenchArguments args = parse_arguments(argc, argv);
+
+        std::ofstream file_out;
+        if (!args.output.empty()) {
+            file_out.open(args.output);
+            if (!file_out.is_open()) {
+                throw std::runtime_error("Cannot create output file: " + args.output);
+            }
+        }
+        std::ostream& out = args.output.empty() ? std::cout : file_out;
+        out << std::setprecision(6);
+
+        const std::filesystem::path scratch_dir = std::filesystem::temp_directory_path();
+        const unsigned int max_threads = args.threads.back();
+
+        for (const auto& name : args.structures) {
+            CrystalStructure parent;
+            parent.read_from_file((std::filesystem::path(args.example_dir) / (name + ".poscar")).string());
+
+            for (const auto& dims : args.supercells) {
+                PhaseTimes phases;
+                const std::string label = std::to_string(dims[0]) + "x" + std::to_string(dims[1]) + "x" + std::to_string(dims[2]);
+
+                // Read: parse the supercell from an in-memory POSCAR
+                const std::string poscar_text = to_poscar_text(make_supercell(parent, dims[0], dims[1], dims[2]));
+                auto start = std::chrono::steady_clock::now();
+                CrystalStructure structure;
+                std::istringstream poscar_stream(poscar_text);
+                structure.read_from_stream(poscar_stream);
+                phases.read = seconds_since(start);
+
+                // Symmetry
+                start = std::chrono::steady_clock::now();
+                analyze_symmetry(structure, args.tolerance);
+                phases.symmetry = seconds_since(start);
+
+                const std::vector<size_t> magnetic_indices = get_magnetic_atom_indices(structure);
+                if (magnetic_indices.empty() || magnetic_indices.size() >= 64) {
+                    std::cerr << "Skipping " << name << " " << label << ": "
+                              << magnetic_indices.size() << " magnetic sites\n";
+                    continue;
+                }
+                const size_t space_size = static_cast<size_t>(1) << std::min<size_t>(magnetic_indices.size(), 63);
+                const size_t strong_configs = std::min(space_size, args.max_configurations);
+                const size_t weak_configs_per_thread = std::max<size_t>(1, strong_configs / max_threads);
+
+                double strong_baseline = 0.0;
+                double weak_baseline = 0.0;
+                std::vector<SpinConfiguration> last_results;
+
+                for (unsigned int threads : args.threads) {
+                    SearchOptions options;
+                    options.num_threads = threads;
+
+                    // Strong scaling: fixed total work
+                    options.max_configurations = strong_configs;
+                    start = std::chrono::steady_clock::now();
+                    last_results = run_spin_search(structure, magnetic_indices, args.tolerance, options);
+                    const double strong_time = seconds_since(start);
+                    if (strong_baseline == 0.0) strong_baseline = strong_time * args.threads.front();
+
+                    // Weak scaling: fixed work per thread
+                    options.max_configurations = std::min(space_size, weak_configs_per_thread * threads);
+                    start = std::chrono::steady_clock::now();
+                    run_spin_search(structure, magnetic_indices, args.tolerance, options);
+                    const double weak_time = seconds_since(start);
+                    if (weak_baseline == 0.0) weak_baseline = weak_time;
+
+                    out << "{\"structure\":\"" << name << "\""
+                        << ",\"supercell\":\"" << label << "\""
+                        << ",\"atoms\":" << structure.atoms.size()
+                        << ",\"magnetic_sites\":" << magnetic_indices.size()
+                        << ",\"symmetry_operations\":" << structure.symmetry_operations.size()
+                        << ",\"threads\":" << threads
+                        << ",\"configurations\":" << strong_configs
+                        << ",\"altermagnetic\":" << last_results.size()
+                        << ",\"read_s\":" << phases.read
+                        << ",\"symmetry_s\":" << phases.symmetry
+                        << ",\"search_s\":" << strong_time
+                        << ",\"configs_per_s\":" << (strong_time > 0.0 ? strong_configs / strong_time : 0.0)
+                        << ",\"strong_efficiency\":" << (strong_time > 0.0 ? strong_baseline / (threads * strong_time) : 0.0)
+                        << ",\"weak_configurations\":" << options.max_configurations
+                        << ",\"weak_search_s\":" << weak_time
+                        << ",\"weak_efficiency\":" << (weak_time > 0.0 ? weak_baseline / weak_time : 0.0);
+
+                    // Write: structure file plus results file, once per supercell
+                    if (threads == max_threads) {
+                        const std::string stem = (scratch_dir / ("amcheck_bench_" + name + "_" + label)).string();
+                        start = std::chrono::steady_clock::now();
+                        structure.write_vasp_file(stem + ".vasp");
+                        write_search_results(stem + "_results.txt", structure, last_results,
+                                             strong_configs, args.tolerance, "CPU");
+                        phases.write = seconds_since(start);
+                        std::filesystem::remove(stem + ".vasp");
+                        std::filesystem::remove(stem + "_results.txt");
+                        out << ",\"write_s\":" << phases.write;
+                    }
+
+                    out << ",\"peak_rss_kb\":" << peak_rss_kb() << "}\n" << std::flush;
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,20 +1,20 @@
 #!/usr/bin/gnuplot
 # Auto-generated gnuplot script by AMCheck C++
-# Generated for: BAND.dat
+# Generated for: /root/repo/example_input/BAND.dat
 
 # Terminal setup for high-resolution PDF output
 set terminal pdf enhanced color size 5,4 font 'Arial,12' linewidth 1.5
-set output 'BAND_bands.pdf'
+set output '/root/repo/example_input/BAND_bands.pdf'
 # Increase rendering resolution for better zooming
 set samples 1000
 set isosamples 100
 
 # Plot settings
 set zeroaxis ls 1.5 dt 2 lw 2.5 lc rgb "gray"
+set zeroaxis ls 1.5 dt 2 lw 2.5 lc rgb "gray"
 set arrow from 0.000,graph(0,0) to 0.000,graph(1,1) nohead ls 1 lt 1 lw 2 lc rgb "gray"
 set arrow from 0.691,graph(0,0) to 0.691,graph(1,1) nohead ls 1 dt 2 lt 1 lw 2 lc rgb "gray"
 set arrow from 1.382,graph(0,0) to 1.382,graph(1,1) nohead ls 1 dt 2 lt 1 lw 2 lc rgb "gray"
-set zeroaxis ls 1.5 dt 2 lw 2.5 lc rgb "gray"
 set xtics font "Arial-Bold,15"
 set ytics font "Arial-Bold,15"
 # Axes tics and labels
@@ -33,13 +33,13 @@ set lmargin 12
 # Find y range dynamically
 min_energy = 1e10
 max_energy = -1e10
-stats 'BAND_bands_with_arrows.dat' using 2 nooutput
+stats '/root/repo/example_input/BAND_bands_with_arrows.dat' using 2 nooutput
 min_energy = STATS_min
-stats 'BAND_bands_with_arrows.dat' using 3 nooutput
+stats '/root/repo/example_input/BAND_bands_with_arrows.dat' using 3 nooutput
 if (STATS_min < min_energy) min_energy = STATS_min
-stats 'BAND_bands_with_arrows.dat' using 2 nooutput
+stats '/root/repo/example_input/BAND_bands_with_arrows.dat' using 2 nooutput
 max_energy = STATS_max
-stats 'BAND_bands_with_arrows.dat' using 3 nooutput
+stats '/root/repo/example_input/BAND_bands_with_arrows.dat' using 3 nooutput
 if (STATS_max > max_energy) max_energy = STATS_max
 margin = (max_energy - min_energy) * 0.05
 set yrange [-1:1]
@@ -55,9 +55,9 @@ set pointsize 1.5
 
 # Plot the data
 plot \
-    'BAND_bands_with_arrows.dat' using 1:2 with lines lc rgb 'red' lw 2.5 title 'Spin Up', \
-    'BAND_bands_with_arrows.dat' using 1:3 with lines lc rgb 'black' lw 2.5 title 'Spin Down', \
-    'BAND_bands_with_arrows.dat' using ( $1 ):( $5 ):( 0 ):( $6 - $5 ) with vectors nohead lc rgb 'blue' lw 1.5 title 'Max Splitting', \
-    'BAND_bands_with_arrows.dat' using 1:5:(sprintf('')) with points pt 7 ps 0.5 lc rgb 'blue' notitle, \
-    'BAND_bands_with_arrows.dat' using 1:6:(sprintf('')) with points pt 7 ps 0.5 lc rgb 'blue' notitle, \
-    'BAND_bands_with_arrows.dat' using 1:($5 + ($6-$5)/2):7 with labels offset 6,0 font 'Arial,13' tc rgb 'blue' notitle
+    '/root/repo/example_input/BAND_bands_with_arrows.dat' using 1:2 with lines lc rgb 'red' lw 2.5 title 'Spin Up', \
+    '/root/repo/example_input/BAND_bands_with_arrows.dat' using 1:3 with lines lc rgb 'black' lw 2.5 title 'Spin Down', \
+    '/root/repo/example_input/BAND_bands_with_arrows.dat' using ( $1 ):( $5 ):( 0 ):( $6 - $5 ) with vectors nohead lc rgb 'blue' lw 1.5 title 'Max Splitting', \
+    '/root/repo/example_input/BAND_bands_with_arrows.dat' using 1:5:(sprintf('')) with points pt 7 ps 0.5 lc rgb 'blue' notitle, \
+    '/root/repo/example_input/BAND_bands_with_arrows.dat' using 1:6:(sprintf('')) with points pt 7 ps 0.5 lc rgb 'blue' notitle, \
+    '/root/repo/example_input/BAND_bands_with_arrows.dat' using 1:($5 + ($6-$5)/2):7 with labels offset 6,0 font 'Arial,13' tc rgb 'blue' notitle
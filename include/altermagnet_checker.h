@@ -0,0 +1,116 @@
+#pragma once
+
+#include "amcheck.h"
+#include <cstdint>
+
+namespace amcheck {
+
+// Outcome of one spin pattern, mirroring is_altermagnet() without exceptions
+enum class CheckOutcome {
+    NOT_ALTERMAGNET,
+    ALTERMAGNET,
+    INVALID     // is_altermagnet() would throw (unbalanced orbit or nothing to check)
+};
+
+std::string outcome_to_string(CheckOutcome outcome);
+
+// Precomputed form of is_altermagnet().
+//
+// Every geometric predicate used by check_altermagnetism_orbit() depends only on the
+// structure, never on the spins, so it is evaluated once per orbit and stored as a bitmask
+// over symmetry operations. Evaluating a spin pattern is then pure integer work and
+// performs no heap allocation once a thread has warmed up.
+class AltermagnetChecker {
+public:
+    AltermagnetChecker(
+        const std::vector<SymmetryOperation>& symops,
+        const std::vector<Vector3d>& positions,
+        const std::vector<int>& equiv_atoms,
+        double tol = DEFAULT_TOLERANCE
+    );
+    AltermagnetChecker(const CrystalStructure& structure, double tol = DEFAULT_TOLERANCE);
+
+    CheckOutcome evaluate(const std::vector<SpinType>& spins) const;
+
+    // Single-orbit verdict (same semantics as check_altermagnetism_orbit)
+    bool check_orbit(size_t orbit, const std::vector<SpinType>& spins) const;
+
+    size_t num_orbits() const { return orbits_.size(); }
+    size_t num_operations() const { return num_ops_; }
+    const std::vector<size_t>& orbit_sites(size_t orbit) const { return orbits_[orbit].sites; }
+
+    // The precomputed geometry, by positions i and j in orbit_sites(): whether operation op maps
+    // site i onto site j, and whether (for i < j) it relates the pair by inversion through their
+    // midpoint or by a pure translation
+    bool maps_onto(size_t orbit, size_t i, size_t j, size_t op) const {
+        return test_bit(orbits_[orbit].match, orbits_[orbit].sites.size(), i, j, op);
+    }
+    bool relates(size_t orbit, size_t i, size_t j, size_t op) const {
+        return test_bit(orbits_[orbit].related, orbits_[orbit].sites.size(), i, j, op);
+    }
+
+private:
+    struct Orbit {
+        std::vector<size_t> sites;      // atom indices belonging to the orbit
+        std::vector<uint64_t> match;    // [i][j] ops mapping site i onto site j
+        std::vector<uint64_t> related;  // [i][j], i < j: inversion/translation ops pairing i and j
+    };
+
+    const uint64_t* mask(const std::vector<uint64_t>& table, size_t n, size_t i, size_t j) const {
+        return table.data() + (i * n + j) * words_;
+    }
+    bool test_bit(const std::vector<uint64_t>& table, size_t n, size_t i, size_t j, size_t op) const {
+        return (mask(table, n, i, j)[op / 64] >> (op % 64)) & 1;
+    }
+
+    size_t num_ops_;
+    size_t words_;
+    double tol_;
+    std::vector<Orbit> orbits_;
+};
+
+// AltermagnetChecker state for enumerations that change one site per step (the Gray-code walk
+// of run_spin_search). Up/down counts per orbit are updated on every flip, and an orbit's
+// verdict is recomputed only when one of its sites changed and it is balanced; every other orbit
+// keeps its cached verdict. Within the changed orbit the bitmask path of check_orbit() is reused:
+// it costs O(n^2) word operations, less than keeping per-operation counters up to date.
+class IncrementalChecker {
+public:
+    explicit IncrementalChecker(const AltermagnetChecker& checker);
+
+    // Full state for a new starting pattern
+    void reset(const std::vector<SpinType>& spins);
+
+    // UP <-> DOWN on one atom; NONE sites are never flipped
+    void flip(size_t atom);
+
+    // Same result as AltermagnetChecker::evaluate(spins())
+    CheckOutcome outcome();
+
+    const std::vector<SpinType>& spins() const { return spins_; }
+
+private:
+    struct OrbitState {
+        int up = 0;
+        int down = 0;
+        bool dirty = true;
+        bool altermagnetic = false;   // valid when counted in checked_ and not dirty
+    };
+
+    bool eligible(const OrbitState& state) const {
+        return (state.up > 0 || state.down > 0) && state.up == state.down;
+    }
+    void account(size_t orbit, int sign);
+
+    const AltermagnetChecker& checker_;
+    std::vector<SpinType> spins_;
+    std::vector<size_t> orbit_of_;     // atom -> orbit (multi-site orbits only; SIZE_MAX otherwise)
+    std::vector<OrbitState> orbits_;
+    std::vector<size_t> dirty_;
+    bool all_orbits_single_ = true;
+    int unbalanced_ = 0;               // magnetic multi-site orbits with up != down
+    int checked_ = 0;                  // magnetic multi-site orbits with up == down
+    int altermagnetic_ = 0;            // of those, with an up-to-date altermagnetic verdict
+};
+
+} // namespace amcheck
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "amcheck.h"
+#include "sat_solver.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace amcheck {
+
+// Exact existence query for -a (--exists): is any UP/DOWN ordering of the magnetic sites
+// altermagnetic, and if so, which one?
+//
+// The verdict of AltermagnetChecker is encoded as a SAT problem with one variable per magnetic
+// site (per free block under --constrain), for each orbit with magnetic sites:
+//   * balance: exactly half of its magnetic sites point up (sequential counter)
+//   * s_g for every operation g: g maps each magnetic site onto an antiparallel one
+//   * "altermagnetic": some s_g holds, every magnetic site is paired with an antiparallel site
+//     by a surviving operation, and some magnetic site is in no antiparallel pair related by a
+//     surviving inversion or pure translation
+// and at least one orbit must be altermagnetic. The geometry comes from the checker's
+// precomputed tables, so the encoding agrees with the search at the same tolerance. Reversing
+// every spin maps altermagnets onto altermagnets, so without constraints the first magnetic
+// site is fixed UP. A witness is re-checked with AltermagnetChecker before it is reported.
+enum class ExistenceStatus {
+    WITNESS,      // an altermagnetic ordering was found
+    INFEASIBLE,   // the solver refuted the encoding: no ordering is altermagnetic
+    UNKNOWN       // the time budget ran out first
+};
+
+struct ExistenceResult {
+    ExistenceStatus status = ExistenceStatus::UNKNOWN;
+    std::vector<SpinType> spins;            // witness, one entry per atom
+    std::vector<int> altermagnetic_orbits;  // orbit numbers (orbit_numbers()) split by the witness
+    std::string reason;                     // infeasible before any search, e.g. an odd orbit
+    size_t num_magnetic_atoms = 0;
+    std::string constraints;                // ConstrainedSpace::describe(), empty without constraints
+    int variables = 0;
+    size_t clauses = 0;
+    SatSolver::Statistics solver;
+    double encode_s = 0.0;
+    double solve_s = 0.0;
+    std::string cnf_file;                   // written when a proof stem was given
+    std::string proof_file;
+};
+
+// Uses options.magnetic, options.constraints and options.time_budget_s. With proof_stem set,
+// the formula goes to <stem>.cnf and the solver's DRAT proof to <stem>.drat.
+ExistenceResult find_altermagnetic_ordering(
+    const CrystalStructure& structure,
+    double tolerance,
+    const SearchOptions& options,
+    const std::string& proof_stem = ""
+);
+
+void print_existence_result(const ExistenceResult& result, std::ostream& out);
+
+} // namespace amcheck
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <map>
@@ -9,6 +10,8 @@
 #include <future>
 #include <atomic>
 #include <mutex>
+#include <functional>
+#include <iosfwd>
 #include <Eigen/Dense>
 
 #ifdef HAVE_SPGLIB
@@ -47,12 +50,16 @@ struct CrystalStructure {
     std::vector<SymmetryOperation> symmetry_operations;
     
     void read_from_file(const std::string& filename);
+    void read_from_stream(std::istream& in);
     void write_vasp_file(const std::string& filename) const;
     Vector3d get_scaled_position(size_t atom_index) const;
     std::vector<Vector3d> get_all_scaled_positions() const;
     int get_atomic_number(const std::string& element) const;
 };
 
+// Builds an na x nb x nc supercell; fractional positions are rescaled into the new cell
+CrystalStructure make_supercell(const CrystalStructure& structure, int na, int nb, int nc);
+
 // Function declarations
 Vector3d bring_in_cell(const Vector3d& r, double tol = DEFAULT_TOLERANCE);
 
@@ -77,6 +84,8 @@ bool is_altermagnet(
 );
 
 std::vector<SpinType> input_spins(int num_atoms);
+void assign_spins_interactively(CrystalStructure& structure);
+void assign_magnetic_moments_interactively(CrystalStructure& structure);
 
 Matrix3d label_matrix(const Matrix3d& m, double tol = 1e-3);
 
@@ -90,37 +99,215 @@ SpinType string_to_spin(const std::string& s);
 
 // Magnetic atom detection and filtering
 bool is_magnetic_element(const std::string& chemical_symbol);
+
+// User-defined magnetic sublattice (--magnetic, --magnetic-orbits, --moments). The default
+// element list also counts ligands such as O and F, which multiplies the search space by 2 per
+// ligand site; an explicit selection keeps only the real magnetic sites.
+struct MagneticSelection {
+    std::vector<std::string> species;       // only atoms of these elements ...
+    std::vector<int> orbits;                // ... or of these orbits (numbers from orbit_numbers())
+    std::map<std::string, double> moments;  // moment priors in Bohr magnetons, per element
+
+    bool is_default() const { return species.empty() && orbits.empty() && moments.empty(); }
+};
+
+// Priors smaller than this mark an element as non-magnetic
+constexpr double MIN_MAGNETIC_MOMENT = 0.5;
+
 std::vector<size_t> get_magnetic_atom_indices(const CrystalStructure& structure);
+std::vector<size_t> get_magnetic_atom_indices(const CrystalStructure& structure,
+                                              const MagneticSelection& selection);
 std::vector<size_t> get_magnetic_orbit_indices(const CrystalStructure& structure);
-void assign_spins_to_magnetic_atoms_only(CrystalStructure& structure);
+
+// 1-based orbit number of every atom, counting orbits in ascending equivalent_atoms order. The
+// labels themselves are representative atoms with spglib but element indices in the fallback.
+std::vector<int> orbit_numbers(const CrystalStructure& structure);
+std::map<std::string, double> parse_moment_priors(const std::string& text);
+std::string describe_magnetic_selection(const MagneticSelection& selection);
+void assign_spins_to_magnetic_atoms_only(CrystalStructure& structure,
+                                         const MagneticSelection& selection = MagneticSelection());
+
+// Non-interactive spin assignment (--spins, --magmom) for unattended standard-mode runs
+struct SpinSource {
+    std::string pattern;        // u/d/n per atom or per magnetic site, inline or a file name
+    std::string moments_file;   // INCAR (MAGMOM), OUTCAR or vasprun.xml (final moments)
+    double threshold = MIN_MAGNETIC_MOMENT;  // |m| below this many muB -> no spin
+
+    bool empty() const { return pattern.empty() && moments_file.empty(); }
+};
+
+std::vector<double> parse_magmom(const std::string& value);
+std::vector<double> read_magnetic_moments(const std::string& filename);
+std::vector<SpinType> spins_from_moments(const std::vector<double>& moments, size_t num_atoms, double threshold);
+std::vector<SpinType> parse_spin_pattern(const std::string& text);
+// Spins for structure from source without printing; moments_path receives the moments file read
+std::vector<SpinType> spins_from_source(
+    const CrystalStructure& structure,
+    const SpinSource& source,
+    const MagneticSelection& selection,
+    const std::string& structure_filename,
+    std::string* moments_path = nullptr
+);
+void assign_spins_from_source(
+    CrystalStructure& structure,
+    const SpinSource& source,
+    const MagneticSelection& selection,
+    const std::string& structure_filename
+);
 
 // Multithreaded spin configuration search
 struct SpinConfiguration {
     std::vector<SpinType> spins;
     bool is_altermagnetic;
     size_t configuration_id;
+    uint64_t altermagnetic_at = 0;         // tolerance sweep: bit k = altermagnetic at tolerances[k]
+    std::vector<double> flip_tolerances;   // tolerance sweep: where the verdict changes (ToleranceSweep)
+};
+
+// Per-configuration evaluator used by run_spin_search()
+enum class SearchEngine {
+    REFERENCE,  // is_altermagnet() on every configuration
+    TABLE       // AltermagnetChecker: geometry precomputed once as per-orbit bitmasks
+};
+
+std::string engine_to_string(SearchEngine engine);
+SearchEngine string_to_engine(const std::string& name);
+
+// What search_all_spin_configurations() does when the structure has more than
+// LARGE_SEARCH_MAGNETIC_ATOMS magnetic atoms
+enum class LargeSearchPolicy {
+    ASK,         // prompt on a terminal; sample when stdin is not interactive
+    SAMPLE,      // evenly spread subset of the configuration space
+    EXHAUSTIVE,  // full search (still bounded by the time budget and --max-configs)
+    ABORT        // refuse with an error
+};
+
+constexpr size_t LARGE_SEARCH_MAGNETIC_ATOMS = 20;
+constexpr size_t DEFAULT_SAMPLE_CONFIGURATIONS = 1000000;
+
+std::string large_policy_to_string(LargeSearchPolicy policy);
+LargeSearchPolicy string_to_large_policy(const std::string& name);
+
+// Search engine options shared by the CLI search and the benchmark harness
+struct SearchOptions {
+    unsigned int num_threads = 0;     // 0 = one worker per hardware thread
+    size_t max_configurations = 0;    // 0 = test the full 2^N configuration space
+    double time_budget_s = 0.0;       // 0 = no limit; otherwise stop and keep the partial result
+    bool spread_order = false;        // visit ids in a scrambled order, so any prefix is an even sample
+    LargeSearchPolicy on_large = LargeSearchPolicy::ASK;
+    MagneticSelection magnetic;       // which sites get a spin; default: is_magnetic_element()
+    SearchEngine engine = SearchEngine::TABLE;
+    bool pin_threads = false;         // pin worker i to the i-th CPU of the affinity mask (Linux)
+    bool quiet = false;               // no per-hit or progress console output from the workers
+    double progress_interval_s = 0.25; // how often the reporter thread calls the progress callback
+    std::string status_file;          // JSON status file or named pipe, updated while searching
+    double status_interval_s = 1.0;   // minimum seconds between status file updates
+    bool ternary = false;             // UP, DOWN or NONE per site; ids are base 3 (see TernarySpace)
+    bool symmetry_dedup = true;       // with ternary: only the smallest id of each symmetry class
+    std::string constraints;          // ConstrainedSpace statements; only matching patterns are generated
+    std::vector<double> tolerances;   // tolerance sweep: verdicts at each of these in one pass (table engine)
+    bool gray_walk = true;            // table engine, full binary space in natural order: visit ids in
+                                      // Gray-code order, one site flip and one orbit re-check per step
+};
+
+// Snapshot assembled by the progress reporter thread from per-worker counters
+struct SearchProgress {
+    size_t completed = 0;
+    size_t found = 0;
+    size_t total = 0;
+    double elapsed_s = 0.0;
+    bool finished = false;
+    bool budget_exhausted = false;    // stopped by time_budget_s before reaching total
+    std::vector<size_t> thread_completed;
 };
 
 void search_all_spin_configurations(
     const CrystalStructure& structure,
     const std::string& input_filename,
     double tolerance = DEFAULT_TOLERANCE,
-    bool verbose = false
+    bool verbose = false,
+    bool use_gpu = true,
+    const SearchOptions& options = SearchOptions()
+);
+
+using FoundCallback = std::function<void(const SpinConfiguration&)>;
+using ProgressCallback = std::function<void(const SearchProgress&)>;
+
+// CPUs this process may actually use. hardware_concurrency() reports the host inside containers
+// and cgroup-limited batch jobs, so the affinity mask and the cgroup v1/v2 CPU quota are applied.
+struct CpuBudget {
+    unsigned int hardware = 1;       // std::thread::hardware_concurrency()
+    unsigned int affinity = 0;       // CPUs in the sched_getaffinity mask (0 = unknown)
+    double cgroup_quota = 0.0;       // quota / period in CPUs (0 = unlimited or unknown)
+    unsigned int environment = 0;    // AMCHECK_NUM_THREADS (0 = unset)
+    unsigned int available = 1;      // min of hardware, affinity and rounded-up quota
+};
+
+CpuBudget detect_cpu_budget();
+std::string describe_cpu_budget(const CpuBudget& budget);
+
+// requested > 0 wins, then AMCHECK_NUM_THREADS, then the detected CPU budget
+unsigned int resolve_thread_count(unsigned int requested);
+
+// Pins the calling thread to one CPU of the process affinity mask; false where unsupported
+bool pin_current_thread(size_t worker_index);
+
+// Result file naming: "<stem>_amcheck_<kind>_<timestamp>.txt", stem without directory/extension
+std::string output_file_stem(const std::string& input_filename);
+std::string output_timestamp();
+
+// Writes the UP/DOWN pattern encoded by config_id onto the magnetic sites of spins. Sites past
+// the 64th (only sampled searches reach them) take bits hashed from config_id, so an id still
+// names exactly one pattern.
+void decode_configuration_id(
+    size_t config_id,
+    const std::vector<size_t>& magnetic_indices,
+    std::vector<SpinType>& spins
 );
 
-void perform_smart_sampling_search(
+// 2^n UP/DOWN configurations of n magnetic sites, saturated at SIZE_MAX from 64 sites on; such a
+// space can only be searched partially (--max-configs, --time-budget or --on-large sample)
+size_t binary_space_size(size_t magnetic_atoms);
+
+class TernarySpace;
+class ConstrainedSpace;
+
+// Multithreaded enumeration without console output; results are sorted by configuration id.
+// on_found runs on the worker threads, on_progress on a separate reporter thread. A caller that
+// already built the --ternary space for the same structure, sites, tolerance and
+// options.symmetry_dedup passes it as ternary, so its site group is not computed twice; likewise
+// constrained for options.constraints.
+std::vector<SpinConfiguration> run_spin_search(
     const CrystalStructure& structure,
     const std::vector<size_t>& magnetic_indices,
-    const std::string& input_filename,
     double tolerance,
-    bool verbose,
-    const std::string& acceleration_method
+    const SearchOptions& options = SearchOptions(),
+    const FoundCallback& on_found = nullptr,
+    const ProgressCallback& on_progress = nullptr,
+    const TernarySpace* ternary = nullptr,
+    const ConstrainedSpace* constrained = nullptr
+);
+
+// space_size > total_configurations marks a partial search and adds a coverage line; ternary
+// marks base-3 configuration ids from a --ternary search; tolerance_sweep lists the tolerances
+// of a --tolerances search, whose lines end with per-tolerance verdicts and flip tolerances
+void write_search_results(
+    const std::string& filename,
+    const CrystalStructure& structure,
+    const std::vector<SpinConfiguration>& configs,
+    size_t total_configurations,
+    double tolerance,
+    const std::string& acceleration_method,
+    long double space_size = 0,
+    const TernarySpace* ternary = nullptr,
+    const std::vector<double>& tolerance_sweep = {}
 );
 
 void print_matrix_with_labels(const Matrix3d& m, double tol = 1e-3);
 
 // Utility functions
 bool should_use_unicode();
+bool stdin_is_interactive();
 void print_banner();
 void print_version();
 void print_usage(const std::string& program_name);
@@ -128,6 +315,9 @@ void print_spacegroup_info(const CrystalStructure& structure);
 void print_matrix(const Matrix3d& matrix, const std::string& name = "", int precision = 6);
 void print_hall_vector(const Matrix3d& antisymmetric_tensor);
 
+// Escapes a string for embedding between double quotes in JSON output
+std::string json_escape(const std::string& s);
+
 // GPU availability check
 bool is_gpu_available();
 
@@ -180,6 +370,9 @@ void generate_band_plot_script(const BandAnalysisResult& result, const std::stri
                       const std::pair<double, double>& y_range = {0.0, 0.0},
                       const std::map<double, std::string>& kpoint_labels = {});
 
+// Symmetry analysis (spglib when available, cubic fallback otherwise)
+void analyze_symmetry(CrystalStructure& structure, double tolerance = DEFAULT_TOLERANCE);
+
 // Spglib integration functions
 #ifdef HAVE_SPGLIB
 std::string get_spacegroup_name(const CrystalStructure& structure, double symprec = DEFAULT_TOLERANCE);
@@ -0,0 +1,176 @@
+#ifndef AMCHECK_C_H
+#define AMCHECK_C_H
+
+/*
+ * C interface to the amcheck_core library, for workflow managers (Python ctypes/cffi, Fortran
+ * ISO_C_BINDING, ...) that check many structures in one process instead of running the amcheck
+ * executable per structure and parsing its output.
+ *
+ * Conventions
+ *   - Every function that can fail returns an amcheck_status; AMCHECK_OK is 0. The message of
+ *     the last failure on the calling thread is available from amcheck_last_error().
+ *   - Atoms are numbered from 0. Positions are fractional coordinates; the lattice is 3x3
+ *     row-major with one lattice vector per row, in Angstrom.
+ *   - Spins are one signed byte per atom: +1 up, -1 down, 0 no spin.
+ *   - Configuration ids follow the executable: bit i (or base-3 digit i with ternary) is the
+ *     spin of the i-th magnetic site in atom order.
+ *   - Structure handles may be shared between threads for checks and searches, but not while
+ *     amcheck_analyze_symmetry() runs on the same handle.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(AMCHECK_CORE_SHARED_BUILD)
+#define AMCHECK_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(AMCHECK_CORE_SHARED)
+#define AMCHECK_API __declspec(dllimport)
+#elif defined(__GNUC__)
+#define AMCHECK_API __attribute__((visibility("default")))
+#else
+#define AMCHECK_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AMCHECK_C_API_VERSION 1
+
+typedef enum {
+    AMCHECK_OK = 0,
+    AMCHECK_ERROR_INVALID_ARGUMENT = 1,  /* bad input: null pointer, malformed POSCAR, unknown element,
+                                            bad spins */
+    AMCHECK_ERROR_IO = 2,                /* structure file could not be read */
+    AMCHECK_ERROR_UNSUPPORTED = 3,       /* not available in this build (e.g. without spglib) */
+    AMCHECK_ERROR_INTERNAL = 4           /* any other failure */
+} amcheck_status;
+
+typedef enum {
+    AMCHECK_NOT_ALTERMAGNET = 0,
+    AMCHECK_ALTERMAGNET = 1,
+    AMCHECK_INVALID = 2                  /* an orbit has unequal up and down counts */
+} amcheck_verdict;
+
+typedef enum {
+    AMCHECK_ENGINE_TABLE = 0,            /* precomputed orbit tables (the default) */
+    AMCHECK_ENGINE_REFERENCE = 1         /* is_altermagnet() on every configuration */
+} amcheck_engine;
+
+typedef struct amcheck_structure amcheck_structure;
+
+/* Library version ("1.0.0") and C API revision (AMCHECK_C_API_VERSION of the build) */
+AMCHECK_API const char* amcheck_version(void);
+AMCHECK_API int amcheck_api_version(void);
+
+/* Message of the last failed call on this thread; empty after a successful call */
+AMCHECK_API const char* amcheck_last_error(void);
+
+/* ---- Structures ---------------------------------------------------------------------------- */
+
+/* Builds a structure from arrays. symbols holds num_atoms element symbols ("Mn", "O", ...). */
+AMCHECK_API amcheck_status amcheck_structure_create(
+    const double lattice[9],
+    const double* fractional_positions,  /* num_atoms x 3, row-major */
+    const char* const* symbols,
+    size_t num_atoms,
+    amcheck_structure** out);
+
+/* Reads a POSCAR/VASP file, or a POSCAR given as text. Truncated or malformed input (missing
+   lattice, fewer counts than elements, negative counts, missing positions) returns
+   AMCHECK_ERROR_INVALID_ARGUMENT with the reason in amcheck_last_error(). */
+AMCHECK_API amcheck_status amcheck_structure_read(const char* filename, amcheck_structure** out);
+AMCHECK_API amcheck_status amcheck_structure_parse(const char* poscar_text, amcheck_structure** out);
+
+AMCHECK_API void amcheck_structure_free(amcheck_structure* structure);
+
+AMCHECK_API size_t amcheck_structure_num_atoms(const amcheck_structure* structure);
+
+/* ---- Symmetry ------------------------------------------------------------------------------ */
+
+/* Finds the symmetry operations and orbits (spglib when available). Checks and searches on a
+ * structure without symmetry run this first with their own tolerance. */
+AMCHECK_API amcheck_status amcheck_analyze_symmetry(amcheck_structure* structure, double symprec);
+
+AMCHECK_API size_t amcheck_structure_num_operations(const amcheck_structure* structure);
+
+/* Rotations (num_operations x 9, row-major, fractional) and translations (num_operations x 3);
+ * either pointer may be null */
+AMCHECK_API amcheck_status amcheck_structure_operations(
+    const amcheck_structure* structure, double* rotations, double* translations);
+
+/* Orbit label of every atom (num_atoms entries): atoms with equal labels are equivalent */
+AMCHECK_API amcheck_status amcheck_structure_equivalent_atoms(const amcheck_structure* structure, int* labels);
+
+/* International symbol of the space group; AMCHECK_ERROR_UNSUPPORTED without spglib */
+AMCHECK_API amcheck_status amcheck_structure_spacegroup(
+    const amcheck_structure* structure, char* buffer, size_t buffer_size);
+
+/* Magnetic sites (atom indices) for a comma-separated element list such as "Mn,Fe", or the
+ * default magnetic elements when magnetic is null or empty. Writes at most capacity indices and
+ * always sets *count to the full number. */
+AMCHECK_API amcheck_status amcheck_structure_magnetic_sites(
+    const amcheck_structure* structure, const char* magnetic,
+    size_t* indices, size_t capacity, size_t* count);
+
+/* ---- Checks -------------------------------------------------------------------------------- */
+
+/* One spin pattern (num_atoms bytes) */
+AMCHECK_API amcheck_status amcheck_check(
+    amcheck_structure* structure, const int8_t* spins, double tolerance, amcheck_verdict* verdict);
+
+/* count patterns stored back to back (count x num_atoms bytes), evaluated on num_threads
+ * threads (0 = all available CPUs); verdicts receives count entries */
+AMCHECK_API amcheck_status amcheck_check_batch(
+    amcheck_structure* structure, const int8_t* spins, size_t count, double tolerance,
+    unsigned int num_threads, amcheck_verdict* verdicts);
+
+/* ---- Search -------------------------------------------------------------------------------- */
+
+/* Set struct_size = sizeof(amcheck_search_options) through amcheck_search_options_init();
+ * fields added in later revisions go at the end and take their defaults for older callers. */
+typedef struct {
+    size_t struct_size;
+    unsigned int num_threads;       /* 0 = all available CPUs */
+    uint64_t max_configurations;    /* 0 = the whole space */
+    double time_budget_s;           /* 0 = no limit */
+    int spread_order;               /* nonzero: any prefix of the enumeration is an even sample */
+    int engine;                     /* amcheck_engine */
+    const char* magnetic;           /* comma-separated elements; null = default magnetic elements */
+    const char* constraints;        /* constraint statements as for --constrain; null = none */
+    int ternary;                    /* nonzero: up, down or no spin per site (base-3 ids) */
+    int symmetry_dedup;             /* with ternary: one pattern per symmetry class */
+    double progress_interval_s;     /* how often the progress callback runs */
+} amcheck_search_options;
+
+AMCHECK_API void amcheck_search_options_init(amcheck_search_options* options);
+
+typedef struct {
+    uint64_t total;                 /* configurations scheduled */
+    uint64_t completed;             /* configurations tested */
+    uint64_t found;                 /* altermagnetic configurations */
+    double elapsed_s;
+    int budget_exhausted;           /* stopped by time_budget_s before completing total */
+} amcheck_search_result;
+
+/* Called once per altermagnetic configuration with its id and spins (num_atoms bytes, valid
+ * only during the call). Calls come from worker threads but never overlap. */
+typedef void (*amcheck_found_callback)(uint64_t config_id, const int8_t* spins, size_t num_atoms,
+                                       void* user_data);
+
+/* Called from a reporter thread every progress_interval_s and once at the end */
+typedef void (*amcheck_progress_callback)(uint64_t completed, uint64_t total, uint64_t found,
+                                          void* user_data);
+
+/* Enumerates the spin configurations of the magnetic sites. Either callback may be null; result
+ * may be null. */
+AMCHECK_API amcheck_status amcheck_search(
+    amcheck_structure* structure, double tolerance, const amcheck_search_options* options,
+    amcheck_found_callback on_found, amcheck_progress_callback on_progress, void* user_data,
+    amcheck_search_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AMCHECK_C_H */
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "amcheck.h"
+#include "altermagnet_checker.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace amcheck {
+
+// Distortion sweep (--distort): which displacement patterns switch altermagnetism on or off for
+// a fixed spin pattern.
+//
+// Every mode is applied to the parent structure at every amplitude. The distorted structure is
+// never handed to spglib: its operations are the parent operations it still has (the isotropy
+// subgroup, inherit_subgroup_symmetry()), and the spin pattern is checked against them. Modes
+// and amplitudes are independent and run in parallel.
+//
+// Modes file, one mode per "mode" line ('#' starts a comment):
+//   mode <name> displacement          followed by one "dx dy dz" line per atom (Cartesian, Angstrom,
+//                                     e.g. a phonon eigenvector); amplitude scales the vectors
+//   mode <name> strain exx eyy ezz eyz exz exy
+//                                     symmetric Cartesian strain; the cell becomes (1 + a e) cell
+//   mode <name> tilt <center> ax ay az <cutoff> [qx qy qz]
+//                                     rigid rotation by a degrees about axis (ax, ay, az) of the
+//                                     atoms within cutoff Angstrom of every <center> atom, with the
+//                                     sense cos(2 pi q . x_center) (q in reciprocal cell units, so
+//                                     q = 1/2 along an axis alternates neighbouring cells)
+enum class DistortionKind { DISPLACEMENT, STRAIN, TILT };
+
+struct DistortionMode {
+    std::string name;
+    DistortionKind kind = DistortionKind::DISPLACEMENT;
+    std::vector<Vector3d> displacements;    // DISPLACEMENT: per atom at amplitude 1
+    Matrix3d strain = Matrix3d::Zero();     // STRAIN
+    std::string center;                     // TILT: element at the polyhedron centers
+    Vector3d axis = Vector3d::UnitZ();
+    double cutoff = 0.0;
+    Vector3d wavevector = Vector3d::Zero();
+};
+
+std::string distortion_kind_to_string(DistortionKind kind);
+
+// Throws std::runtime_error with the line number on malformed input
+std::vector<DistortionMode> read_distortion_modes(const std::string& filename, size_t num_atoms);
+
+// "0,0.05,0.1" or "start:stop:count" (count evenly spaced values, ends included)
+std::vector<double> parse_amplitude_list(const std::string& text);
+
+// The parent with the mode applied at the given amplitude; symmetry is not set
+CrystalStructure apply_distortion(const CrystalStructure& parent, const DistortionMode& mode, double amplitude);
+
+struct DistortionStep {
+    size_t mode = 0;
+    double amplitude = 0.0;
+    size_t operations = 0;                  // parent operations kept
+    size_t orbits = 0;
+    CheckOutcome outcome = CheckOutcome::INVALID;
+};
+
+// Steps in mode-major, amplitude-minor order. The parent needs its symmetry (analyze_symmetry());
+// spins has one entry per atom.
+std::vector<DistortionStep> run_distortion_sweep(
+    const CrystalStructure& parent,
+    const std::vector<DistortionMode>& modes,
+    const std::vector<double>& amplitudes,
+    const std::vector<SpinType>& spins,
+    double tolerance,
+    unsigned int num_threads
+);
+
+void print_distortion_sweep(
+    const CrystalStructure& parent,
+    const std::vector<DistortionMode>& modes,
+    const std::vector<double>& amplitudes,
+    const std::vector<DistortionStep>& steps,
+    std::ostream& out
+);
+
+} // namespace amcheck
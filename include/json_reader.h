@@ -0,0 +1,52 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace amcheck {
+
+// Minimal JSON document model for request input (--serve-stdio). Output elsewhere is written
+// directly with json_escape(); this side only needs to read small, trusted-format objects.
+class JsonValue {
+public:
+    enum class Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+    JsonValue() = default;
+
+    Type type() const { return type_; }
+    bool is_null() const { return type_ == Type::NUL; }
+    bool is_bool() const { return type_ == Type::BOOLEAN; }
+    bool is_number() const { return type_ == Type::NUMBER; }
+    bool is_string() const { return type_ == Type::STRING; }
+    bool is_array() const { return type_ == Type::ARRAY; }
+    bool is_object() const { return type_ == Type::OBJECT; }
+
+    // Typed access; throw std::invalid_argument naming the expected type on a mismatch
+    bool as_bool() const;
+    double as_number() const;
+    const std::string& as_string() const;
+    const std::vector<JsonValue>& as_array() const;
+
+    // Object members; find() returns nullptr for a missing key (and for non-objects)
+    const JsonValue* find(const std::string& key) const;
+    const std::map<std::string, JsonValue>& members() const;
+
+    // The value as it appeared in the input, re-serialized compactly (used to echo request ids)
+    std::string to_json() const;
+
+    // Parses one complete document; trailing non-whitespace is an error
+    static JsonValue parse(const std::string& text);
+
+private:
+    friend class JsonParser;
+
+    Type type_ = Type::NUL;
+    bool bool_ = false;
+    double number_ = 0.0;
+    std::string string_;      // also the original spelling of a number, for to_json()
+    std::vector<JsonValue> array_;
+    std::map<std::string, JsonValue> object_;
+};
+
+} // namespace amcheck
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "amcheck.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace amcheck {
+
+// Console output for the search workers.
+//
+// Workers push records onto an intrusive multi-producer/single-consumer queue (one atomic
+// exchange per record, no locks) and return immediately; a dedicated writer thread formats and
+// prints them. Hit lines are rate limited per one-second window and the surplus is summarized
+// as "N more hits in the last second", so dense result sets no longer serialize the workers on
+// stdout. Progress is a latest-value-wins slot rather than a queued record.
+class AsyncLogSink {
+public:
+    using HitFormatter = std::function<void(std::ostream&, const SpinConfiguration&)>;
+
+    struct Options {
+        size_t max_hits_per_second = 20;
+        std::chrono::milliseconds flush_interval{100};
+        size_t progress_total = 0;    // denominator of the progress percentage
+    };
+
+    AsyncLogSink(std::ostream& out, HitFormatter formatter, Options options);
+    AsyncLogSink(std::ostream& out, HitFormatter formatter);
+    ~AsyncLogSink();
+
+    AsyncLogSink(const AsyncLogSink&) = delete;
+    AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+    // Producer side: safe from any thread, never blocks
+    void post_hit(const SpinConfiguration& config);
+    void post_text(std::string text);
+    void update_progress(size_t completed, size_t found);
+
+    // Drains the queue, prints any pending summary and joins the writer thread
+    void finish();
+
+    // Hits that were counted but not printed individually
+    size_t suppressed_hits() const { return suppressed_total_; }
+
+private:
+    struct Record {
+        std::atomic<Record*> next{nullptr};
+        bool is_hit = false;
+        SpinConfiguration hit;
+        std::string text;
+    };
+
+    void push(Record* record);
+    Record* pop();
+    void run();
+    void drain(bool final_pass);
+    void flush_window_summary();
+
+    std::ostream& out_;
+    HitFormatter formatter_;
+    Options options_;
+
+    // Vyukov intrusive MPSC queue: producers exchange head_, the writer owns tail_
+    Record stub_;
+    std::atomic<Record*> head_;
+    Record* tail_;
+
+    std::atomic<size_t> progress_completed_{0};
+    std::atomic<size_t> progress_found_{0};
+    std::atomic<bool> progress_dirty_{false};
+    bool progress_on_screen_ = false;
+
+    size_t window_hits_ = 0;
+    size_t window_suppressed_ = 0;
+    size_t suppressed_total_ = 0;
+    std::chrono::steady_clock::time_point window_start_;
+
+    std::atomic<bool> stop_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::thread writer_;
+};
+
+} // namespace amcheck
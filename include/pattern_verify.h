@@ -0,0 +1,41 @@
+#pragma once
+
+#include "amcheck.h"
+#include <string>
+
+namespace amcheck {
+
+// Bulk verification (--verify-patterns): every spin pattern in a file is checked against one
+// structure, without enumerating the configuration space.
+//
+// Text input, one pattern per line ('#' lines and blank lines are skipped):
+//   Config #      13: n d u d u | ...      *_amcheck_results_*.txt and console output
+//   13 | d u d u                           older result files
+//   d u d u                                one token per atom, or one per magnetic site
+//
+// Binary input, for candidate lists too large for text:
+//   "AMCKPAT1", uint32 LE magnetic site count, uint32 LE reserved (0),
+//   then one uint64 LE configuration id per pattern (bit i set = magnetic site i DOWN)
+//
+// The output has one tab-separated line per input record, in input order:
+//   <line or record number> <verdict> <config id or -> <spin pattern>
+// where verdict is altermagnet, not_altermagnet, invalid (unbalanced orbit) or parse_error.
+struct PatternVerifySummary {
+    size_t records = 0;
+    size_t altermagnets = 0;
+    size_t not_altermagnets = 0;
+    size_t invalid = 0;
+    size_t parse_errors = 0;
+    double elapsed_s = 0.0;
+};
+
+// options supplies the engine, thread count and magnetic sublattice
+PatternVerifySummary verify_spin_patterns(
+    const CrystalStructure& structure,
+    const std::string& patterns_file,
+    const std::string& output_file,
+    double tolerance,
+    const SearchOptions& options = SearchOptions()
+);
+
+} // namespace amcheck
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+
+namespace amcheck {
+
+// Hardware performance counters behind --perf-counters (Linux perf_event_open, user space only,
+// so no root is needed with the default perf_event_paranoid setting). On other platforms, or
+// when the kernel refuses the events, the counters report as unavailable and nothing else changes.
+struct PerfCounterValues {
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    uint64_t cache_misses = 0;
+    uint64_t branch_misses = 0;
+
+    PerfCounterValues& operator+=(const PerfCounterValues& other);
+};
+
+class PerfCounters {
+public:
+    static PerfCounters& instance();
+
+    void enable() { enabled_.store(true, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Adds one thread's measurement of a phase; units are configurations, k-points, ...
+    void accumulate(const std::string& phase, const PerfCounterValues& values, uint64_t units,
+                    std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+    void note_unavailable(const std::string& reason);
+
+    // IPC and misses per unit next to units/s, one line per phase
+    void print_report(std::ostream& out) const;
+
+private:
+    PerfCounters() = default;
+
+    struct PhaseTotals {
+        PerfCounterValues values;
+        uint64_t units = 0;
+        size_t threads = 0;
+        std::chrono::steady_clock::time_point first_start;
+        std::chrono::steady_clock::time_point last_end;
+    };
+
+    std::atomic<bool> enabled_{false};
+    mutable std::mutex mutex_;
+    std::vector<std::string> phase_order_;
+    std::map<std::string, PhaseTotals> phases_;
+    std::string unavailable_reason_;
+};
+
+// Counts the calling thread from construction to destruction when counters are enabled
+class ScopedPerfCounters {
+public:
+    explicit ScopedPerfCounters(const char* phase);
+    ~ScopedPerfCounters();
+
+    ScopedPerfCounters(const ScopedPerfCounters&) = delete;
+    ScopedPerfCounters& operator=(const ScopedPerfCounters&) = delete;
+
+    void add_units(uint64_t units) { units_ += units; }
+
+private:
+    const char* phase_;
+    bool active_ = false;
+    int group_fd_ = -1;
+    std::vector<int> fds_;
+    uint64_t units_ = 0;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace amcheck
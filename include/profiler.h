@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+namespace amcheck {
+
+// Phase-level instrumentation behind --profile and --trace.
+//
+// Spans are recorded only after Profiler::instance().enable(); until then a ScopedSpan costs a
+// single relaxed atomic load, so the instrumentation stays compiled into every build.
+struct ProfileSpan {
+    std::string name;
+    std::string category;       // "phase", "worker" or "structure"
+    std::string detail;         // shown as args.detail in the trace viewer
+    double start_us = 0.0;      // relative to profiler creation
+    double wall_us = 0.0;
+    double cpu_us = 0.0;        // process CPU for phases/structures, thread CPU for workers
+    unsigned int thread_id = 0;
+};
+
+class Profiler {
+public:
+    static Profiler& instance();
+
+    // Call from the main thread so it is reported as thread 0
+    void enable() {
+        current_thread_id();
+        enabled_.store(true, std::memory_order_relaxed);
+    }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    double now_us() const;
+    void record(ProfileSpan span);
+
+    // --profile: aggregated wall/CPU time per phase, per structure and per worker thread
+    void write_profile(const std::string& filename) const;
+    // --trace: Chrome trace-event JSON (chrome://tracing, Perfetto)
+    void write_trace(const std::string& filename) const;
+
+    // Small sequential id for the calling thread (the first thread to ask gets 0)
+    static unsigned int current_thread_id();
+    static double thread_cpu_us();
+    static double process_cpu_us();
+
+private:
+    Profiler();
+
+    std::atomic<bool> enabled_{false};
+    std::chrono::steady_clock::time_point origin_;
+    mutable std::mutex mutex_;
+    std::vector<ProfileSpan> spans_;
+};
+
+// Records one span from construction to destruction when profiling is enabled
+class ScopedSpan {
+public:
+    explicit ScopedSpan(const char* name, const char* category = "phase", std::string detail = "");
+    ~ScopedSpan();
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+private:
+    bool active_;
+    const char* name_;
+    const char* category_;
+    std::string detail_;
+    double start_us_ = 0.0;
+    double start_cpu_us_ = 0.0;
+};
+
+} // namespace amcheck
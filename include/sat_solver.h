@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace amcheck {
+
+// Small CDCL SAT solver for the existence queries of --exists (altermagnet_sat.h).
+//
+// Literals follow the DIMACS convention: variables are numbered from 1 and -v is the negation
+// of v. The search is the usual conflict-driven scheme: two watched literals per clause,
+// first-UIP learning with clause minimization, VSIDS branching with phase saving, Luby restarts,
+// and periodic removal of learned clauses with a high LBD (number of decision levels). Every
+// learned clause follows from the others by unit propagation, so with a proof stream set the
+// solver writes a DRAT proof that standard checkers (drat-trim) verify against write_dimacs().
+class SatSolver {
+public:
+    enum class Result { SATISFIABLE, UNSATISFIABLE, UNKNOWN };
+
+    struct Statistics {
+        size_t decisions = 0;
+        size_t propagations = 0;
+        size_t conflicts = 0;
+        size_t restarts = 0;
+        size_t learned = 0;
+        size_t deleted = 0;
+    };
+
+    int new_variable();
+    int num_variables() const { return static_cast<int>(assigns_.size()); }
+    size_t num_clauses() const { return original_.size(); }
+
+    // Clauses are added before solve(); repeated literals are merged and tautologies dropped.
+    // Throws std::invalid_argument for a literal whose variable does not exist.
+    void add_clause(const std::vector<int>& literals);
+
+    // time_budget_s <= 0: no limit; UNKNOWN when the budget runs out first
+    Result solve(double time_budget_s = 0.0);
+
+    // Variable assignment of the model found by the last SATISFIABLE solve()
+    bool value(int variable) const;
+
+    // DRAT lines for every learned and deleted clause, and the empty clause on UNSATISFIABLE
+    void set_proof(std::ostream* proof) { proof_ = proof; }
+    void write_dimacs(std::ostream& out) const;
+
+    const Statistics& statistics() const { return stats_; }
+
+private:
+    // Internal literals: 2 * (variable - 1), plus 1 for the negation
+    static int internal(int literal) { return literal > 0 ? 2 * (literal - 1) : 2 * (-literal - 1) + 1; }
+    static int external(int lit) { return (lit & 1) ? -(lit / 2 + 1) : lit / 2 + 1; }
+
+    struct Clause {
+        std::vector<int> lits;   // lits[0] is the implied literal when the clause is a reason
+        bool learned = false;
+        bool deleted = false;
+        int lbd = 0;
+        double activity = 0.0;
+    };
+
+    struct Watch {
+        uint32_t clause;
+        int blocker;             // a literal of the clause; when true the clause needs no visit
+    };
+
+    static constexpr int NO_REASON = -1;
+
+    // 1 true, -1 false, 0 unassigned
+    int8_t lit_value(int lit) const {
+        const int8_t v = assigns_[lit >> 1];
+        return (lit & 1) ? static_cast<int8_t>(-v) : v;
+    }
+    int decision_level() const { return static_cast<int>(trail_limits_.size()); }
+
+    void enqueue(int lit, int reason);
+    int propagate();
+    void analyze(int conflict, std::vector<int>& learned, int& backtrack_level, int& lbd);
+    bool redundant(int lit) const;
+    void backtrack(int level);
+    void attach(uint32_t clause);
+    void reduce_learned();
+    void log_clause(const std::vector<int>& lits, bool deletion);
+
+    void bump_variable(int var);
+    void bump_clause(Clause& clause);
+    void heap_insert(int var);
+    void heap_up(size_t index);
+    void heap_down(size_t index);
+    int heap_pop();
+
+    std::vector<std::vector<int>> original_;   // DIMACS literals, for write_dimacs()
+    std::vector<int> units_;                   // internal literals of unit clauses
+    bool empty_clause_ = false;
+
+    std::vector<Clause> clauses_;
+    std::vector<std::vector<Watch>> watches_;  // per literal: clauses watching it
+    std::vector<int8_t> assigns_;
+    std::vector<int8_t> saved_phase_;
+    std::vector<int> levels_;
+    std::vector<int> reasons_;
+    std::vector<int> trail_;
+    std::vector<size_t> trail_limits_;
+    size_t propagated_ = 0;
+    std::vector<char> seen_;
+
+    std::vector<double> activity_;
+    double variable_increment_ = 1.0;
+    double clause_increment_ = 1.0;
+    std::vector<int> heap_;                    // max-heap of variables by activity
+    std::vector<int> heap_position_;           // -1 when not in the heap
+
+    std::vector<bool> model_;
+    size_t learned_count_ = 0;
+    std::ostream* proof_ = nullptr;
+    Statistics stats_;
+};
+
+} // namespace amcheck
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "amcheck.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace amcheck {
+
+// Dry run for -a (--plan): how big the search is and how long it would take here, so node
+// counts and walltimes can be chosen before a job is submitted.
+//
+// Counts are long double because 2^N and the Burnside sums overflow 64 bits for large N; they
+// are exact up to 2^64 on x87 and up to 2^53 where long double is a plain double.
+struct MagneticOrbitPlan {
+    int orbit_number = 0;               // as accepted by --magnetic-orbits
+    size_t first_atom = 0;              // 0-based index of the orbit's first atom
+    std::string element;
+    std::vector<size_t> sites;          // positions in the magnetic site list (config id bits)
+    long double balanced_choices = 0;   // up/down assignments that pass the orbit balance check
+};
+
+struct EngineEstimate {
+    SearchEngine engine = SearchEngine::TABLE;
+    double configs_per_second = 0.0;    // single thread, measured on this structure
+    size_t calibration_configs = 0;
+    bool gray_walk = false;             // table engine timed on the Gray-code walk of a full search
+    std::string error;                  // set when the engine could not be calibrated
+};
+
+struct SearchPlan {
+    size_t num_atoms = 0;
+    size_t num_magnetic_atoms = 0;
+    std::string magnetic_selection;     // describe_magnetic_selection() of the options
+    size_t symmetry_operations = 0;
+    size_t permutation_group_order = 0; // distinct site permutations, closed under composition
+    bool group_truncated = false;       // closure stopped at the size limit; dedup counts are bounds
+
+    std::vector<MagneticOrbitPlan> orbits;
+
+    long double raw_configurations = 0;          // 2^N
+    long double balanced_configurations = 0;     // every multi-site orbit has up == down
+    long double distinct_raw = 0;                // Burnside count under the site permutations
+    long double distinct_balanced = 0;
+    long double distinct_balanced_with_flip = 0; // also identifying global spin reversal
+
+    // --ternary: UP/DOWN/NONE per site; only balanced patterns are enumerated
+    bool ternary = false;
+    long double ternary_raw = 0;                 // 3^N
+    long double ternary_balanced = 0;
+    bool ternary_dedup = false;                  // representatives only (closed group)
+
+    std::string constraints;            // ConstrainedSpace::describe(), empty without constraints
+    long double constrained_configurations = 0;
+
+    size_t planned_configurations = 0;  // after --max-configs
+    double time_budget_s = 0.0;
+    unsigned int threads = 1;
+    std::vector<EngineEstimate> engines;
+};
+
+// calibration_s is spent per engine on a single-thread run of the real search kernel
+SearchPlan plan_spin_search(
+    const CrystalStructure& structure,
+    double tolerance,
+    const SearchOptions& options,
+    double calibration_s = 0.25
+);
+
+void print_search_plan(const SearchPlan& plan, std::ostream& out);
+
+} // namespace amcheck
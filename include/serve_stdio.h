@@ -0,0 +1,44 @@
+#pragma once
+
+#include "amcheck.h"
+#include <iosfwd>
+#include <string>
+
+namespace amcheck {
+
+// Request server for workflow engines (--serve-stdio): one JSON object per input line, one JSON
+// object per response line. Requests run concurrently on a fixed pool of worker threads and
+// responses are written as they complete, so they can arrive out of order; every response echoes
+// the request's "id".
+//
+// Request members (all optional except a structure):
+//   "id"                       any JSON value, copied into the response
+//   "structure"                path of a POSCAR file, or
+//   "poscar"                   POSCAR contents, or
+//   "lattice", "positions",    3x3 lattice (rows in Angstrom), fractional positions and
+//   "symbols"                  element symbols
+//   "symprec", "tolerance"     default to the command line values
+//   "magnetic"                 "Mn,Fe" or ["Mn", "Fe"]: magnetic sublattice for short patterns
+//   "spins"                    one pattern: "u d n ..." or [1, -1, 0, ...], per atom or per
+//                              magnetic site  -> "verdict"
+//   "batch"                    array of patterns                        -> "verdicts"
+//   "search"                   true, or {"max_configs", "time_budget", "spread", "engine",
+//                              "constraints", "ternary", "dedup", "threads"} -> search summary
+//                              and "configurations"
+// Without spins, batch or search the response describes the structure's symmetry.
+//
+// Parsed structures and their orbit tables are cached by source (path and modification time,
+// POSCAR text or arrays), symprec and tolerance, so repeated checks on one structure pay the
+// setup once.
+struct ServeOptions {
+    double symprec = DEFAULT_TOLERANCE;
+    double tolerance = DEFAULT_TOLERANCE;
+    SearchOptions search;             // defaults for "search" requests; num_threads sizes the pool
+    size_t max_cached_structures = 64;
+};
+
+// Serves until in reaches end of file and every accepted request has been answered. Returns the
+// number of requests that failed.
+size_t serve_json_lines(std::istream& in, std::ostream& out, const ServeOptions& options);
+
+} // namespace amcheck
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "amcheck.h"
+#include "altermagnet_checker.h"
+#include <cstdint>
+#include <vector>
+
+namespace amcheck {
+
+// Permutation of the magnetic sites (positions in the magnetic index list): site i goes to p[i]
+using SitePermutation = std::vector<uint32_t>;
+
+// The permutations induced by the symmetry operations, closed under composition so the result is
+// a group even when the operation list is incomplete. Operations that do not map every magnetic
+// site onto a site of the same orbit are ignored.
+struct SitePermutationGroup {
+    std::vector<SitePermutation> elements;  // the identity first
+    bool truncated = false;                 // closure stopped at max_order
+};
+
+SitePermutationGroup magnetic_site_group(
+    const CrystalStructure& structure,
+    const std::vector<size_t>& magnetic_indices,
+    double tolerance,
+    size_t max_order = 50000
+);
+
+// Whether the operation list is closed under composition (translations modulo the lattice).
+// Verdicts are invariant under the site permutations only when it is, so symmetry
+// deduplication is skipped for incomplete lists.
+bool operations_form_group(const std::vector<SymmetryOperation>& symops, double tolerance);
+
+// Whether the checker's geometry tables are themselves symmetric: for every operation h that
+// permutes the magnetic sites (i -> p(i)) and every operation g, g relates sites i and j exactly
+// when h g h^-1 relates p(i) and p(j). A closed group is not enough when sites lie within the
+// tolerance of a symmetric position: one image may pass the distance test and its conjugate
+// fail, and then verdicts differ inside a symmetry class.
+bool verdicts_invariant(
+    const AltermagnetChecker& checker,
+    const std::vector<SymmetryOperation>& symops,
+    const std::vector<size_t>& magnetic_indices,
+    double tolerance
+);
+
+// Atom images under one operation, a permutation of the atoms, or an empty vector when it does
+// not map the structure onto itself (atom species and lattice metric included)
+std::vector<size_t> atom_permutation(const CrystalStructure& structure, const SymmetryOperation& op, double tolerance);
+
+// Symmetry of a structure derived from a parent (distorted, decorated) without a new symmetry
+// search: parent operations that map the parent onto itself but not the derived structure
+// (atom species and lattice metric included) are dropped. Its orbits are the parent orbits split
+// by the operations it keeps; when nothing is dropped the parent labels carry over unchanged, so
+// an undistorted copy gives exactly the parent's verdicts. The atoms must be in the parent's
+// order; returns the number of operations kept.
+size_t inherit_subgroup_symmetry(const CrystalStructure& parent, CrystalStructure& derived, double tolerance);
+
+} // namespace amcheck
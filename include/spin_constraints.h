@@ -0,0 +1,67 @@
+#pragma once
+
+#include "amcheck.h"
+#include <string>
+#include <vector>
+
+namespace amcheck {
+
+// Partial knowledge of the ordering (--constrain, --constraints), compiled into the search space
+// itself so excluded patterns are never generated. Statements are separated by ';' or newlines;
+// '#' starts a comment. Atoms are numbered from 1 as in the structure listing.
+//
+//   fix 1:u 4:d            spins of given atoms ('=' also accepted)
+//   parallel 1 5 9         all listed atoms share one spin
+//   antiparallel 1 2       two atoms with opposite spins
+//   layers c [tol]         ferromagnetic planes: magnetic atoms with the same fractional
+//                          coordinate along a, b or c (within tol, default 0.01) are parallel
+//   ferro-orbit 2          all magnetic atoms of orbit 2 (numbers as printed by --plan) parallel
+//
+// Every statement is a parity relation between two sites, or between a site and a fixed UP
+// reference, so the statements are merged with a union-find that tracks parity. Contradictions
+// are reported against the statement that introduced them. What remains are blocks of sites
+// whose relative spins are fixed; each free block is one bit of the reduced enumeration.
+class ConstrainedSpace {
+public:
+    ConstrainedSpace(
+        const CrystalStructure& structure,
+        const std::vector<size_t>& magnetic_indices,
+        const std::string& spec
+    );
+
+    size_t free_blocks() const { return block_masks_.size(); }
+    size_t fixed_sites() const { return fixed_sites_; }
+    size_t size() const { return static_cast<size_t>(1) << block_masks_.size(); }
+
+    // Binary configuration id (as in the unconstrained search) of enumeration index in [0, size())
+    size_t configuration_id(size_t index) const {
+        size_t id = base_id_;
+        for (size_t b = 0; index != 0; ++b, index >>= 1) {
+            if (index & 1) id ^= block_masks_[b];
+        }
+        return id;
+    }
+
+    // Id of enumeration index 0, and the sites each free block toggles (as id bits); a site in
+    // no block is pinned to its bit in base_id()
+    size_t base_id() const { return base_id_; }
+    size_t block_mask(size_t block) const { return block_masks_[block]; }
+
+    // Whether a binary configuration id satisfies every statement
+    bool allows(size_t config_id) const;
+
+    std::string describe() const;
+
+private:
+    size_t num_sites_ = 0;
+    size_t num_statements_ = 0;
+    size_t fixed_sites_ = 0;
+    size_t base_id_ = 0;                // configuration id of enumeration index 0
+    std::vector<size_t> block_masks_;   // sites of each free block, ordered by lowest site
+    size_t fixed_mask_ = 0;             // sites whose spin is pinned by the statements
+};
+
+// Contents of a --constraints file, with the same statements as --constrain
+std::string read_constraint_file(const std::string& filename);
+
+} // namespace amcheck
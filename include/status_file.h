@@ -0,0 +1,45 @@
+#pragma once
+
+#include "amcheck.h"
+#include <string>
+#include <vector>
+
+namespace amcheck {
+
+// Machine-readable progress for batch schedulers and dashboards (--status-file).
+//
+// A regular file is replaced atomically (write to "<path>.tmp", then rename), so a poller never
+// sees a half-written document. If the path is a named pipe, one JSON object per line is streamed
+// to whichever reader has it open; updates are dropped rather than blocking the search when
+// nobody is listening.
+class StatusFileWriter {
+public:
+    StatusFileWriter(std::string path, std::string input_label, double min_interval_s);
+    ~StatusFileWriter();
+
+    StatusFileWriter(const StatusFileWriter&) = delete;
+    StatusFileWriter& operator=(const StatusFileWriter&) = delete;
+
+    // Called from the progress reporter thread; throttled except for the final snapshot
+    void update(const SearchProgress& progress);
+
+private:
+    std::string to_json(const SearchProgress& progress) const;
+    void publish(const std::string& json);
+
+    std::string path_;
+    std::string input_label_;
+    double min_interval_s_;
+    bool is_fifo_ = false;
+    int fifo_fd_ = -1;
+    bool warned_ = false;
+
+    // Previous published snapshot, for the recent (rather than average) rates
+    double last_elapsed_s_ = -1.0;
+    size_t last_completed_ = 0;
+    std::vector<size_t> last_thread_completed_;
+    double recent_rate_ = 0.0;
+    std::vector<double> thread_rates_;
+};
+
+} // namespace amcheck
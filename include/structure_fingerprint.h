@@ -0,0 +1,39 @@
+#pragma once
+
+#include "amcheck.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace amcheck {
+
+// Setting-independent identity of a crystal structure, for deduplicating screening inputs.
+//
+// The cell is standardized to its primitive form with spglib when available, reduced, and put
+// into the orientation among the 24 proper signed axis permutations with the smallest lattice
+// parameters; positions are then shifted so that an atom of the rarest species sits at the
+// origin, snapped to a grid of 2*symprec Angstrom and sorted with their species. The smallest
+// such description over all choices is the canonical form, so atom order, origin shifts and
+// equivalent settings of one crystal give the same string. Without spglib, supercells of one
+// another are not recognized. Values that land on a grid boundary can split one crystal into
+// two fingerprints, never merge two different crystals.
+struct StructureFingerprint {
+    std::string canonical;  // composition | lattice parameters | species and grid positions
+    uint64_t hash = 0;      // FNV-1a of canonical
+
+    std::string hex() const;
+    bool operator==(const StructureFingerprint& other) const { return canonical == other.canonical; }
+};
+
+StructureFingerprint structure_fingerprint(const CrystalStructure& structure, double symprec = DEFAULT_TOLERANCE);
+
+// For each file, the index of the first file with the same fingerprint (its own index when it is
+// the first); files that cannot be read are their own representative. fingerprints, when given,
+// receives one entry per file (empty for unreadable files).
+std::vector<size_t> find_duplicate_structures(
+    const std::vector<std::string>& files,
+    double symprec,
+    std::vector<StructureFingerprint>* fingerprints = nullptr
+);
+
+} // namespace amcheck
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "amcheck.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace amcheck {
+
+// Site-substitution screening (--substitute): which ways of replacing some sites of a parent
+// structure by a magnetic species allow an altermagnetic ordering.
+//
+// Decorations are subsets of the host sites. Two subsets related by a parent symmetry give the
+// same crystal, so only the smallest bitmask of each class under the site permutations of the
+// parent operations (closed under composition) is kept, as in enumlib. Every distinct decoration
+// inherits its operations from the parent (inherit_subgroup_symmetry()) instead of a new spglib
+// pass, and its spin configurations are searched; decorations run in parallel, one search each.
+struct SubstitutionSpec {
+    std::string host;       // element whose sites may be replaced
+    std::string dopant;     // element put on the replaced sites
+    size_t min_count = 1;
+    size_t max_count = 1;
+};
+
+// "Ti:Fe:2" or "Ti:Fe:1-3"; throws std::invalid_argument
+SubstitutionSpec parse_substitution_spec(const std::string& text);
+
+struct Decoration {
+    std::vector<size_t> sites;      // replaced atoms (indices into the parent)
+    size_t multiplicity = 1;        // decorations in its symmetry class; 0 when the group is truncated
+};
+
+struct DecorationSet {
+    std::vector<size_t> host_sites;
+    size_t group_order = 1;         // site permutations of the host sites used for deduplication
+    bool group_truncated = false;   // closure stopped at its size limit: duplicates may remain
+    size_t total = 0;               // decorations before deduplication
+    std::vector<Decoration> distinct;
+};
+
+// Parent needs its symmetry (analyze_symmetry()); at most 63 host sites
+DecorationSet enumerate_decorations(const CrystalStructure& parent, const SubstitutionSpec& spec, double tolerance);
+
+// The parent with the decoration's sites replaced by the dopant; symmetry is not set
+CrystalStructure decorate(const CrystalStructure& parent, const Decoration& decoration, const std::string& dopant);
+
+struct DecorationResult {
+    size_t operations = 0;          // parent operations the decorated structure keeps
+    size_t magnetic_sites = 0;
+    size_t tested = 0;
+    size_t found = 0;               // altermagnetic configurations
+    std::vector<SpinType> example;  // first altermagnetic configuration found
+    std::string note;               // why the decoration was not searched
+};
+
+// options: magnetic selection, engine, -j (decorations in parallel), --max-configs and
+// --time-budget per decoration. Decorations with more than LARGE_SEARCH_MAGNETIC_ATOMS magnetic
+// sites are skipped unless one of the two bounds is set.
+std::vector<DecorationResult> search_decorations(
+    const CrystalStructure& parent,
+    const SubstitutionSpec& spec,
+    const DecorationSet& decorations,
+    double tolerance,
+    const SearchOptions& options
+);
+
+void print_substitution_results(
+    const CrystalStructure& parent,
+    const SubstitutionSpec& spec,
+    const DecorationSet& decorations,
+    const std::vector<DecorationResult>& results,
+    std::ostream& out
+);
+
+} // namespace amcheck
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "amcheck.h"
+#include "site_symmetry.h"
+#include <cstdint>
+#include <vector>
+
+namespace amcheck {
+
+// Configuration space of the three-state search (--ternary): every magnetic site is UP, DOWN or
+// NONE. Configuration ids are base 3, digit i for magnetic site i (0 = UP, 1 = DOWN, 2 = NONE),
+// which is a different numbering from the binary search; result files say which one they use.
+//
+// Only patterns that can pass the orbit balance check are generated. The space factorizes over
+// the orbits: an orbit of k > 1 sites contributes the words with as many UP as DOWN sites (any
+// number of NONE, including an entirely non-magnetic orbit), a single-site orbit all three
+// states. Patterns are ranked orbit by orbit in mixed radix, and within an orbit through the
+// count of balanced completions, so index -> pattern costs O(N) with no stored tables beyond
+// one count table per orbit size.
+class TernarySpace {
+public:
+    // Up to 40 magnetic sites: 3^40 is the largest power of three that fits in 64 bits
+    static constexpr size_t MAX_SITES = 40;
+
+    TernarySpace(const CrystalStructure& structure, const std::vector<size_t>& magnetic_indices,
+                 double tolerance, bool symmetry_dedup);
+
+    // Number of balanced patterns; enumeration indices run over [0, size())
+    size_t size() const { return size_; }
+    long double raw_size() const;  // 3^N
+
+    // Writes pattern number index onto the magnetic sites of spins and returns its ternary id
+    size_t decode(size_t index, std::vector<SpinType>& spins) const;
+
+    // True when spins is the representative of its symmetry class: the smallest ternary id
+    // among its images under the site permutation group and under global spin reversal.
+    // Always true without symmetry_dedup.
+    bool is_canonical(const std::vector<SpinType>& spins) const;
+
+    // False when not requested, when the symmetry operations are not a closed group, or when
+    // sites near the tolerance make the geometry asymmetric (verdicts_invariant())
+    bool symmetry_dedup() const { return dedup_; }
+    size_t group_order() const { return group_.elements.size(); }
+    bool group_truncated() const { return group_.truncated; }
+
+private:
+    struct Orbit {
+        std::vector<size_t> sites;  // positions in the magnetic index list
+        bool unconstrained = false; // single-site orbit: skipped by the balance check
+        size_t choices = 0;
+        size_t table = 0;           // index into counts_, by orbit size
+    };
+
+    // counts_[table][r * (2k + 1) + (t + k)]: words of length r with (#UP - #DOWN) == t
+    size_t completions(const Orbit& orbit, size_t remaining, long long balance) const;
+
+    std::vector<size_t> magnetic_indices_;
+    std::vector<Orbit> orbits_;
+    std::vector<std::vector<size_t>> counts_;
+    std::vector<size_t> count_sizes_;
+    size_t size_ = 1;
+    bool dedup_ = false;
+    SitePermutationGroup group_;
+    std::vector<SitePermutation> inverses_;  // inverse of every group element, for is_canonical()
+};
+
+} // namespace amcheck
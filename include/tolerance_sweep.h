@@ -0,0 +1,63 @@
+#pragma once
+
+#include "amcheck.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace amcheck {
+
+// Verdicts at several tolerances from one enumeration (--tolerances).
+//
+// The tolerance enters the check only through comparisons of residual distances with it: a
+// symmetry image to its target site, an inversion midpoint to its image, and the length of a pure
+// translation. The residuals are computed once. An evaluation then works with thresholds instead
+// of booleans: an operation survives above the largest, over the magnetic sites, of the minimum
+// residual to an antiparallel site, and a pair counts above the larger of its own residual and
+// that survival threshold. Each predicate of the check becomes a set of tolerances (above a
+// threshold, or for pure translations also below the translation length), so one evaluation gives
+// the verdict at every listed tolerance and the exact tolerances at which it changes. The verdict
+// at tolerance t is exactly what a separate run with --tolerance t reports.
+class ToleranceSweep {
+public:
+    static constexpr size_t MAX_TOLERANCES = 64;
+
+    // tolerances: 1 to 64 values in (0, 0.5); sorted and deduplicated here
+    ToleranceSweep(const CrystalStructure& structure, std::vector<double> tolerances);
+
+    const std::vector<double>& tolerances() const { return tolerances_; }
+
+    // Bit k is set when spins are altermagnetic at tolerances()[k]. INVALID patterns (an
+    // unbalanced orbit) do not depend on the tolerance and give 0. With flips, for every pair of
+    // neighbouring tolerances with different verdicts, the tolerance t at which the verdict
+    // changes: the lower one's verdict holds up to t, the upper one's above it. A verdict that
+    // changes more than once between two listed tolerances reports its last change.
+    uint64_t evaluate(const std::vector<SpinType>& spins, std::vector<double>* flips = nullptr) const;
+
+private:
+    enum class OpKind : uint8_t { OTHER, INVERSION, TRANSLATION };
+
+    // Site j of the orbit with residuals below the largest listed tolerance, for one site and
+    // operation; larger residuals never match at a listed tolerance and are left out
+    struct Candidate {
+        uint32_t target;
+        double match;     // symmetry image of the site to the target
+        double related;   // inversion midpoint or pure translation residual; infinity if neither
+    };
+
+    struct Orbit {
+        std::vector<size_t> sites;
+        std::vector<uint32_t> first;        // [i * num_ops + op] -> first candidate, plus an end
+        std::vector<Candidate> candidates;
+    };
+
+    std::vector<double> tolerances_;
+    std::vector<OpKind> op_kind_;
+    std::vector<double> translation_length_;
+    std::vector<Orbit> orbits_;
+};
+
+// "1e-4,1e-3,0.01" -> sorted distinct tolerances; throws std::invalid_argument
+std::vector<double> parse_tolerance_list(const std::string& text);
+
+} // namespace amcheck
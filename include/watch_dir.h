@@ -0,0 +1,46 @@
+#pragma once
+
+#include "amcheck.h"
+#include <string>
+
+namespace amcheck {
+
+// What --watch runs on each finished file
+enum class WatchAnalysis {
+    STANDARD,   // structure + spins (--spins/--magmom, else OUTCAR, vasprun.xml or INCAR beside it)
+    SEARCH,     // spin configuration search on every structure (-a)
+    BAND        // BAND.dat splitting analysis (-b)
+};
+
+// Directory watcher for DFT workflows (--watch).
+//
+// The tree under directory is watched recursively with inotify on Linux (a file counts as
+// finished when its writer closes it or it is renamed into place) and by periodic scans
+// elsewhere, or with --watch-poll (a file counts as finished when its size and modification time
+// are unchanged between two scans). Candidates are POSCAR*/CONTCAR*/*.vasp/*.poscar structures,
+// OUTCAR (standard analysis of the CONTCAR or POSCAR beside it) and BAND*.dat; amcheck's own
+// output files are ignored.
+//
+// Each finished file becomes one job on a shared worker pool; every job appends one
+// tab-separated line to the summary file. A job is keyed by the path, size and modification
+// time of its inputs, and keys already in the summary are skipped, so a restarted watcher only
+// analyzes what is new or changed since the last run.
+struct WatchOptions {
+    std::string directory;
+    std::string summary_file;         // default: <directory>/amcheck_watch_summary.tsv
+    WatchAnalysis analysis = WatchAnalysis::STANDARD;
+    double symprec = DEFAULT_TOLERANCE;
+    double tolerance = DEFAULT_TOLERANCE;
+    SearchOptions search;             // magnetic sublattice, threads and search settings
+    SpinSource spins;                 // standard analysis: spins for every structure
+    double band_threshold = 0.01;
+    bool once = false;                // analyze what is there now, then exit
+    bool poll = false;                // scan periodically even where inotify is available
+    double poll_interval_s = 2.0;
+};
+
+// Runs until SIGINT/SIGTERM (or, with once, until the initial scan has been analyzed); queued
+// jobs are finished before returning
+void watch_directory(const WatchOptions& options);
+
+} // namespace amcheck
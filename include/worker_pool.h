@@ -0,0 +1,69 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace amcheck {
+
+// Fixed set of workers fed from one queue. submit() blocks while max_pending tasks are waiting,
+// so a fast producer cannot buffer an unbounded part of the input.
+class WorkerPool {
+public:
+    WorkerPool(size_t num_threads, size_t max_pending) : max_pending_(max_pending) {
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back([this] { run(); });
+        }
+    }
+
+    ~WorkerPool() { finish(); }
+
+    void submit(std::function<void()> task) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_.wait(lock, [this] { return tasks_.size() < max_pending_; });
+        tasks_.push_back(std::move(task));
+        work_.notify_one();
+    }
+
+    // Runs every queued task, then stops the workers
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closing_ = true;
+        }
+        work_.notify_all();
+        for (auto& worker : workers_) {
+            if (worker.joinable()) worker.join();
+        }
+    }
+
+private:
+    void run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_.wait(lock, [this] { return closing_ || !tasks_.empty(); });
+                if (tasks_.empty()) return;
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            space_.notify_one();
+            task();
+        }
+    }
+
+    size_t max_pending_;
+    std::mutex mutex_;
+    std::condition_variable work_;
+    std::condition_variable space_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> workers_;
+    bool closing_ = false;
+};
+
+} // namespace amcheck
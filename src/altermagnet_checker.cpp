@@ -0,0 +1,301 @@
+#include "altermagnet_checker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace amcheck {
+
+namespace {
+
+inline bool are_antiparallel(SpinType a, SpinType b) {
+    return (a == SpinType::UP && b == SpinType::DOWN) ||
+           (a == SpinType::DOWN && b == SpinType::UP);
+}
+
+inline void set_bit(uint64_t* mask, size_t bit) {
+    mask[bit / 64] |= static_cast<uint64_t>(1) << (bit % 64);
+}
+
+} // namespace
+
+std::string outcome_to_string(CheckOutcome outcome) {
+    switch (outcome) {
+        case CheckOutcome::ALTERMAGNET: return "altermagnet";
+        case CheckOutcome::NOT_ALTERMAGNET: return "not_altermagnet";
+        case CheckOutcome::INVALID: return "invalid";
+    }
+    return "invalid";
+}
+
+AltermagnetChecker::AltermagnetChecker(const CrystalStructure& structure, double tol)
+    : AltermagnetChecker(structure.symmetry_operations, structure.get_all_scaled_positions(),
+                         structure.equivalent_atoms, tol) {}
+
+AltermagnetChecker::AltermagnetChecker(
+    const std::vector<SymmetryOperation>& symops,
+    const std::vector<Vector3d>& positions,
+    const std::vector<int>& equiv_atoms,
+    double tol
+) : num_ops_(symops.size()), words_(std::max<size_t>(1, (symops.size() + 63) / 64)), tol_(tol) {
+    if (equiv_atoms.size() != positions.size()) {
+        throw std::invalid_argument("Number of orbit labels must equal number of positions");
+    }
+
+    // Same orbit order as is_altermagnet(): ascending orbit identifiers
+    std::vector<int> unique_orbits = equiv_atoms;
+    std::sort(unique_orbits.begin(), unique_orbits.end());
+    unique_orbits.erase(std::unique(unique_orbits.begin(), unique_orbits.end()), unique_orbits.end());
+
+    for (int u : unique_orbits) {
+        Orbit orbit;
+        for (size_t i = 0; i < equiv_atoms.size(); ++i) {
+            if (equiv_atoms[i] == u) {
+                orbit.sites.push_back(i);
+            }
+        }
+
+        const size_t n = orbit.sites.size();
+        orbit.match.assign(n * n * words_, 0);
+        orbit.related.assign(n * n * words_, 0);
+
+        // The expressions below are kept identical to check_altermagnetism_orbit() so both
+        // paths round the same way and agree even for distances right at the tolerance
+        for (size_t i = 0; i < n; ++i) {
+            const Vector3d& pi = positions[orbit.sites[i]];
+            for (size_t j = 0; j < n; ++j) {
+                const Vector3d& pj = positions[orbit.sites[j]];
+                uint64_t* match = orbit.match.data() + (i * n + j) * words_;
+                uint64_t* related = orbit.related.data() + (i * n + j) * words_;
+                Vector3d midpoint = (pi + pj) / 2.0;
+
+                for (size_t si = 0; si < symops.size(); ++si) {
+                    const auto& [R, t] = symops[si];
+
+                    Vector3d dp = R * pi + t - pj;
+                    dp = bring_in_cell(dp, tol);
+                    if (dp.norm() < tol) {
+                        set_bit(match, si);
+                    }
+
+                    if (j <= i) continue;
+
+                    if (std::abs(R.trace() + 3) < tol) {
+                        Vector3d midpoint_prime = R * midpoint + t - midpoint;
+                        midpoint_prime = bring_in_cell(midpoint_prime, tol);
+                        if (midpoint_prime.norm() < tol) {
+                            set_bit(related, si);
+                        }
+                    }
+
+                    if (std::abs(R.trace() - 3) < tol && t.norm() > tol) {
+                        Vector3d dp_trans = pi + t - pj;
+                        dp_trans = bring_in_cell(dp_trans, tol);
+                        if (dp_trans.norm() < tol) {
+                            set_bit(related, si);
+                        }
+                    }
+                }
+            }
+        }
+
+        orbits_.push_back(std::move(orbit));
+    }
+}
+
+bool AltermagnetChecker::check_orbit(size_t orbit_index, const std::vector<SpinType>& spins) const {
+    const Orbit& orbit = orbits_[orbit_index];
+    const size_t n = orbit.sites.size();
+
+    // If orbit has multiplicity 1, it cannot be altermagnetic
+    if (n == 1) return false;
+
+    // Per-thread scratch space keeps the hot path allocation-free
+    thread_local std::vector<uint64_t> surviving;
+    thread_local std::vector<uint64_t> site_mask;
+    thread_local std::vector<char> in_sym_pair;
+    thread_local std::vector<char> in_it_pair;
+    surviving.assign(words_, ~static_cast<uint64_t>(0));
+    site_mask.resize(words_);
+
+    // Operations that map every magnetic site onto an antiparallel one
+    for (size_t i = 0; i < n; ++i) {
+        const SpinType si = spins[orbit.sites[i]];
+        if (si != SpinType::UP && si != SpinType::DOWN) continue;
+
+        std::fill(site_mask.begin(), site_mask.end(), 0);
+        for (size_t j = 0; j < n; ++j) {
+            if (!are_antiparallel(si, spins[orbit.sites[j]])) continue;
+            const uint64_t* match = mask(orbit.match, n, i, j);
+            for (size_t w = 0; w < words_; ++w) site_mask[w] |= match[w];
+        }
+        for (size_t w = 0; w < words_; ++w) surviving[w] &= site_mask[w];
+    }
+
+    // Bits beyond the last operation never correspond to a symmetry
+    if (num_ops_ % 64 != 0) {
+        surviving[words_ - 1] &= (static_cast<uint64_t>(1) << (num_ops_ % 64)) - 1;
+    }
+    if (num_ops_ == 0 || std::all_of(surviving.begin(), surviving.end(), [](uint64_t w) { return w == 0; })) {
+        return false;
+    }
+
+    int N_up = 0;
+    for (size_t i = 0; i < n; ++i) {
+        N_up += spins[orbit.sites[i]] == SpinType::UP;
+    }
+    const int N_magnetic_atoms = 2 * N_up;
+
+    in_sym_pair.assign(n, 0);
+    in_it_pair.assign(n, 0);
+
+    for (size_t i = 0; i < n; ++i) {
+        const SpinType si = spins[orbit.sites[i]];
+        for (size_t j = i + 1; j < n; ++j) {
+            if (!are_antiparallel(si, spins[orbit.sites[j]])) continue;
+
+            const uint64_t* match = mask(orbit.match, n, i, j);
+            const uint64_t* related = mask(orbit.related, n, i, j);
+            for (size_t w = 0; w < words_; ++w) {
+                if (match[w] & surviving[w]) {
+                    in_sym_pair[i] = in_sym_pair[j] = 1;
+                }
+                if (related[w] & surviving[w]) {
+                    in_it_pair[i] = in_it_pair[j] = 1;
+                }
+            }
+        }
+    }
+
+    const int sum_sym = static_cast<int>(std::count(in_sym_pair.begin(), in_sym_pair.end(), 1));
+    const int sum_IT = static_cast<int>(std::count(in_it_pair.begin(), in_it_pair.end(), 1));
+
+    const bool is_Luttinger_ferrimagnet = std::abs(sum_sym - N_magnetic_atoms) > tol_;
+    return std::abs(sum_IT - N_magnetic_atoms) > tol_ && !is_Luttinger_ferrimagnet;
+}
+
+CheckOutcome AltermagnetChecker::evaluate(const std::vector<SpinType>& spins) const {
+    bool check_was_performed = false;
+    bool all_orbits_multiplicity_one = true;
+
+    // Validate every orbit first: is_altermagnet() throws on the first unbalanced orbit even
+    // when an earlier orbit was already found altermagnetic
+    for (const Orbit& orbit : orbits_) {
+        all_orbits_multiplicity_one = all_orbits_multiplicity_one && (orbit.sites.size() == 1);
+        if (orbit.sites.size() == 1) continue;
+
+        int N_u = 0, N_d = 0;
+        for (size_t site : orbit.sites) {
+            N_u += spins[site] == SpinType::UP;
+            N_d += spins[site] == SpinType::DOWN;
+        }
+        if (N_u == 0 && N_d == 0) continue;  // non-magnetic orbit
+        if (N_u != N_d) return CheckOutcome::INVALID;
+        check_was_performed = true;
+    }
+
+    if (!check_was_performed) {
+        return all_orbits_multiplicity_one ? CheckOutcome::NOT_ALTERMAGNET : CheckOutcome::INVALID;
+    }
+
+    for (size_t o = 0; o < orbits_.size(); ++o) {
+        const Orbit& orbit = orbits_[o];
+        if (orbit.sites.size() == 1) continue;
+        bool magnetic = std::any_of(orbit.sites.begin(), orbit.sites.end(),
+                                    [&](size_t site) { return spins[site] != SpinType::NONE; });
+        if (magnetic && check_orbit(o, spins)) {
+            return CheckOutcome::ALTERMAGNET;
+        }
+    }
+
+    return CheckOutcome::NOT_ALTERMAGNET;
+}
+
+IncrementalChecker::IncrementalChecker(const AltermagnetChecker& checker)
+    : checker_(checker), orbits_(checker.num_orbits()) {
+    for (size_t o = 0; o < checker.num_orbits(); ++o) {
+        const std::vector<size_t>& sites = checker.orbit_sites(o);
+        all_orbits_single_ = all_orbits_single_ && sites.size() == 1;
+        for (size_t site : sites) {
+            if (site >= orbit_of_.size()) orbit_of_.resize(site + 1, SIZE_MAX);
+            if (sites.size() > 1) orbit_of_[site] = o;
+        }
+    }
+}
+
+// Adds (sign = 1) or removes (sign = -1) an orbit's contribution to the counters
+void IncrementalChecker::account(size_t orbit, int sign) {
+    const OrbitState& state = orbits_[orbit];
+    if (state.up == 0 && state.down == 0) return;
+    if (!eligible(state)) {
+        unbalanced_ += sign;
+        return;
+    }
+    checked_ += sign;
+    if (!state.dirty && state.altermagnetic) altermagnetic_ += sign;
+}
+
+void IncrementalChecker::reset(const std::vector<SpinType>& spins) {
+    spins_ = spins;
+    unbalanced_ = checked_ = altermagnetic_ = 0;
+    dirty_.clear();
+    for (size_t o = 0; o < orbits_.size(); ++o) {
+        OrbitState& state = orbits_[o];
+        state = OrbitState();
+        const std::vector<size_t>& sites = checker_.orbit_sites(o);
+        if (sites.size() == 1) continue;
+        for (size_t site : sites) {
+            state.up += spins_[site] == SpinType::UP;
+            state.down += spins_[site] == SpinType::DOWN;
+        }
+        dirty_.push_back(o);
+        account(o, 1);
+    }
+}
+
+void IncrementalChecker::flip(size_t atom) {
+    SpinType& spin = spins_[atom];
+    if (spin == SpinType::NONE) return;
+    const bool was_up = spin == SpinType::UP;
+    spin = was_up ? SpinType::DOWN : SpinType::UP;
+
+    const size_t orbit = atom < orbit_of_.size() ? orbit_of_[atom] : SIZE_MAX;
+    if (orbit == SIZE_MAX) return;  // single-site orbits never decide the verdict
+    OrbitState& state = orbits_[orbit];
+    account(orbit, -1);
+    state.up += was_up ? -1 : 1;
+    state.down += was_up ? 1 : -1;
+    if (!state.dirty) {
+        state.dirty = true;
+        dirty_.push_back(orbit);
+    }
+    state.altermagnetic = false;
+    account(orbit, 1);
+}
+
+CheckOutcome IncrementalChecker::outcome() {
+    // Same precedence as evaluate(): any unbalanced orbit makes the pattern invalid
+    if (unbalanced_ > 0) return CheckOutcome::INVALID;
+    if (checked_ == 0) {
+        return all_orbits_single_ ? CheckOutcome::NOT_ALTERMAGNET : CheckOutcome::INVALID;
+    }
+
+    // Balanced orbits changed since their last verdict; the others wait until they balance
+    size_t kept = 0;
+    for (size_t orbit : dirty_) {
+        OrbitState& state = orbits_[orbit];
+        if (!eligible(state)) {
+            dirty_[kept++] = orbit;
+            continue;
+        }
+        account(orbit, -1);
+        state.altermagnetic = checker_.check_orbit(orbit, spins_);
+        state.dirty = false;
+        account(orbit, 1);
+    }
+    dirty_.resize(kept);
+
+    return altermagnetic_ > 0 ? CheckOutcome::ALTERMAGNET : CheckOutcome::NOT_ALTERMAGNET;
+}
+
+} // namespace amcheck
@@ -0,0 +1,372 @@
+#include "altermagnet_sat.h"
+#include "altermagnet_checker.h"
+#include "spin_constraints.h"
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+
+namespace amcheck {
+
+namespace {
+
+// Clause builder over SatSolver literals with one constant-true variable, so that fixed spins
+// and trivially decided subformulas fold away instead of producing clauses
+class Encoder {
+public:
+    explicit Encoder(SatSolver& solver) : solver_(solver), true_(solver.new_variable()) {
+        solver_.add_clause({true_});
+    }
+
+    int constant(bool value) const { return value ? true_ : -true_; }
+    bool is_true(int lit) const { return lit == true_; }
+    bool is_false(int lit) const { return lit == -true_; }
+
+    int variable() { return solver_.new_variable(); }
+
+    // Satisfied clauses are dropped and false literals removed
+    void clause(const std::vector<int>& lits) {
+        std::vector<int> kept;
+        for (int lit : lits) {
+            if (is_true(lit)) return;
+            if (!is_false(lit)) kept.push_back(lit);
+        }
+        solver_.add_clause(kept);
+    }
+
+    // d <=> a xor b
+    int exclusive_or(int a, int b) {
+        if (a == b) return constant(false);
+        if (a == -b) return constant(true);
+        if (std::abs(a) == true_) return is_true(a) ? -b : b;
+        if (std::abs(b) == true_) return is_true(b) ? -a : a;
+        const auto key = std::minmax(a, b);
+        auto it = xor_cache_.find(key);
+        if (it != xor_cache_.end()) return it->second;
+        const int d = variable();
+        clause({-d, a, b});
+        clause({-d, -a, -b});
+        clause({d, -a, b});
+        clause({d, a, -b});
+        xor_cache_.emplace(key, d);
+        return d;
+    }
+
+    // t <=> l1 and l2 and ...
+    int all_of(std::vector<int> lits) {
+        std::vector<int> kept;
+        for (int lit : lits) {
+            if (is_false(lit)) return constant(false);
+            if (!is_true(lit)) kept.push_back(lit);
+        }
+        std::sort(kept.begin(), kept.end());
+        kept.erase(std::unique(kept.begin(), kept.end()), kept.end());
+        if (kept.empty()) return constant(true);
+        if (kept.size() == 1) return kept[0];
+        auto it = and_cache_.find(kept);
+        if (it != and_cache_.end()) return it->second;
+
+        const int t = variable();
+        std::vector<int> converse = {t};
+        for (int lit : kept) {
+            clause({-t, lit});
+            converse.push_back(-lit);
+        }
+        clause(converse);
+        and_cache_.emplace(kept, t);
+        return t;
+    }
+
+    // c <=> l1 or l2 or ...
+    int any_of(const std::vector<int>& lits) {
+        std::vector<int> negated;
+        for (int lit : lits) negated.push_back(-lit);
+        return -all_of(negated);
+    }
+
+    // Sequential counter (Sinz 2005): at most k of lits are true
+    void at_most(const std::vector<int>& lits, size_t k) {
+        const size_t n = lits.size();
+        if (k >= n) return;
+        if (k == 0) {
+            for (int lit : lits) clause({-lit});
+            return;
+        }
+        // count[i][j]: at least j + 1 of lits[0..i] are true
+        std::vector<std::vector<int>> count(n - 1, std::vector<int>(k));
+        for (auto& row : count) {
+            for (int& v : row) v = variable();
+        }
+        clause({-lits[0], count[0][0]});
+        for (size_t j = 1; j < k; ++j) clause({-count[0][j]});
+        for (size_t i = 1; i + 1 < n; ++i) {
+            clause({-lits[i], count[i][0]});
+            clause({-count[i - 1][0], count[i][0]});
+            for (size_t j = 1; j < k; ++j) {
+                clause({-lits[i], -count[i - 1][j - 1], count[i][j]});
+                clause({-count[i - 1][j], count[i][j]});
+            }
+            clause({-lits[i], -count[i - 1][k - 1]});
+        }
+        clause({-lits[n - 1], -count[n - 2][k - 1]});
+    }
+
+    bool holds(int lit) const {
+        if (std::abs(lit) == true_) return is_true(lit);
+        return solver_.value(std::abs(lit)) == (lit > 0);
+    }
+
+private:
+    SatSolver& solver_;
+    const int true_;
+    std::map<std::pair<int, int>, int> xor_cache_;
+    std::map<std::vector<int>, int> and_cache_;
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+ExistenceResult find_altermagnetic_ordering(
+    const CrystalStructure& structure,
+    double tolerance,
+    const SearchOptions& options,
+    const std::string& proof_stem
+) {
+    if (options.ternary) {
+        throw std::invalid_argument("--exists decides UP/DOWN orderings and cannot be combined with --ternary");
+    }
+    if (!options.tolerances.empty()) {
+        throw std::invalid_argument("--exists cannot be combined with --tolerances");
+    }
+
+    ExistenceResult result;
+    const auto encode_start = std::chrono::steady_clock::now();
+    std::optional<ScopedSpan> span;
+    span.emplace("sat-encode");
+
+    const size_t num_atoms = structure.atoms.size();
+    const std::vector<size_t> magnetic_indices = get_magnetic_atom_indices(structure, options.magnetic);
+    result.num_magnetic_atoms = magnetic_indices.size();
+
+    SatSolver solver;
+    Encoder encoder(solver);
+
+    // up[atom]: literal "atom points up"; 0 for atoms without a spin
+    std::vector<int> up(num_atoms, 0);
+    if (!options.constraints.empty()) {
+        const ConstrainedSpace space(structure, magnetic_indices, options.constraints);
+        result.constraints = space.describe();
+        std::vector<int> block_variable(space.free_blocks());
+        for (int& v : block_variable) v = encoder.variable();
+        for (size_t s = 0; s < magnetic_indices.size(); ++s) {
+            // Id bit 1 is DOWN; a free block toggles its sites relative to base_id()
+            const bool base_down = (space.base_id() >> s) & 1;
+            int lit = encoder.constant(!base_down);
+            for (size_t b = 0; b < space.free_blocks(); ++b) {
+                if ((space.block_mask(b) >> s) & 1) lit = base_down ? block_variable[b] : -block_variable[b];
+            }
+            up[magnetic_indices[s]] = lit;
+        }
+    } else {
+        for (size_t atom : magnetic_indices) up[atom] = encoder.variable();
+        if (!magnetic_indices.empty()) encoder.clause({up[magnetic_indices.front()]});  // spin reversal
+    }
+
+    const AltermagnetChecker checker(structure, tolerance);
+    const std::vector<int> numbers = orbit_numbers(structure);
+    std::vector<int> candidate_orbits;
+
+    for (size_t o = 0; o < checker.num_orbits() && result.reason.empty(); ++o) {
+        const std::vector<size_t>& sites = checker.orbit_sites(o);
+        if (sites.size() == 1) continue;  // never checked
+        std::vector<size_t> magnetic;     // positions in sites
+        for (size_t i = 0; i < sites.size(); ++i) {
+            if (up[sites[i]] != 0) magnetic.push_back(i);
+        }
+        if (magnetic.empty()) continue;
+        if (magnetic.size() % 2 != 0) {
+            result.reason = "orbit " + std::to_string(numbers[sites.front()]) + " has " +
+                            std::to_string(magnetic.size()) + " magnetic sites, so no ordering balances it";
+            break;
+        }
+
+        std::vector<int> up_lits, down_lits;
+        for (size_t i : magnetic) {
+            up_lits.push_back(up[sites[i]]);
+            down_lits.push_back(-up[sites[i]]);
+        }
+        encoder.at_most(up_lits, magnetic.size() / 2);
+        encoder.at_most(down_lits, magnetic.size() / 2);
+
+        auto antiparallel = [&](size_t i, size_t j) { return encoder.exclusive_or(up[sites[i]], up[sites[j]]); };
+
+        // surviving[g]: g maps every magnetic site of the orbit onto an antiparallel one
+        std::vector<int> surviving(checker.num_operations(), encoder.constant(false));
+        for (size_t g = 0; g < checker.num_operations(); ++g) {
+            std::vector<int> every_site;
+            for (size_t i : magnetic) {
+                std::vector<int> images;
+                for (size_t j : magnetic) {
+                    if (checker.maps_onto(o, i, j, g)) images.push_back(antiparallel(i, j));
+                }
+                every_site.push_back(encoder.any_of(images));
+            }
+            surviving[g] = encoder.all_of(every_site);
+        }
+
+        const int altermagnetic = encoder.variable();
+        std::vector<int> some_operation = {-altermagnetic};
+        for (int s : surviving) some_operation.push_back(s);
+        encoder.clause(some_operation);
+
+        // Luttinger condition: every magnetic site in an antiparallel pair (i < j) joined by a
+        // surviving operation that maps i onto j
+        for (size_t i : magnetic) {
+            std::vector<int> paired = {-altermagnetic};
+            for (size_t j : magnetic) {
+                if (i == j) continue;
+                const size_t lo = std::min(i, j), hi = std::max(i, j);
+                for (size_t g = 0; g < checker.num_operations(); ++g) {
+                    if (encoder.is_false(surviving[g]) || !checker.maps_onto(o, lo, hi, g)) continue;
+                    paired.push_back(encoder.all_of({antiparallel(lo, hi), surviving[g]}));
+                }
+            }
+            encoder.clause(paired);
+        }
+
+        // Some magnetic site in no antiparallel pair related by a surviving inversion or translation
+        std::vector<int> unrelated_site = {-altermagnetic};
+        for (size_t i : magnetic) {
+            const int unrelated = encoder.variable();
+            for (size_t j : magnetic) {
+                if (i == j) continue;
+                const size_t lo = std::min(i, j), hi = std::max(i, j);
+                for (size_t g = 0; g < checker.num_operations(); ++g) {
+                    if (encoder.is_false(surviving[g]) || !checker.relates(o, lo, hi, g)) continue;
+                    encoder.clause({-unrelated, -antiparallel(lo, hi), -surviving[g]});
+                }
+            }
+            unrelated_site.push_back(unrelated);
+        }
+        encoder.clause(unrelated_site);
+
+        candidate_orbits.push_back(altermagnetic);
+    }
+
+    if (result.reason.empty() && candidate_orbits.empty()) {
+        result.reason = magnetic_indices.empty() ? "no magnetic atoms"
+                                                 : "no orbit has two or more magnetic sites";
+    }
+    if (!result.reason.empty()) {
+        encoder.clause({});
+    } else {
+        encoder.clause(candidate_orbits);
+    }
+
+    result.variables = solver.num_variables();
+    result.clauses = solver.num_clauses();
+    result.encode_s = seconds_since(encode_start);
+    span.reset();
+
+    std::ofstream proof;
+    if (!proof_stem.empty()) {
+        result.cnf_file = proof_stem + ".cnf";
+        result.proof_file = proof_stem + ".drat";
+        std::ofstream cnf(result.cnf_file);
+        if (!cnf.is_open()) throw std::runtime_error("Could not write " + result.cnf_file);
+        solver.write_dimacs(cnf);
+        proof.open(result.proof_file);
+        if (!proof.is_open()) throw std::runtime_error("Could not write " + result.proof_file);
+        solver.set_proof(&proof);
+    }
+
+    const auto solve_start = std::chrono::steady_clock::now();
+    span.emplace("sat-solve");
+    const SatSolver::Result outcome = solver.solve(options.time_budget_s);
+    span.reset();
+    result.solve_s = seconds_since(solve_start);
+    result.solver = solver.statistics();
+
+    if (outcome == SatSolver::Result::UNSATISFIABLE) {
+        result.status = ExistenceStatus::INFEASIBLE;
+    } else if (outcome == SatSolver::Result::SATISFIABLE) {
+        result.status = ExistenceStatus::WITNESS;
+        result.spins.assign(num_atoms, SpinType::NONE);
+        for (size_t atom : magnetic_indices) {
+            result.spins[atom] = encoder.holds(up[atom]) ? SpinType::UP : SpinType::DOWN;
+        }
+        if (checker.evaluate(result.spins) != CheckOutcome::ALTERMAGNET) {
+            throw std::runtime_error("Internal error: the SAT witness is not altermagnetic");
+        }
+        for (size_t o = 0; o < checker.num_orbits(); ++o) {
+            if (checker.orbit_sites(o).size() > 1 && checker.check_orbit(o, result.spins)) {
+                result.altermagnetic_orbits.push_back(numbers[checker.orbit_sites(o).front()]);
+            }
+        }
+    }
+    return result;
+}
+
+void print_existence_result(const ExistenceResult& result, std::ostream& out) {
+    out << "\n=======================================================================\n";
+    out << "                    ALTERMAGNET EXISTENCE QUERY\n";
+    out << "=======================================================================\n";
+    out << "Magnetic atoms: " << result.num_magnetic_atoms << "\n";
+    if (!result.constraints.empty()) {
+        out << "Constraints: " << result.constraints << "\n";
+    }
+    out << std::fixed << std::setprecision(3);
+    out << "SAT encoding: " << result.variables << " variables, " << result.clauses << " clauses ("
+        << result.encode_s << " s)\n";
+    out << "Solver: " << result.solver.decisions << " decisions, " << result.solver.conflicts << " conflicts, "
+        << result.solver.learned << " learned clauses, " << result.solver.restarts << " restarts ("
+        << result.solve_s << " s)\n";
+    out << "-----------------------------------------------------------------------\n";
+
+    switch (result.status) {
+        case ExistenceStatus::WITNESS: {
+            out << "Result: an altermagnetic ordering EXISTS\n";
+            std::string pattern;
+            for (size_t i = 0; i < result.spins.size(); ++i) {
+                pattern += (i ? " " : "") + spin_to_string(result.spins[i]);
+            }
+            out << "Witness (one spin per atom): " << pattern << "\n";
+            out << "Altermagnetic orbit(s):";
+            for (int orbit : result.altermagnetic_orbits) out << " " << orbit;
+            out << "\n";
+            out << "Reproduce with: --spins \"" << pattern << "\"\n";
+            break;
+        }
+        case ExistenceStatus::INFEASIBLE:
+            out << "Result: NO altermagnetic ordering"
+                << (result.constraints.empty() ? "" : " satisfies the constraints") << "\n";
+            if (!result.reason.empty()) {
+                out << "Reason: " << result.reason << "\n";
+            } else {
+                out << "Every UP/DOWN ordering was ruled out by the solver (refutation, not sampling).\n";
+            }
+            break;
+        case ExistenceStatus::UNKNOWN:
+            out << "Result: UNDECIDED - the time budget ran out before the solver finished\n";
+            break;
+    }
+
+    if (!result.cnf_file.empty()) {
+        out << "Formula: " << result.cnf_file << "  DRAT proof: " << result.proof_file << "\n";
+        if (result.status == ExistenceStatus::INFEASIBLE) {
+            out << "Check the refutation with: drat-trim " << result.cnf_file << " " << result.proof_file << "\n";
+        }
+    }
+    out << "=======================================================================\n";
+}
+
+} // namespace amcheck
@@ -1,4 +1,12 @@
 #include "amcheck.h"
+#include "altermagnet_checker.h"
+#include "profiler.h"
+#include "perf_counters.h"
+#include "log_sink.h"
+#include "status_file.h"
+#include "ternary_space.h"
+#include "spin_constraints.h"
+#include "tolerance_sweep.h"
 #ifdef HAVE_CUDA
 #include "cuda_accelerator.h"
 #endif
@@ -9,6 +17,7 @@
 #include <algorithm>
 #include <cmath>
 #include <ctime>
+#include <limits>
 #include <stdexcept>
 #include <numeric>
 #include <memory>
@@ -16,9 +25,9 @@
 #include <future>
 #include <atomic>
 #include <mutex>
-#include <random>
-#include <set>
+#include <condition_variable>
 #include <chrono>
+#include <set>
 
 namespace amcheck {
 
@@ -412,73 +421,40 @@ Matrix3d symmetrized_conductivity_tensor(
     return S;
 }
 
-void search_all_spin_configurations(
-    const CrystalStructure& structure,
-    const std::string& input_filename,
-    double tolerance,
-    bool verbose,
-    bool use_gpu
-) {
-    const size_t num_atoms = structure.atoms.size();
-    
-    // Get indices of magnetic atoms only
-    std::vector<size_t> magnetic_indices = get_magnetic_atom_indices(structure);
-    const size_t num_magnetic_atoms = magnetic_indices.size();
-    
-    // GPU acceleration setup
-    bool use_cuda = false;
-    std::string acceleration_method = "CPU";
-    
-#ifdef HAVE_CUDA
-    std::unique_ptr<cuda::CudaSpinSearcher> cuda_searcher;
-    
-    // GPU support is being developed but temporarily disabled for stability
-    bool cuda_disabled_for_compatibility = true;  // Re-enable with safer implementation  // Re-enabled with fixes for older GPUs
-    
-    if (use_gpu && !cuda_disabled_for_compatibility) {
-        cuda_searcher = std::make_unique<cuda::CudaSpinSearcher>();
-        if (cuda_searcher->initialize()) {
-            use_cuda = true;
-            acceleration_method = "GPU (CUDA)";
-            
-            auto config = cuda_searcher->get_config();
-            std::cout << "🚀 CUDA GPU Acceleration Enabled!\n";
-            std::cout << "GPU: " << config.device_name << "\n";
-            std::cout << "Memory: " << (config.memory_limit / (1024*1024)) << " MB\n";
-            std::cout << "Compute Capability: " << (config.compute_capability / 10) << "." << (config.compute_capability % 10) << "\n\n";
-        } else {
-            std::cout << "⚠️  GPU requested but not available - falling back to CPU\n";
-            cuda_searcher.reset(); // Clean up failed searcher
-        }
-    } else if (use_gpu && cuda_disabled_for_compatibility) {
-        std::cout << "⚠️  GPU requested but CUDA support is temporarily disabled\n";
-        std::cout << "Note: GPU acceleration is being developed but disabled for stability\n";
-        std::cout << "      Current focus is on robust CPU multithreading performance\n";
-        std::cout << "Using optimized CPU multithreading instead\n";
-    } else {
-        std::cout << "💻 CPU-only mode selected\n";
-    }
-#else
-    if (use_gpu) {
-        std::cout << "⚠️  GPU requested but CUDA support not compiled - using CPU\n";
+std::string engine_to_string(SearchEngine engine) {
+    switch (engine) {
+        case SearchEngine::REFERENCE: return "reference";
+        case SearchEngine::TABLE: return "table";
     }
-#endif
-    
-    if (num_magnetic_atoms == 0) {
-        std::cout << "\n=======================================================================\n";
-        std::cout << "                  NO MAGNETIC ATOMS DETECTED\n";
-        std::cout << "=======================================================================\n";
-        std::cout << "Structure contains no potentially magnetic atoms.\n";
-        std::cout << "Altermagnet analysis requires magnetic atoms.\n";
-        std::cout << "=======================================================================\n\n";
-        return;
+    return "table";
+}
+
+std::string large_policy_to_string(LargeSearchPolicy policy) {
+    switch (policy) {
+        case LargeSearchPolicy::ASK: return "ask";
+        case LargeSearchPolicy::SAMPLE: return "sample";
+        case LargeSearchPolicy::EXHAUSTIVE: return "exhaustive";
+        case LargeSearchPolicy::ABORT: return "abort";
     }
-    
-    // Calculate configurations based on magnetic atoms only (UP/DOWN, skip NONE)
-    const size_t total_configurations = static_cast<size_t>(std::pow(2, num_magnetic_atoms));
-    const unsigned int num_threads = std::thread::hardware_concurrency();
-    
-    // Generate output filename based on input structure filename
+    return "unknown";
+}
+
+LargeSearchPolicy string_to_large_policy(const std::string& name) {
+    if (name == "ask") return LargeSearchPolicy::ASK;
+    if (name == "sample") return LargeSearchPolicy::SAMPLE;
+    if (name == "exhaustive") return LargeSearchPolicy::EXHAUSTIVE;
+    if (name == "abort") return LargeSearchPolicy::ABORT;
+    throw std::invalid_argument("Unknown large-structure policy: " + name +
+                                " (expected ask, sample, exhaustive or abort)");
+}
+
+SearchEngine string_to_engine(const std::string& name) {
+    if (name == "reference") return SearchEngine::REFERENCE;
+    if (name == "table") return SearchEngine::TABLE;
+    throw std::invalid_argument("Unknown search engine: " + name + " (expected reference or table)");
+}
+
+std::string output_file_stem(const std::string& input_filename) {
     std::string base_filename = input_filename;
     
     // Extract just the filename without path
@@ -501,277 +477,271 @@ void search_all_spin_configurations(
     if (base_filename.empty() || base_filename == "POSCAR") {
         base_filename = "structure";
     }
-    
-    // Generate timestamped output filename
+    return base_filename;
+}
+
+std::string output_timestamp() {
     auto now = std::chrono::system_clock::now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
     auto tm = *std::localtime(&time_t);
     
     char timestamp[32];
     std::strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", &tm);
+    return timestamp;
+}
+
+void decode_configuration_id(
+    size_t config_id,
+    const std::vector<size_t>& magnetic_indices,
+    std::vector<SpinType>& spins
+) {
+    // Bit i of the id is the spin of magnetic site i (UP=0, DOWN=1); every further block of 64
+    // sites reads a splitmix64 hash of the id and the block number instead
+    uint64_t bits = config_id;
+    for (size_t i = 0; i < magnetic_indices.size(); ++i) {
+        if (i > 0 && i % 64 == 0) {
+            bits = config_id + (i / 64) * 0x9E3779B97F4A7C15ULL;
+            bits = (bits ^ (bits >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            bits = (bits ^ (bits >> 27)) * 0x94D049BB133111EBULL;
+            bits ^= bits >> 31;
+        }
+        spins[magnetic_indices[i]] = ((bits >> (i % 64)) & 1) ? SpinType::DOWN : SpinType::UP;
+    }
+}
+
+size_t binary_space_size(size_t magnetic_atoms) {
+    return magnetic_atoms >= 64 ? std::numeric_limits<size_t>::max() : static_cast<size_t>(1) << magnetic_atoms;
+}
+
+std::vector<SpinConfiguration> run_spin_search(
+    const CrystalStructure& structure,
+    const std::vector<size_t>& magnetic_indices,
+    double tolerance,
+    const SearchOptions& options,
+    const FoundCallback& on_found,
+    const ProgressCallback& on_progress,
+    const TernarySpace* prebuilt_ternary,
+    const ConstrainedSpace* prebuilt_constrained
+) {
+    const size_t num_atoms = structure.atoms.size();
+    const size_t num_magnetic_atoms = magnetic_indices.size();
     
-    std::string output_filename = base_filename + "_amcheck_results_" + timestamp + ".txt";
+    // The ternary search enumerates only balanced patterns, so its space is not a power of two
+    std::unique_ptr<TernarySpace> own_ternary;
+    const TernarySpace* ternary = nullptr;
+    if (options.ternary) {
+        ternary = prebuilt_ternary;
+        if (!ternary) {
+            ScopedSpan span("ternary setup");
+            own_ternary = std::make_unique<TernarySpace>(structure, magnetic_indices, tolerance, options.symmetry_dedup);
+            ternary = own_ternary.get();
+        }
+    }
     
-    if (num_magnetic_atoms > 20) {
-        std::cout << "WARNING: Structure has " << num_magnetic_atoms << " magnetic atoms.\n";
-        std::cout << "This will generate " << total_configurations << " configurations.\n";
-        
-        if (num_magnetic_atoms <= 25) {
-            std::cout << "This may take a long time but is feasible with multithreading.\n";
-            std::cout << "Estimated time: ";
-            if (num_magnetic_atoms <= 22) {
-                std::cout << "a few minutes to 1 hour\n";
-            } else {
-                std::cout << "1-8 hours depending on CPU cores\n";
-            }
-        } else {
-            std::cout << "This is computationally very expensive and may take days!\n";
-            std::cout << "\nRECOMMENDATIONS for large structures:\n";
-            std::cout << "1. Use representative supercell with fewer magnetic atoms\n";
-            std::cout << "2. Focus on specific magnetic sublattices\n";
-            std::cout << "3. Use symmetry-reduced configuration space\n";
-            std::cout << "4. Consider sampling approach rather than exhaustive search\n";
+    // Constraints leave one enumeration bit per free block of sites
+    std::unique_ptr<ConstrainedSpace> own_constrained;
+    const ConstrainedSpace* constrained = nullptr;
+    if (!options.constraints.empty()) {
+        if (ternary) {
+            throw std::invalid_argument("Constraints are not supported with --ternary");
         }
-        
-        std::cout << "\nDo you want to continue with the full exhaustive search? (y/N): ";
-        std::string response;
-        std::getline(std::cin, response);
-        if (response != "y" && response != "Y") {
-            std::cout << "\nSearch cancelled.\n";
-            
-            // Offer alternative sampling approach for very large structures
-            if (num_magnetic_atoms > 25) {
-                std::cout << "\nAlternative: Would you like to try a smart sampling approach? (Y/n): ";
-                std::string sample_response;
-                std::getline(std::cin, sample_response);
-                if (sample_response != "n" && sample_response != "N") {
-                    perform_smart_sampling_search(structure, magnetic_indices, input_filename, tolerance, verbose, acceleration_method);
-                    return;
-                }
-            }
-            
-            std::cout << "Consider using a smaller supercell or representative structure.\n";
-            return;
+        constrained = prebuilt_constrained;
+        if (!constrained) {
+            own_constrained = std::make_unique<ConstrainedSpace>(structure, magnetic_indices, options.constraints);
+            constrained = own_constrained.get();
         }
     }
     
-    std::cout << "\n=======================================================================\n";
-    std::cout << "                  MULTITHREADED SPIN CONFIGURATION SEARCH\n";
-    std::cout << "                           (MAGNETIC ATOMS ONLY)\n";
-    std::cout << "=======================================================================\n";
-    std::cout << "Structure: " << num_atoms << " total atoms (" << num_magnetic_atoms << " magnetic)\n";
-    std::cout << "Total configurations to test: " << total_configurations << "\n";
-    std::cout << "Acceleration method: " << acceleration_method << "\n";
-    std::cout << "CPU cores available: " << num_threads << "\n";
-    std::cout << "Tolerance: " << tolerance << "\n";
-    std::cout << "Output file: " << output_filename << "\n";
-    std::cout << "=======================================================================\n\n";
+    const size_t space_size = ternary ? ternary->size()
+        : constrained ? constrained->size() : binary_space_size(num_magnetic_atoms);
+    size_t total_configurations = space_size;
+    if (options.max_configurations > 0) {
+        total_configurations = std::min(total_configurations, options.max_configurations);
+    }
+    // From 64 sites on the ids only cover a sample; the space itself is larger than SIZE_MAX
+    if (num_magnetic_atoms >= 64 && total_configurations == space_size && options.time_budget_s <= 0.0) {
+        throw std::invalid_argument("Exhaustive search supports at most 63 magnetic atoms; "
+                                    "bound it with --max-configs or --time-budget, or use --on-large sample");
+    }
     
-    // Print atomic structure information
-    std::cout << "Magnetic atoms to be configured:\n";
-    std::cout << "-----------------------------------------------------------------------\n";
-    for (size_t i = 0; i < magnetic_indices.size(); ++i) {
-        size_t atom_idx = magnetic_indices[i];
-        Vector3d pos = structure.get_scaled_position(atom_idx);
-        std::cout << "Mag " << std::setw(2) << (i + 1) << " (Atom " << std::setw(2) << (atom_idx + 1) << "): " 
-                  << std::setw(2) << structure.atoms[atom_idx].chemical_symbol 
-                  << " at (" << std::fixed << std::setprecision(6)
-                  << std::setw(9) << pos[0] << ", " 
-                  << std::setw(9) << pos[1] << ", " 
-                  << std::setw(9) << pos[2] << ")\n";
+    // Spread order maps the enumeration index through a bijection of [0, 2^N). Odd multipliers
+    // and x ^= x >> s are both invertible modulo 2^N, and the multiplications carry the low index
+    // bits into the high spin sites, so any prefix of the indices flips every site evenly. A space
+    // that is not a power of two is walked through the enclosing power of two until the image
+    // lands inside it again, which keeps the map a bijection.
+    unsigned int spread_bits = 0;
+    while (spread_bits < 64 && ((space_size - 1) >> spread_bits) != 0) ++spread_bits;
+    const size_t id_mask = spread_bits == 64 ? ~static_cast<size_t>(0) : (static_cast<size_t>(1) << spread_bits) - 1;
+    const unsigned int mix_shift = (spread_bits + 1) / 2;
+    auto configuration_at = [&](size_t index) -> size_t {
+        if (!options.spread_order || spread_bits < 2) return index;
+        size_t x = index;
+        do {
+            x = (x * 0x9E3779B97F4A7C15ULL) & id_mask;
+            x ^= x >> mix_shift;
+            x = (x * 0xBF58476D1CE4E5B9ULL) & id_mask;
+        } while (x >= space_size);
+        return x;
+    };
+    
+    // Never start more workers than there are configurations to test
+    const size_t num_threads = std::max<size_t>(1, std::min<size_t>(
+        resolve_thread_count(options.num_threads), total_configurations));
+    
+    // Structure data is identical for every configuration; extract it once
+    const std::vector<Vector3d> positions = structure.get_all_scaled_positions();
+    std::vector<std::string> chemical_symbols;
+    for (const auto& atom : structure.atoms) {
+        chemical_symbols.push_back(atom.chemical_symbol);
     }
-    std::cout << "-----------------------------------------------------------------------\n\n";
+    
+    // A tolerance sweep replaces the single checker: every listed tolerance in one evaluation
+    std::unique_ptr<ToleranceSweep> sweep;
+    if (!options.tolerances.empty()) {
+        if (options.engine != SearchEngine::TABLE) {
+            throw std::invalid_argument("A tolerance sweep needs the table engine");
+        }
+        if (ternary && ternary->symmetry_dedup()) {
+            // The site permutation group itself depends on the tolerance
+            throw std::invalid_argument("A tolerance sweep with --ternary needs --no-dedup");
+        }
+        ScopedSpan span("orbit setup");
+        sweep = std::make_unique<ToleranceSweep>(structure, options.tolerances);
+    }
+    
+    // The table engine is shared read-only by all workers
+    std::unique_ptr<AltermagnetChecker> checker;
+    if (options.engine == SearchEngine::TABLE && !sweep) {
+        ScopedSpan span("orbit setup");
+        checker = std::make_unique<AltermagnetChecker>(
+            structure.symmetry_operations, positions, structure.equivalent_atoms, tolerance);
+    }
+    
+    // Gray-code walk: index i visits id i ^ (i >> 1), which differs from the previous id in bit
+    // ctz(i) only, so each step flips one site and re-checks one orbit. The ids form a
+    // permutation of the space, so contiguous index ranges still split it between the workers.
+    // Partial searches keep the natural order so that a prefix means the smallest ids.
+    const bool gray_walk = options.gray_walk && checker && !ternary && !constrained &&
+                           !options.spread_order && total_configurations == space_size;
     
     std::vector<SpinConfiguration> altermagnetic_configs;
     std::mutex results_mutex;
-    std::mutex output_mutex;  // For thread-safe console output
-    std::atomic<size_t> completed_configs(0);
-    std::atomic<size_t> altermagnetic_count(0);
     
-    // GPU-accelerated search if available
-#ifdef HAVE_CUDA
-    if (use_cuda && cuda_searcher) {
-        std::cout << "Starting GPU-accelerated search...\n";
-        
-        try {
-            std::vector<SpinConfiguration> gpu_results = cuda_searcher->search_configurations(
-                structure, magnetic_indices, tolerance, verbose
-            );
-            
-            // Process GPU results
-            for (const auto& config : gpu_results) {
-                if (config.is_altermagnetic) {
-                    altermagnetic_configs.push_back(config);
-                    altermagnetic_count++;
-                    
-                    // Display configuration immediately when found
-                    std::cout << "GPU FOUND Config #" << std::setw(8) << config.configuration_id << ": ";
-                    
-                    // Show compact spin pattern
-                    for (size_t j = 0; j < config.spins.size(); ++j) {
-                        if (j > 0) std::cout << " ";
-                        std::cout << spin_to_string(config.spins[j]);
-                    }
-                    
-                    // Show detailed atomic assignment
-                    std::cout << " | ";
-                    for (size_t j = 0; j < structure.atoms.size(); ++j) {
-                        if (j > 0) std::cout << " ";
-                        std::cout << structure.atoms[j].chemical_symbol;
-                        
-                        // Add spin arrow symbols
-                        switch (config.spins[j]) {
-                            case SpinType::UP:
-                                std::cout << "(↑)";
-                                break;
-                            case SpinType::DOWN:
-                                std::cout << "(↓)";
-                                break;
-                            case SpinType::NONE:
-                                std::cout << "(—)";
-                                break;
-                        }
-                    }
-                    std::cout << "\n" << std::flush;
-                }
-            }
-            
-            completed_configs = total_configurations;
-            
-            std::cout << "\r" << std::string(80, ' ') << "\r";  // Clear progress line
-            std::cout << "GPU search completed: " << total_configurations << "/" << total_configurations 
-                      << " configurations processed\n\n";
-            
-        } catch (const std::exception& e) {
-            std::cout << "GPU search failed: " << e.what() << "\n";
-            std::cout << "Falling back to CPU search...\n";
-            use_cuda = false;
-            acceleration_method = "CPU (GPU fallback)";
-        }
-    }
+    // Each worker owns one cache line of counters; only the reporter thread sums them
+    struct alignas(64) WorkerCounters {
+        std::atomic<size_t> completed{0};
+        std::atomic<size_t> found{0};
+    };
+    std::vector<WorkerCounters> worker_counters(num_threads);
     
-    // Only run CPU search if GPU didn't complete the task
-    if (!use_cuda) {
-#endif
+    // Set by the reporter thread once the time budget is spent
+    std::atomic<bool> stop_requested(false);
     
-        // CPU multithreaded search (fallback or primary method)
-        
-        // Create worker function - only considers magnetic atoms
-        auto worker = [&](size_t start_config, size_t end_config) {
-            std::vector<SpinConfiguration> local_results;
+    auto worker = [&](size_t thread_index, size_t start_config, size_t end_config) {
+        if (options.pin_threads) {
+            pin_current_thread(thread_index);
+        }
+        // Everything below is allocated after pinning, so first-touch places the per-thread
+        // result buffer and scratch spins on the worker's own NUMA node
+        WorkerCounters& progress = worker_counters[thread_index];
+        ScopedSpan span("chunk", "worker", "configurations " + std::to_string(start_config) + "-" + std::to_string(end_config));
+        ScopedPerfCounters counters("search");
+        counters.add_units(end_config - start_config);
+        std::vector<SpinConfiguration> local_results;
+        std::vector<SpinType> spins(num_atoms, SpinType::NONE);
+        std::vector<double> flips;
+        std::unique_ptr<IncrementalChecker> walk;
+        if (gray_walk) walk = std::make_unique<IncrementalChecker>(*checker);
         
-        for (size_t config_id = start_config; config_id < end_config; ++config_id) {
-            // Initialize all spins to NONE first
-            std::vector<SpinType> spins(num_atoms, SpinType::NONE);
-            
-            // Generate spin configuration for magnetic atoms only (UP=0, DOWN=1)
-            size_t temp_id = config_id;
-            
-            for (size_t i = 0; i < num_magnetic_atoms; ++i) {
-                size_t atom_idx = magnetic_indices[i];
-                int spin_val = temp_id % 2;  // Only UP (0) or DOWN (1)
-                temp_id /= 2;
-                
-                spins[atom_idx] = (spin_val == 0) ? SpinType::UP : SpinType::DOWN;
+        for (size_t index = start_config; index < end_config; ++index) {
+            // Polling every 1024 configurations keeps the shared flag off the hot path
+            if ((index & 1023) == 0 && stop_requested.load(std::memory_order_relaxed)) {
+                break;
             }
-            
-            // Extract data for altermagnet analysis
-            std::vector<Vector3d> positions = structure.get_all_scaled_positions();
-            std::vector<std::string> chemical_symbols;
-            
-            for (const auto& atom : structure.atoms) {
-                chemical_symbols.push_back(atom.chemical_symbol);
+            size_t config_id = 0;
+            if (walk) {
+                config_id = index ^ (index >> 1);
+                if (index == start_config) {
+                    decode_configuration_id(config_id, magnetic_indices, spins);
+                    walk->reset(spins);
+                } else {
+                    size_t bit = 0;
+                    while (((index >> bit) & 1) == 0) ++bit;
+                    walk->flip(magnetic_indices[bit]);
+                }
+            } else if (ternary) {
+                config_id = ternary->decode(configuration_at(index), spins);
+            } else {
+                config_id = configuration_at(index);
+                if (constrained) config_id = constrained->configuration_id(config_id);
+                decode_configuration_id(config_id, magnetic_indices, spins);
             }
             
-            // Check if this configuration is altermagnetic with error handling
+            // Configurations that violate constraints (e.g., unequal up/down spins per orbit) throw
             bool is_am = false;
-            try {
-                is_am = is_altermagnet(
-                    structure.symmetry_operations,
-                    positions,
-                    structure.equivalent_atoms,
-                    chemical_symbols,
-                    spins,
-                    tolerance,
-                    false,  // not verbose
-                    true    // silent
-                );
-            } catch (const std::exception& e) {
-                // Skip configurations that violate constraints (e.g., unequal up/down spins per orbit)
-                completed_configs++;
-                continue;
+            uint64_t verdicts = 0;
+            if (walk) {
+                is_am = walk->outcome() == CheckOutcome::ALTERMAGNET;
+            } else if (ternary && !ternary->is_canonical(spins)) {
+                // Symmetry-equivalent to a smaller id, which is tested instead
+            } else if (sweep) {
+                // Kept when altermagnetic at any of the tolerances
+                verdicts = sweep->evaluate(spins, &flips);
+                is_am = verdicts != 0;
+            } else if (checker) {
+                // INVALID is the table engine's equivalent of is_altermagnet() throwing
+                is_am = checker->evaluate(spins) == CheckOutcome::ALTERMAGNET;
+            } else {
+                try {
+                    is_am = is_altermagnet(
+                        structure.symmetry_operations,
+                        positions,
+                        structure.equivalent_atoms,
+                        chemical_symbols,
+                        spins,
+                        tolerance,
+                        false,  // not verbose
+                        true    // silent
+                    );
+                } catch (const std::exception&) {
+                    is_am = false;
+                }
             }
             
             if (is_am) {
                 SpinConfiguration config;
-                config.spins = spins;
+                config.spins = walk ? walk->spins() : spins;
                 config.is_altermagnetic = true;
                 config.configuration_id = config_id;
-                local_results.push_back(config);
-                altermagnetic_count++;
-                
-                // Display configuration immediately when found
-                {
-                    std::lock_guard<std::mutex> lock(output_mutex);
-                    std::cout << "\r" << std::string(80, ' ') << "\r";  // Clear progress line
-                    std::cout << "FOUND Config #" << std::setw(8) << config_id << ": ";
-                    
-                    // Show compact spin pattern
-                    for (size_t j = 0; j < spins.size(); ++j) {
-                        if (j > 0) std::cout << " ";
-                        std::cout << spin_to_string(spins[j]);
-                    }
-                    
-                    // Show detailed atomic assignment
-                    std::cout << " | ";
-                    for (size_t j = 0; j < structure.atoms.size(); ++j) {
-                        if (j > 0) std::cout << " ";
-                        std::cout << structure.atoms[j].chemical_symbol;
-                        
-                        // Add spin arrow symbols
-                        switch (spins[j]) {
-                            case SpinType::UP:
-                                std::cout << "(↑)";
-                                break;
-                            case SpinType::DOWN:
-                                std::cout << "(↓)";
-                                break;
-                            case SpinType::NONE:
-                                std::cout << "(—)";
-                                break;
-                        }
-                    }
-                    std::cout << "\n" << std::flush;
+                if (sweep) {
+                    config.altermagnetic_at = verdicts;
+                    config.flip_tolerances = flips;
+                }
+                progress.found.fetch_add(1, std::memory_order_relaxed);
+                if (on_found) {
+                    on_found(config);
                 }
+                local_results.push_back(std::move(config));
             }
             
-            completed_configs++;
-            
-            // Progress reporting (every 100000 configurations or 1% whichever is smaller)
-            size_t progress_interval = std::min(static_cast<size_t>(100000), 
-                                               std::max(static_cast<size_t>(1), total_configurations / 100));
-            if (completed_configs % progress_interval == 0) {
-                std::lock_guard<std::mutex> lock(output_mutex);
-                double progress = 100.0 * completed_configs / total_configurations;
-                std::cout << "\rProgress: " << std::fixed << std::setprecision(1) 
-                          << progress << "% (" << completed_configs << "/" 
-                          << total_configurations << ") - Found: " 
-                          << altermagnetic_count << " altermagnetic configs" << std::flush;
-            }
+            progress.completed.fetch_add(1, std::memory_order_relaxed);
         }
         
         // Merge local results into global results
         std::lock_guard<std::mutex> lock(results_mutex);
         altermagnetic_configs.insert(altermagnetic_configs.end(), 
-                                   local_results.begin(), local_results.end());
+                                     local_results.begin(), local_results.end());
     };
     
+    ScopedSpan enumeration_span("enumeration", "phase", engine_to_string(options.engine));
+    const auto search_start = std::chrono::steady_clock::now();
+    
     // Launch threads
     std::vector<std::thread> threads;
     const size_t configs_per_thread = total_configurations / num_threads;
     const size_t remaining_configs = total_configurations % num_threads;
     
-    for (unsigned int t = 0; t < num_threads; ++t) {
+    for (size_t t = 0; t < num_threads; ++t) {
         size_t start_config = t * configs_per_thread;
         size_t end_config = (t + 1) * configs_per_thread;
         
@@ -784,33 +754,70 @@ void search_all_spin_configurations(
             end_config += remaining_configs;
         }
         
-        threads.emplace_back(worker, start_config, end_config);
+        threads.emplace_back(worker, t, start_config, end_config);
     }
     
-    // Wait for all threads to complete
-    for (auto& thread : threads) {
-        thread.join();
-    }
-    
-    std::cout << "\rProgress: 100.0% (" << total_configurations << "/" 
-              << total_configurations << ") - Found: " 
-              << altermagnetic_count << " altermagnetic configs\n\n";
+    auto snapshot = [&](bool finished) {
+        SearchProgress progress;
+        progress.total = total_configurations;
+        progress.finished = finished;
+        progress.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - search_start).count();
+        for (const auto& counters : worker_counters) {
+            const size_t completed = counters.completed.load(std::memory_order_relaxed);
+            progress.thread_completed.push_back(completed);
+            progress.completed += completed;
+            progress.found += counters.found.load(std::memory_order_relaxed);
+        }
+        progress.budget_exhausted = stop_requested.load(std::memory_order_relaxed) &&
+                                    progress.completed < progress.total;
+        return progress;
+    };
     
-#ifdef HAVE_CUDA
-    } // End of CPU search conditional block
-#endif
+    // Reporter thread: periodic snapshots and the time budget, so workers never read the clock
+    std::mutex reporter_mutex;
+    std::condition_variable reporter_wake;
+    bool workers_done = false;
+    std::thread reporter;
+    const bool has_budget = options.time_budget_s > 0.0;
+    if (on_progress || has_budget) {
+        const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(on_progress ? std::max(0.01, options.progress_interval_s) : 0.1));
+        const auto deadline = search_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(options.time_budget_s));
+        reporter = std::thread([&]() {
+            std::unique_lock<std::mutex> lock(reporter_mutex);
+            auto next_wake = [&]() {
+                const auto tick = std::chrono::steady_clock::now() + interval;
+                return has_budget && !stop_requested.load() ? std::min(tick, deadline) : tick;
+            };
+            while (!reporter_wake.wait_until(lock, next_wake(), [&] { return workers_done; })) {
+                lock.unlock();
+                if (has_budget && std::chrono::steady_clock::now() >= deadline) {
+                    stop_requested.store(true, std::memory_order_relaxed);
+                }
+                if (on_progress) {
+                    on_progress(snapshot(false));
+                }
+                lock.lock();
+            }
+        });
+    }
     
-    // Display results
-    std::cout << "=======================================================================\n";
-    std::cout << "                           SEARCH RESULTS\n";
-    std::cout << "=======================================================================\n";
-    std::cout << "Total configurations tested: " << total_configurations << "\n";
-    std::cout << "Altermagnetic configurations found: " << altermagnetic_configs.size() << "\n";
+    // Wait for all threads to complete
+    for (auto& thread : threads) {
+        thread.join();
+    }
     
-    if (altermagnetic_configs.empty()) {
-        std::cout << "\nNo altermagnetic configurations found for this structure.\n";
-        std::cout << "=======================================================================\n";
-        return;
+    if (reporter.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(reporter_mutex);
+            workers_done = true;
+        }
+        reporter_wake.notify_one();
+        reporter.join();
+    }
+    if (on_progress) {
+        on_progress(snapshot(true));
     }
     
     // Sort by configuration ID for consistent output
@@ -819,21 +826,44 @@ void search_all_spin_configurations(
                   return a.configuration_id < b.configuration_id;
               });
     
-    // Save all configurations to file
-    std::ofstream outfile(output_filename);
+    return altermagnetic_configs;
+}
+
+void write_search_results(
+    const std::string& filename,
+    const CrystalStructure& structure,
+    const std::vector<SpinConfiguration>& configs,
+    size_t total_configurations,
+    double tolerance,
+    const std::string& acceleration_method,
+    long double space_size,
+    const TernarySpace* ternary,
+    const std::vector<double>& tolerance_sweep
+) {
+    ScopedSpan span("output");
+    std::ofstream outfile(filename);
     if (!outfile.is_open()) {
-        std::cerr << "ERROR: Could not open output file: " << output_filename << "\n";
-        return;
+        throw std::runtime_error("Could not open output file: " + filename);
     }
     
     // Write header to file
     outfile << "# AMCheck C++ - Altermagnetic Spin Configurations\n";
     outfile << "# Generated on: " << __DATE__ << " " << __TIME__ << "\n";
-    outfile << "# Structure: " << num_atoms << " atoms\n";
+    outfile << "# Structure: " << structure.atoms.size() << " atoms\n";
     outfile << "# Acceleration method: " << acceleration_method << "\n";
     outfile << "# Total configurations tested: " << total_configurations << "\n";
-    outfile << "# Altermagnetic configurations found: " << altermagnetic_configs.size() << "\n";
-    outfile << "# Tolerance: " << tolerance << "\n";
+    if (space_size > total_configurations) {
+        outfile << "# Configuration space: " << std::fixed << std::setprecision(0) << space_size << " (coverage "
+                << std::defaultfloat << std::setprecision(4) << (100.0L * total_configurations / space_size) << "%)\n";
+    }
+    outfile << "# Altermagnetic configurations found: " << configs.size() << "\n";
+    if (tolerance_sweep.empty()) {
+        outfile << "# Tolerance: " << tolerance << "\n";
+    } else {
+        outfile << "# Tolerance sweep:";
+        for (double tol : tolerance_sweep) outfile << " " << tol;
+        outfile << " (configurations altermagnetic at any of them)\n";
+    }
     outfile << "#\n";
     outfile << "# Atomic structure:\n";
     for (size_t i = 0; i < structure.atoms.size(); ++i) {
@@ -846,13 +876,25 @@ void search_all_spin_configurations(
                 << std::setw(9) << pos[2] << ")\n";
     }
     outfile << "#\n";
+    if (ternary) {
+        outfile << "# Search: ternary (balanced up/down/none patterns"
+                << (ternary->symmetry_dedup() ? ", one per symmetry class" : "") << ")\n";
+    }
     outfile << "# Format: ConfigID | Spin_Pattern | Detailed_Assignment\n";
+    if (ternary) {
+        outfile << "#         ConfigID is base 3: digit i is magnetic site i (0 = up, 1 = down, 2 = none)\n";
+    }
+    if (!tolerance_sweep.empty()) {
+        outfile << "#         followed by | Verdicts | Flips: 1/0 = altermagnetic or not at each swept\n";
+        outfile << "#         tolerance, and the tolerances at which the verdict changes (it holds up to\n";
+        outfile << "#         and including the value, the next verdict above it)\n";
+    }
     outfile << "#         u = up, d = down, n = none\n";
     outfile << "#         ↑ = spin up, ↓ = spin down, — = non-magnetic\n";
     outfile << "#\n\n";
     
     // Write all configurations to file
-    for (const auto& config : altermagnetic_configs) {
+    for (const auto& config : configs) {
         // Configuration ID and compact spin pattern
         outfile << "Config #" << std::setw(8) << config.configuration_id << ": ";
         
@@ -880,357 +922,537 @@ void search_all_spin_configurations(
                     break;
             }
         }
-        outfile << "\n";
-    }
-    
-    outfile.close();
-    std::cout << "\nAll " << altermagnetic_configs.size() 
-              << " altermagnetic configurations saved to: " << output_filename << "\n";
-    
-    std::cout << "\nFirst 50 altermagnetic configurations:\n";
-    std::cout << "-----------------------------------------------------------------------\n";
-    
-    for (size_t i = 0; i < std::min(static_cast<size_t>(50), altermagnetic_configs.size()); ++i) {
-        const auto& config = altermagnetic_configs[i];
-        std::cout << "Config #" << std::setw(8) << config.configuration_id << ": ";
-        
-        // Show compact spin pattern
-        for (size_t j = 0; j < config.spins.size(); ++j) {
-            if (j > 0) std::cout << " ";
-            std::cout << spin_to_string(config.spins[j]);
-        }
-        
-        // Show detailed atomic assignment
-        std::cout << " | ";
-        for (size_t j = 0; j < structure.atoms.size(); ++j) {
-            if (j > 0) std::cout << " ";
-            std::cout << structure.atoms[j].chemical_symbol;
-            
-            // Add spin arrow symbols
-            switch (config.spins[j]) {
-                case SpinType::UP:
-                    std::cout << "(↑)";
-                    break;
-                case SpinType::DOWN:
-                    std::cout << "(↓)";
-                    break;
-                case SpinType::NONE:
-                    std::cout << "(—)";
-                    break;
+        if (!tolerance_sweep.empty()) {
+            outfile << " | ";
+            for (size_t k = 0; k < tolerance_sweep.size(); ++k) {
+                outfile << ((config.altermagnetic_at >> k) & 1);
             }
+            outfile << " | " << std::defaultfloat << std::setprecision(6);
+            for (size_t k = 0; k < config.flip_tolerances.size(); ++k) {
+                outfile << (k ? " " : "") << config.flip_tolerances[k];
+            }
+            if (config.flip_tolerances.empty()) outfile << "-";
+            outfile << std::fixed;
         }
-        std::cout << "\n";
+        outfile << "\n";
     }
-    
-    if (altermagnetic_configs.size() > 50) {
-        std::cout << "... and " << (altermagnetic_configs.size() - 50) 
-                  << " more configurations (see " << output_filename << " for complete list).\n";
+}
+
+namespace {
+
+// Extrapolates a partial search to the whole configuration space. The spread order is
+// deterministic, but it is treated as a uniform random sample (Wilson score interval, 95%).
+void print_coverage_estimate(size_t tested, size_t found, long double space_size) {
+    std::cout << "Coverage: " << std::fixed << std::setprecision(4) << (100.0L * tested / space_size)
+              << "% of " << std::setprecision(0) << space_size << " configurations\n";
+    if (tested == 0) return;
+    
+    const double z = 1.96;
+    const double n = static_cast<double>(tested);
+    const double p = found / n;
+    const double denominator = 1.0 + z * z / n;
+    const double center = (p + z * z / (2.0 * n)) / denominator;
+    const double half_width = z * std::sqrt(p * (1.0 - p) / n + z * z / (4.0 * n * n)) / denominator;
+    std::cout << "Estimated altermagnetic configurations in the full space: " << std::setprecision(0)
+              << p * space_size << " (95% interval " << std::max(0.0, center - half_width) * space_size
+              << " - " << std::min(1.0, center + half_width) * space_size << ")\n";
+}
+
+// Per-tolerance counts of a --tolerances search and how many verdicts depend on the tolerance
+void print_tolerance_sweep(const std::vector<double>& tolerances, const std::vector<SpinConfiguration>& configs) {
+    std::cout << "Altermagnetic configurations per tolerance:\n";
+    for (size_t k = 0; k < tolerances.size(); ++k) {
+        const size_t count = std::count_if(configs.begin(), configs.end(), [k](const SpinConfiguration& config) {
+            return (config.altermagnetic_at >> k) & 1;
+        });
+        std::cout << "  " << std::setw(12) << std::defaultfloat << tolerances[k] << "  " << count << "\n";
     }
-        
-        if (verbose && altermagnetic_configs.size() <= 10) {
-            std::cout << "\nDetailed analysis of altermagnetic configurations:\n";
-            std::cout << "-----------------------------------------------------------------------\n";
-            
-            for (const auto& config : altermagnetic_configs) {
-                std::cout << "\nConfiguration #" << config.configuration_id << ":\n";
-                
-                // Show atomic details with positions and spin arrows
-                for (size_t j = 0; j < structure.atoms.size(); ++j) {
-                    Vector3d pos = structure.get_scaled_position(j);
-                    std::cout << "  Atom " << std::setw(2) << (j+1) << ": " 
-                              << std::setw(2) << structure.atoms[j].chemical_symbol 
-                              << " at (" << std::fixed << std::setprecision(6)
-                              << std::setw(9) << pos[0] << ", " 
-                              << std::setw(9) << pos[1] << ", " 
-                              << std::setw(9) << pos[2] << ") ";
-                    
-                    // Add spin arrow symbols
-                    switch (config.spins[j]) {
-                        case SpinType::UP:
-                            std::cout << "(↑)";
-                            break;
-                        case SpinType::DOWN:
-                            std::cout << "(↓)";
-                            break;
-                        case SpinType::NONE:
-                            std::cout << "(—)";
-                            break;
-                    }
-                    std::cout << "\n";
-                }
-            }
-        }
-    
-    std::cout << "\nSummary:\n";
-    std::cout << "-----------------------------------------------------------------------\n";
-    std::cout << "- Acceleration method: " << acceleration_method << "\n";
-    std::cout << "- Total configurations tested: " << total_configurations << "\n";
-    std::cout << "- Altermagnetic configurations found: " << altermagnetic_configs.size() << "\n";
-    std::cout << "- Success rate: " << std::fixed << std::setprecision(2) 
-              << (100.0 * altermagnetic_configs.size() / total_configurations) << "%\n";
-    std::cout << "- Results saved to: " << output_filename << "\n";
-    
-    std::cout << "=======================================================================\n";
+    const uint64_t all = tolerances.size() == 64 ? ~static_cast<uint64_t>(0)
+                                                 : (static_cast<uint64_t>(1) << tolerances.size()) - 1;
+    const size_t dependent = std::count_if(configs.begin(), configs.end(), [all](const SpinConfiguration& config) {
+        return config.altermagnetic_at != all;
+    });
+    std::cout << "Verdict depends on the tolerance for " << dependent << " configuration"
+              << (dependent == 1 ? "" : "s") << " (flip tolerances in the results file)\n";
 }
 
-void perform_smart_sampling_search(
+} // namespace
+
+void search_all_spin_configurations(
     const CrystalStructure& structure,
-    const std::vector<size_t>& magnetic_indices,
     const std::string& input_filename,
     double tolerance,
     bool verbose,
-    const std::string& acceleration_method
+    bool use_gpu,
+    const SearchOptions& options
 ) {
     const size_t num_atoms = structure.atoms.size();
-    const size_t num_magnetic_atoms = magnetic_indices.size();
     
-    // Smart sampling parameters
-    const size_t max_samples = 1000000;  // Sample up to 1M configurations
-    const size_t batch_size = 10000;     // Process in batches
-    const size_t early_stop_threshold = 100;  // Stop if we find enough examples
+    // Get indices of magnetic atoms only
+    std::vector<size_t> magnetic_indices = get_magnetic_atom_indices(structure, options.magnetic);
+    const size_t num_magnetic_atoms = magnetic_indices.size();
     
-    std::cout << "\n=======================================================================\n";
-    std::cout << "                    SMART SAMPLING SEARCH MODE\n";
-    std::cout << "                     (LARGE STRUCTURE OPTIMIZATION)\n";
-    std::cout << "=======================================================================\n";
-    std::cout << "Structure: " << num_atoms << " total atoms (" << num_magnetic_atoms << " magnetic)\n";
-    std::cout << "Sampling approach: Random selection with bias toward balanced configurations\n";
-    std::cout << "Maximum samples: " << max_samples << "\n";
-    std::cout << "Acceleration method: " << acceleration_method << "\n";
-    std::cout << "Early stopping: After finding " << early_stop_threshold << " altermagnetic configs\n";
-    std::cout << "=======================================================================\n\n";
+    // GPU acceleration setup
+    bool use_cuda = false;
+    std::string acceleration_method = "CPU";
     
-    std::vector<SpinConfiguration> altermagnetic_configs;
-    std::mutex results_mutex;
-    std::atomic<size_t> completed_samples(0);
-    std::atomic<size_t> altermagnetic_count(0);
+#ifdef HAVE_CUDA
+    std::unique_ptr<cuda::CudaSpinSearcher> cuda_searcher;
     
-    // Random number generation
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<size_t> config_dist(0, (1ULL << num_magnetic_atoms) - 1);
+    // GPU support is being developed but temporarily disabled for stability
+    bool cuda_disabled_for_compatibility = true;  // Re-enable with safer implementation  // Re-enabled with fixes for older GPUs
     
-    auto start_time = std::chrono::steady_clock::now();
+    if (use_gpu && !cuda_disabled_for_compatibility) {
+        cuda_searcher = std::make_unique<cuda::CudaSpinSearcher>();
+        if (cuda_searcher->initialize()) {
+            use_cuda = true;
+            acceleration_method = "GPU (CUDA)";
+            
+            auto config = cuda_searcher->get_config();
+            std::cout << "🚀 CUDA GPU Acceleration Enabled!\n";
+            std::cout << "GPU: " << config.device_name << "\n";
+            std::cout << "Memory: " << (config.memory_limit / (1024*1024)) << " MB\n";
+            std::cout << "Compute Capability: " << (config.compute_capability / 10) << "." << (config.compute_capability % 10) << "\n\n";
+        } else {
+            std::cout << "⚠️  GPU requested but not available - falling back to CPU\n";
+            cuda_searcher.reset(); // Clean up failed searcher
+        }
+    } else if (use_gpu && cuda_disabled_for_compatibility) {
+        std::cout << "⚠️  GPU requested but CUDA support is temporarily disabled\n";
+        std::cout << "Note: GPU acceleration is being developed but disabled for stability\n";
+        std::cout << "      Current focus is on robust CPU multithreading performance\n";
+        std::cout << "Using optimized CPU multithreading instead\n";
+    } else {
+        std::cout << "💻 CPU-only mode selected\n";
+    }
+#else
+    if (use_gpu) {
+        std::cout << "⚠️  GPU requested but CUDA support not compiled - using CPU\n";
+    }
+#endif
     
-    std::cout << "Starting smart sampling search...\n";
+    if (num_magnetic_atoms == 0) {
+        std::cout << "\n=======================================================================\n";
+        std::cout << "                  NO MAGNETIC ATOMS DETECTED\n";
+        std::cout << "=======================================================================\n";
+        std::cout << "Structure contains no potentially magnetic atoms.\n";
+        std::cout << "Altermagnet analysis requires magnetic atoms.\n";
+        std::cout << "=======================================================================\n\n";
+        return;
+    }
     
-    for (size_t batch = 0; batch < (max_samples / batch_size); ++batch) {
-        if (altermagnetic_count >= early_stop_threshold) {
-            std::cout << "\nEarly stopping: Found " << altermagnetic_count 
-                      << " altermagnetic configurations\n";
-            break;
+    // The default element list includes light elements, which in oxides and fluorides are the
+    // ligands; each of those sites doubles the search space without carrying a real moment
+    if (options.magnetic.is_default()) {
+        std::set<std::string> ligands, metals;
+        for (size_t idx : magnetic_indices) {
+            const std::string& symbol = structure.atoms[idx].chemical_symbol;
+            const bool light = symbol == "B" || symbol == "C" || symbol == "N" || symbol == "O" ||
+                               symbol == "F" || symbol == "S" || symbol == "Cl";
+            (light ? ligands : metals).insert(symbol);
         }
+        if (!ligands.empty() && !metals.empty()) {
+            std::string ligand_list, metal_list;
+            for (const auto& symbol : ligands) ligand_list += (ligand_list.empty() ? "" : ",") + symbol;
+            for (const auto& symbol : metals) metal_list += (metal_list.empty() ? "" : ",") + symbol;
+            std::cout << "NOTE: " << ligand_list << " sites are treated as magnetic by the default element list.\n";
+            std::cout << "      Use --magnetic " << metal_list << " to search only the metal sublattice.\n\n";
+        }
+    }
+    
+    // Calculate configurations based on magnetic atoms only: UP/DOWN, or with --ternary the
+    // balanced UP/DOWN/NONE patterns
+    std::unique_ptr<TernarySpace> ternary;
+    if (options.ternary) {
+        ScopedSpan span("ternary setup");
+        ternary = std::make_unique<TernarySpace>(structure, magnetic_indices, tolerance, options.symmetry_dedup);
+    }
+    std::unique_ptr<ConstrainedSpace> constrained;
+    if (!options.constraints.empty() && !ternary) {
+        constrained = std::make_unique<ConstrainedSpace>(structure, magnetic_indices, options.constraints);
+    }
+    const size_t space_size = ternary ? ternary->size()
+        : constrained ? constrained->size() : binary_space_size(num_magnetic_atoms);
+    // The exact count for reports; space_size saturates once a binary space has 64 sites
+    const long double full_space = ternary || constrained ? static_cast<long double>(space_size)
+                                                          : std::ldexp(1.0L, static_cast<int>(num_magnetic_atoms));
+    std::ostringstream full_space_text;
+    full_space_text << std::fixed << std::setprecision(0) << full_space;
+    // Size thresholds below are in binary-search terms (2^20 = 20 magnetic atoms)
+    auto space_exceeds = [space_size](size_t magnetic_atoms) {
+        return space_size > (static_cast<size_t>(1) << magnetic_atoms);
+    };
+    const unsigned int num_threads = resolve_thread_count(options.num_threads);
+    
+    const std::string base_filename = output_file_stem(input_filename);
+    const std::string timestamp = output_timestamp();
+    
+    SearchOptions run_options = options;
+    
+    if (space_exceeds(LARGE_SEARCH_MAGNETIC_ATOMS)) {
+        std::cout << "WARNING: Structure has " << num_magnetic_atoms << " magnetic atoms.\n";
+        std::cout << "This will generate " << full_space_text.str() << " configurations.\n";
         
-        std::vector<size_t> batch_configs;
-        std::set<size_t> used_configs;  // Avoid duplicates
-        
-        // Generate unique random configurations for this batch
-        while (batch_configs.size() < batch_size && used_configs.size() < batch_size * 2) {
-            size_t config_id = config_dist(gen);
-            if (used_configs.find(config_id) == used_configs.end()) {
-                used_configs.insert(config_id);
-                batch_configs.push_back(config_id);
+        if (!space_exceeds(25)) {
+            std::cout << "This may take a long time but is feasible with multithreading.\n";
+            std::cout << "Estimated time: ";
+            if (!space_exceeds(22)) {
+                std::cout << "a few minutes to 1 hour\n";
+            } else {
+                std::cout << "1-8 hours depending on CPU cores\n";
             }
+        } else {
+            std::cout << "This is computationally very expensive and may take days!\n";
+            std::cout << "\nRECOMMENDATIONS for large structures:\n";
+            std::cout << "1. Use representative supercell with fewer magnetic atoms\n";
+            std::cout << "2. Focus on specific magnetic sublattices\n";
+            std::cout << "3. Use symmetry-reduced configuration space\n";
+            std::cout << "4. Consider sampling approach rather than exhaustive search\n";
         }
         
-        // Process batch configurations
-        for (size_t config_id : batch_configs) {
-            std::vector<SpinType> spins(num_atoms, SpinType::NONE);
-            
-            // Generate spin configuration for magnetic atoms only
-            size_t temp_id = config_id;
-            for (size_t i = 0; i < num_magnetic_atoms; ++i) {
-                size_t atom_idx = magnetic_indices[i];
-                int spin_val = temp_id % 2;
-                temp_id /= 2;
-                spins[atom_idx] = (spin_val == 0) ? SpinType::UP : SpinType::DOWN;
-            }
-            
-            // Check if configuration is altermagnetic
-            try {
-                std::vector<Vector3d> positions = structure.get_all_scaled_positions();
-                std::vector<std::string> chemical_symbols;
-                for (const auto& atom : structure.atoms) {
-                    chemical_symbols.push_back(atom.chemical_symbol);
-                }
-                
-                bool is_am = is_altermagnet(
-                    structure.symmetry_operations,
-                    positions,
-                    structure.equivalent_atoms,
-                    chemical_symbols,
-                    spins,
-                    tolerance,
-                    false,  // not verbose
-                    true    // silent
-                );
-                
-                if (is_am) {
-                    SpinConfiguration config;
-                    config.spins = spins;
-                    config.is_altermagnetic = true;
-                    config.configuration_id = config_id;
+        LargeSearchPolicy policy = options.on_large;
+        if (policy == LargeSearchPolicy::ASK) {
+            if (options.time_budget_s > 0.0 || options.max_configurations > 0) {
+                std::cout << "\nSearch is bounded by --time-budget/--max-configs; continuing.\n";
+                policy = LargeSearchPolicy::EXHAUSTIVE;
+            } else if (!stdin_is_interactive()) {
+                // Batch jobs have no one to answer the prompt
+                std::cout << "\nstdin is not a terminal; continuing with --on-large sample.\n";
+                policy = LargeSearchPolicy::SAMPLE;
+            } else {
+                std::cout << "\nDo you want to continue with the full exhaustive search? (y/N): ";
+                std::string response;
+                std::getline(std::cin, response);
+                if (response == "y" || response == "Y") {
+                    policy = LargeSearchPolicy::EXHAUSTIVE;
+                } else {
+                    std::cout << "\nSearch cancelled.\n";
                     
-                    {
-                        std::lock_guard<std::mutex> lock(results_mutex);
-                        altermagnetic_configs.push_back(config);
-                        altermagnetic_count++;
-                        
-                        // Display immediately when found
-                        std::cout << "SAMPLED Config #" << std::setw(8) << config_id << ": ";
-                        for (size_t j = 0; j < spins.size(); ++j) {
-                            if (j > 0) std::cout << " ";
-                            std::cout << spin_to_string(spins[j]);
+                    // Offer alternative sampling approach for very large structures
+                    if (space_exceeds(25)) {
+                        std::cout << "\nAlternative: Would you like to try a smart sampling approach? (Y/n): ";
+                        std::string sample_response;
+                        std::getline(std::cin, sample_response);
+                        if (sample_response != "n" && sample_response != "N") {
+                            policy = LargeSearchPolicy::SAMPLE;
                         }
-                        std::cout << " | ";
-                        for (size_t j = 0; j < structure.atoms.size(); ++j) {
-                            if (j > 0) std::cout << " ";
-                            std::cout << structure.atoms[j].chemical_symbol;
-                            
-                            // Add spin arrow symbols
-                            switch (spins[j]) {
-                                case SpinType::UP:
-                                    std::cout << "(↑)";
-                                    break;
-                                case SpinType::DOWN:
-                                    std::cout << "(↓)";
-                                    break;
-                                case SpinType::NONE:
-                                    std::cout << "(—)";
-                                    break;
-                            }
-                        }
-                        std::cout << " [Found: " << altermagnetic_count << "]\n";
+                    }
+                    
+                    if (policy != LargeSearchPolicy::SAMPLE) {
+                        std::cout << "Consider using a smaller supercell or representative structure.\n";
+                        return;
                     }
                 }
-            } catch (const std::exception&) {
-                // Skip invalid configurations
             }
-            
-            completed_samples++;
         }
         
-        // Progress update
-        double progress = 100.0 * completed_samples / max_samples;
-        auto current_time = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(current_time - start_time);
-        
-        std::cout << "\rProgress: " << std::fixed << std::setprecision(1) 
-                  << progress << "% (" << completed_samples << "/" << max_samples 
-                  << ") - Found: " << altermagnetic_count << " configs - Time: " 
-                  << elapsed.count() << "s" << std::flush;
+        if (policy == LargeSearchPolicy::ABORT) {
+            throw std::runtime_error("Structure has " + std::to_string(num_magnetic_atoms) +
+                                     " magnetic atoms; exhaustive search refused (--on-large abort)");
+        }
+        if (policy == LargeSearchPolicy::SAMPLE && run_options.max_configurations == 0 &&
+            run_options.time_budget_s <= 0.0) {
+            run_options.max_configurations = DEFAULT_SAMPLE_CONFIGURATIONS;
+        }
     }
     
-    auto end_time = std::chrono::steady_clock::now();
-    auto total_time = std::chrono::duration_cast<std::chrono::seconds>(end_time - start_time);
-    
-    std::cout << "\n\n=======================================================================\n";
-    std::cout << "                      SAMPLING SEARCH RESULTS\n";
-    std::cout << "=======================================================================\n";
-    std::cout << "Total configurations sampled: " << completed_samples << "\n";
-    std::cout << "Altermagnetic configurations found: " << altermagnetic_configs.size() << "\n";
-    std::cout << "Sampling success rate: " << std::fixed << std::setprecision(4) 
-              << (100.0 * altermagnetic_configs.size() / completed_samples) << "%\n";
-    std::cout << "Total search time: " << total_time.count() << " seconds\n";
-    
-    if (altermagnetic_configs.empty()) {
-        std::cout << "\nNo altermagnetic configurations found in sample.\n";
-        std::cout << "This doesn't rule out altermagnetism - try larger sample or different approach.\n";
-        std::cout << "=======================================================================\n";
-        return;
+    const size_t total_configurations = run_options.max_configurations > 0
+        ? std::min(space_size, run_options.max_configurations) : space_size;
+    if (num_magnetic_atoms >= 64 && total_configurations == space_size && run_options.time_budget_s <= 0.0) {
+        throw std::invalid_argument("Exhaustive search supports at most 63 magnetic atoms; "
+                                    "bound it with --max-configs or --time-budget, or use --on-large sample");
     }
     
-    // Sort and display results
-    std::sort(altermagnetic_configs.begin(), altermagnetic_configs.end(),
-              [](const SpinConfiguration& a, const SpinConfiguration& b) {
-                  return a.configuration_id < b.configuration_id;
-              });
-    
-    // Save results to file with input-based filename
-    std::string base_filename = input_filename;
-    
-    // Extract just the filename without path
-    size_t last_slash = base_filename.find_last_of("/\\");
-    if (last_slash != std::string::npos) {
-        base_filename = base_filename.substr(last_slash + 1);
+    // A search that may stop early visits ids in spread order, so whatever was tested is an even
+    // sample of the space instead of a block of configurations that differ only in the first sites
+    if (run_options.time_budget_s > 0.0 || total_configurations < space_size) {
+        run_options.spread_order = true;
     }
     
-    // Remove common extensions
-    std::vector<std::string> extensions = {".vasp", ".poscar", ".POSCAR", ".cif", ".xyz"};
-    for (const auto& ext : extensions) {
-        if (base_filename.length() >= ext.length() && 
-            base_filename.substr(base_filename.length() - ext.length()) == ext) {
-            base_filename = base_filename.substr(0, base_filename.length() - ext.length());
-            break;
+    const std::string output_filename = base_filename +
+        (total_configurations < full_space ? "_amcheck_sampled_results_" : "_amcheck_results_") + timestamp + ".txt";
+    
+    std::cout << "\n=======================================================================\n";
+    std::cout << "                  MULTITHREADED SPIN CONFIGURATION SEARCH\n";
+    std::cout << "                           (MAGNETIC ATOMS ONLY)\n";
+    std::cout << "=======================================================================\n";
+    std::cout << "Structure: " << num_atoms << " total atoms (" << num_magnetic_atoms << " magnetic)\n";
+    std::cout << "Magnetic sublattice: " << describe_magnetic_selection(options.magnetic) << "\n";
+    if (ternary) {
+        std::ostringstream raw;
+        raw << std::fixed << std::setprecision(0) << ternary->raw_size();
+        std::cout << "Site states: up, down, none (" << raw.str() << " raw, " << space_size << " balanced)\n";
+        if (ternary->symmetry_dedup()) {
+            std::cout << "Symmetry deduplication: " << ternary->group_order() << " site permutations"
+                      << (ternary->group_truncated() ? " (group truncated, some duplicates remain)" : "")
+                      << " and global spin reversal\n";
+        } else if (options.symmetry_dedup) {
+            std::cout << "Symmetry deduplication: off (the symmetry operations are not a closed group, or sites\n"
+                      << "  sit within the tolerance of a symmetric position)\n";
         }
     }
-    
-    // If base_filename is empty or just "POSCAR", use "structure"
-    if (base_filename.empty() || base_filename == "POSCAR") {
-        base_filename = "structure";
+    if (constrained) {
+        std::cout << "Constraints: " << constrained->describe() << "\n";
+    }
+    std::cout << "Total configurations to test: " << total_configurations;
+    if (total_configurations < full_space) {
+        std::cout << " (evenly spread sample of " << full_space_text.str() << ")";
     }
+    std::cout << "\n";
+    if (run_options.time_budget_s > 0.0) {
+        std::cout << "Time budget: " << run_options.time_budget_s << " s (partial results are kept)\n";
+    }
+    std::cout << "Acceleration method: " << acceleration_method << "\n";
+    std::cout << "Worker threads: " << num_threads << " (" << describe_cpu_budget(detect_cpu_budget())
+              << (options.num_threads > 0 ? ", set by --threads" : "")
+              << (options.pin_threads ? ", pinned" : "") << ")\n";
+    if (options.tolerances.empty()) {
+        std::cout << "Tolerance: " << tolerance << "\n";
+    } else {
+        std::cout << "Tolerance sweep:";
+        for (double tol : options.tolerances) std::cout << " " << tol;
+        std::cout << " (one pass)\n";
+    }
+    std::cout << "Output file: " << output_filename << "\n";
+    std::cout << "=======================================================================\n\n";
     
-    // Generate timestamped output filename for sampling
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto tm = *std::localtime(&time_t);
+    // Print atomic structure information
+    std::cout << "Magnetic atoms to be configured:\n";
+    std::cout << "-----------------------------------------------------------------------\n";
+    for (size_t i = 0; i < magnetic_indices.size(); ++i) {
+        size_t atom_idx = magnetic_indices[i];
+        Vector3d pos = structure.get_scaled_position(atom_idx);
+        std::cout << "Mag " << std::setw(2) << (i + 1) << " (Atom " << std::setw(2) << (atom_idx + 1) << "): " 
+                  << std::setw(2) << structure.atoms[atom_idx].chemical_symbol 
+                  << " at (" << std::fixed << std::setprecision(6)
+                  << std::setw(9) << pos[0] << ", " 
+                  << std::setw(9) << pos[1] << ", " 
+                  << std::setw(9) << pos[2] << ")\n";
+    }
+    std::cout << "-----------------------------------------------------------------------\n\n";
     
-    char timestamp[32];
-    std::strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", &tm);
+    std::vector<SpinConfiguration> altermagnetic_configs;
+    std::atomic<size_t> completed_configs(0);
+    std::atomic<size_t> altermagnetic_count(0);
+    size_t tested_configurations = total_configurations;
+    bool budget_exhausted = false;
     
-    std::string output_filename = base_filename + "_amcheck_sampled_results_" + timestamp + ".txt";
-    std::ofstream outfile(output_filename);
-    if (outfile.is_open()) {
-        outfile << "# AMCheck C++ - Sampled Altermagnetic Spin Configurations\n";
-        outfile << "# Sampling method for large structures\n";
-        outfile << "# Total samples: " << completed_samples << "\n";
-        outfile << "# Altermagnetic configs found: " << altermagnetic_configs.size() << "\n";
-        outfile << "# Success rate: " << (100.0 * altermagnetic_configs.size() / completed_samples) << "%\n";
-        outfile << "#\n\n";
+    // GPU-accelerated search if available
+#ifdef HAVE_CUDA
+    if (use_cuda && cuda_searcher) {
+        std::cout << "Starting GPU-accelerated search...\n";
         
-        for (const auto& config : altermagnetic_configs) {
-            outfile << "Config #" << std::setw(8) << config.configuration_id << ": ";
+        try {
+            std::vector<SpinConfiguration> gpu_results = cuda_searcher->search_configurations(
+                structure, magnetic_indices, tolerance, verbose
+            );
+            
+            // Process GPU results
+            for (const auto& config : gpu_results) {
+                if (config.is_altermagnetic) {
+                    altermagnetic_configs.push_back(config);
+                    altermagnetic_count++;
+                    
+                    // Display configuration immediately when found
+                    std::cout << "GPU FOUND Config #" << std::setw(8) << config.configuration_id << ": ";
+                    
+                    // Show compact spin pattern
+                    for (size_t j = 0; j < config.spins.size(); ++j) {
+                        if (j > 0) std::cout << " ";
+                        std::cout << spin_to_string(config.spins[j]);
+                    }
+                    
+                    // Show detailed atomic assignment
+                    std::cout << " | ";
+                    for (size_t j = 0; j < structure.atoms.size(); ++j) {
+                        if (j > 0) std::cout << " ";
+                        std::cout << structure.atoms[j].chemical_symbol;
+                        
+                        // Add spin arrow symbols
+                        switch (config.spins[j]) {
+                            case SpinType::UP:
+                                std::cout << "(↑)";
+                                break;
+                            case SpinType::DOWN:
+                                std::cout << "(↓)";
+                                break;
+                            case SpinType::NONE:
+                                std::cout << "(—)";
+                                break;
+                        }
+                    }
+                    std::cout << "\n" << std::flush;
+                }
+            }
+            
+            completed_configs = total_configurations;
+            
+            std::cout << "\r" << std::string(80, ' ') << "\r";  // Clear progress line
+            std::cout << "GPU search completed: " << total_configurations << "/" << total_configurations 
+                      << " configurations processed\n\n";
+            
+        } catch (const std::exception& e) {
+            std::cout << "GPU search failed: " << e.what() << "\n";
+            std::cout << "Falling back to CPU search...\n";
+            use_cuda = false;
+            acceleration_method = "CPU (GPU fallback)";
+        }
+    }
+    
+    // Only run CPU search if GPU didn't complete the task
+    if (!use_cuda) {
+#endif
+    
+        // CPU multithreaded search (fallback or primary method)
+        // Workers only enqueue; formatting and printing happen on the sink's writer thread
+        auto format_found = [&structure, &options](std::ostream& out, const SpinConfiguration& config) {
+            out << "FOUND Config #" << std::setw(8) << config.configuration_id << ": ";
+            
+            // Show compact spin pattern
             for (size_t j = 0; j < config.spins.size(); ++j) {
-                if (j > 0) outfile << " ";
-                outfile << spin_to_string(config.spins[j]);
+                if (j > 0) out << " ";
+                out << spin_to_string(config.spins[j]);
             }
-            outfile << " | ";
+            
+            // Show detailed atomic assignment
+            out << " | ";
             for (size_t j = 0; j < structure.atoms.size(); ++j) {
-                if (j > 0) outfile << " ";
-                outfile << structure.atoms[j].chemical_symbol;
+                if (j > 0) out << " ";
+                out << structure.atoms[j].chemical_symbol;
                 
                 // Add spin arrow symbols
                 switch (config.spins[j]) {
                     case SpinType::UP:
-                        outfile << "(↑)";
+                        out << "(↑)";
                         break;
                     case SpinType::DOWN:
-                        outfile << "(↓)";
+                        out << "(↓)";
                         break;
                     case SpinType::NONE:
-                        outfile << "(—)";
+                        out << "(—)";
                         break;
                 }
             }
-            outfile << "\n";
+            if (!options.tolerances.empty()) {
+                out << " | ";
+                for (size_t k = 0; k < options.tolerances.size(); ++k) out << ((config.altermagnetic_at >> k) & 1);
+            }
+            out << "\n";
+        };
+        
+        std::unique_ptr<StatusFileWriter> status;
+        if (!options.status_file.empty()) {
+            status = std::make_unique<StatusFileWriter>(options.status_file, input_filename, options.status_interval_s);
+        }
+        
+        // The final snapshot says how much of the plan was covered before any time budget ran out
+        SearchProgress final_progress;
+        auto keep_final = [&final_progress](const SearchProgress& progress) {
+            if (progress.finished) final_progress = progress;
+        };
+        
+        if (options.quiet) {
+            // --quiet: the workers never touch the console; only the status file is updated
+            altermagnetic_configs = run_spin_search(
+                structure, magnetic_indices, tolerance, run_options, nullptr,
+                [&status, &keep_final](const SearchProgress& progress) {
+                    if (status) status->update(progress);
+                    keep_final(progress);
+                }, ternary.get(), constrained.get());
+        } else {
+            AsyncLogSink::Options sink_options;
+            sink_options.progress_total = total_configurations;
+            AsyncLogSink sink(std::cout, format_found, sink_options);
+            
+            altermagnetic_configs = run_spin_search(
+                structure, magnetic_indices, tolerance, run_options,
+                [&sink](const SpinConfiguration& config) { sink.post_hit(config); },
+                [&sink, &status, &keep_final](const SearchProgress& progress) {
+                    sink.update_progress(progress.completed, progress.found);
+                    if (status) status->update(progress);
+                    keep_final(progress);
+                }, ternary.get(), constrained.get());
+            
+            sink.finish();
+            if (sink.suppressed_hits() > 0) {
+                std::cout << sink.suppressed_hits() << " hits were not echoed to the console (rate limit)\n";
+            }
+        }
+        altermagnetic_count = altermagnetic_configs.size();
+        tested_configurations = final_progress.completed;
+        budget_exhausted = final_progress.budget_exhausted;
+        
+        std::cout << "\rProgress: " << std::fixed << std::setprecision(1)
+                  << (100.0 * tested_configurations / total_configurations) << "% (" << tested_configurations << "/" 
+                  << total_configurations << ") - Found: " 
+                  << altermagnetic_count << " altermagnetic configs\n";
+        if (budget_exhausted) {
+            std::cout << "Time budget of " << run_options.time_budget_s << " s exhausted after "
+                      << std::setprecision(1) << final_progress.elapsed_s << " s; keeping the partial result\n";
+        }
+        std::cout << "\n";
+    
+#ifdef HAVE_CUDA
+    } // End of CPU search conditional block
+#endif
+    
+    // Display results
+    std::cout << "=======================================================================\n";
+    std::cout << "                           SEARCH RESULTS\n";
+    std::cout << "=======================================================================\n";
+    std::cout << "Total configurations tested: " << tested_configurations << "\n";
+    std::cout << "Altermagnetic configurations found: " << altermagnetic_configs.size()
+              << (options.tolerances.empty() ? "" : " (at any swept tolerance)") << "\n";
+    if (!options.tolerances.empty()) {
+        print_tolerance_sweep(options.tolerances, altermagnetic_configs);
+    }
+    if (tested_configurations < full_space) {
+        print_coverage_estimate(tested_configurations, altermagnetic_configs.size(), full_space);
+    }
+    
+    if (altermagnetic_configs.empty()) {
+        if (tested_configurations < full_space) {
+            std::cout << "\nNo altermagnetic configurations found in the tested part of the space.\n";
+            std::cout << "This doesn't rule out altermagnetism - raise --time-budget or --max-configs.\n";
+        } else {
+            std::cout << "\nNo altermagnetic configurations found for this structure.\n";
         }
-        outfile.close();
-        std::cout << "\nSampled configurations saved to: " << output_filename << "\n";
+        std::cout << "=======================================================================\n";
+        return;
+    }
+    
+    // Sort by configuration ID for consistent output
+    std::sort(altermagnetic_configs.begin(), altermagnetic_configs.end(),
+              [](const SpinConfiguration& a, const SpinConfiguration& b) {
+                  return a.configuration_id < b.configuration_id;
+              });
+    
+    // Save all configurations to file
+    try {
+        write_search_results(output_filename, structure, altermagnetic_configs,
+                             tested_configurations, tolerance, acceleration_method, full_space,
+                             ternary.get(), options.tolerances);
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << "\n";
+        return;
     }
+    std::cout << "\nAll " << altermagnetic_configs.size() 
+              << " altermagnetic configurations saved to: " << output_filename << "\n";
     
-    // Display first few configurations
-    std::cout << "\nFirst " << std::min(static_cast<size_t>(20), altermagnetic_configs.size()) 
-              << " sampled altermagnetic configurations:\n";
+    std::cout << "\nFirst 50 altermagnetic configurations:\n";
     std::cout << "-----------------------------------------------------------------------\n";
     
-    for (size_t i = 0; i < std::min(static_cast<size_t>(20), altermagnetic_configs.size()); ++i) {
+    for (size_t i = 0; i < std::min(static_cast<size_t>(50), altermagnetic_configs.size()); ++i) {
         const auto& config = altermagnetic_configs[i];
         std::cout << "Config #" << std::setw(8) << config.configuration_id << ": ";
         
+        // Show compact spin pattern
         for (size_t j = 0; j < config.spins.size(); ++j) {
             if (j > 0) std::cout << " ";
             std::cout << spin_to_string(config.spins[j]);
         }
+        
+        // Show detailed atomic assignment
         std::cout << " | ";
         for (size_t j = 0; j < structure.atoms.size(); ++j) {
             if (j > 0) std::cout << " ";
@@ -1252,16 +1474,54 @@ void perform_smart_sampling_search(
         std::cout << "\n";
     }
     
-    if (altermagnetic_configs.size() > 20) {
-        std::cout << "... and " << (altermagnetic_configs.size() - 20) 
-                  << " more configurations (see " << output_filename << ").\n";
+    if (altermagnetic_configs.size() > 50) {
+        std::cout << "... and " << (altermagnetic_configs.size() - 50) 
+                  << " more configurations (see " << output_filename << " for complete list).\n";
     }
+        
+        if (verbose && altermagnetic_configs.size() <= 10) {
+            std::cout << "\nDetailed analysis of altermagnetic configurations:\n";
+            std::cout << "-----------------------------------------------------------------------\n";
+            
+            for (const auto& config : altermagnetic_configs) {
+                std::cout << "\nConfiguration #" << config.configuration_id << ":\n";
+                
+                // Show atomic details with positions and spin arrows
+                for (size_t j = 0; j < structure.atoms.size(); ++j) {
+                    Vector3d pos = structure.get_scaled_position(j);
+                    std::cout << "  Atom " << std::setw(2) << (j+1) << ": " 
+                              << std::setw(2) << structure.atoms[j].chemical_symbol 
+                              << " at (" << std::fixed << std::setprecision(6)
+                              << std::setw(9) << pos[0] << ", " 
+                              << std::setw(9) << pos[1] << ", " 
+                              << std::setw(9) << pos[2] << ") ";
+                    
+                    // Add spin arrow symbols
+                    switch (config.spins[j]) {
+                        case SpinType::UP:
+                            std::cout << "(↑)";
+                            break;
+                        case SpinType::DOWN:
+                            std::cout << "(↓)";
+                            break;
+                        case SpinType::NONE:
+                            std::cout << "(—)";
+                            break;
+                    }
+                    std::cout << "\n";
+                }
+            }
+        }
+    
+    std::cout << "\nSummary:\n";
+    std::cout << "-----------------------------------------------------------------------\n";
+    std::cout << "- Acceleration method: " << acceleration_method << "\n";
+    std::cout << "- Total configurations tested: " << tested_configurations << "\n";
+    std::cout << "- Altermagnetic configurations found: " << altermagnetic_configs.size() << "\n";
+    std::cout << "- Success rate: " << std::fixed << std::setprecision(2) 
+              << (100.0 * altermagnetic_configs.size() / std::max<size_t>(1, tested_configurations)) << "%\n";
+    std::cout << "- Results saved to: " << output_filename << "\n";
     
-    std::cout << "\nSUMMARY:\n";
-    std::cout << "- This sampling found " << altermagnetic_configs.size() 
-              << " altermagnetic configurations\n";
-    std::cout << "- Success rate suggests structure has altermagnetic potential\n";
-    std::cout << "- For complete analysis, consider smaller representative supercell\n";
     std::cout << "=======================================================================\n";
 }
 
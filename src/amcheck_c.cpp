@@ -0,0 +1,444 @@
+#include "amcheck_c.h"
+#include "amcheck.h"
+#include "altermagnet_checker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace amcheck;
+
+struct amcheck_structure {
+    CrystalStructure structure;
+    bool symmetry_ready = false;
+    double symprec = DEFAULT_TOLERANCE;
+
+    // Table checker for the last tolerance used by amcheck_check(); built on first use
+    std::mutex checker_mutex;
+    std::shared_ptr<const AltermagnetChecker> checker;
+    double checker_tolerance = 0.0;
+};
+
+namespace {
+
+thread_local std::string last_error;
+
+// Runs body and maps the exception categories used throughout amcheck to status codes
+template <typename Body>
+amcheck_status guarded(Body&& body) {
+    try {
+        last_error.clear();
+        body();
+        return AMCHECK_OK;
+    } catch (const std::invalid_argument& e) {
+        last_error = e.what();
+        return AMCHECK_ERROR_INVALID_ARGUMENT;
+    } catch (const std::out_of_range& e) {
+        last_error = e.what();
+        return AMCHECK_ERROR_INVALID_ARGUMENT;
+    } catch (const std::bad_alloc&) {
+        last_error = "Out of memory";
+        return AMCHECK_ERROR_INTERNAL;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return AMCHECK_ERROR_INTERNAL;
+    } catch (...) {
+        last_error = "Unknown error";
+        return AMCHECK_ERROR_INTERNAL;
+    }
+}
+
+void require(const void* pointer, const char* name) {
+    if (!pointer) throw std::invalid_argument(std::string(name) + " must not be null");
+}
+
+// Same grouping as the POSCAR reader until symmetry is analyzed: one orbit per element
+void group_by_element(CrystalStructure& structure) {
+    std::map<std::string, int> labels;
+    structure.equivalent_atoms.resize(structure.atoms.size());
+    for (size_t i = 0; i < structure.atoms.size(); ++i) {
+        const auto inserted = labels.emplace(structure.atoms[i].chemical_symbol, static_cast<int>(labels.size()));
+        structure.equivalent_atoms[i] = inserted.first->second;
+    }
+}
+
+amcheck_status finish_structure(std::unique_ptr<amcheck_structure> handle, amcheck_structure** out) {
+    if (handle->structure.atoms.empty()) {
+        last_error = "Structure has no atoms";
+        return AMCHECK_ERROR_INVALID_ARGUMENT;
+    }
+    *out = handle.release();
+    return AMCHECK_OK;
+}
+
+// Checks and searches use the structure's symmetry; without an explicit analysis the check
+// tolerance doubles as symprec, as in the executable
+void ensure_symmetry(amcheck_structure* handle, double tolerance) {
+    if (!handle->symmetry_ready) {
+        analyze_symmetry(handle->structure, tolerance);
+        handle->symprec = tolerance;
+        handle->symmetry_ready = true;
+    }
+}
+
+std::shared_ptr<const AltermagnetChecker> checker_for(amcheck_structure* handle, double tolerance) {
+    std::lock_guard<std::mutex> lock(handle->checker_mutex);
+    ensure_symmetry(handle, tolerance);
+    if (!handle->checker || handle->checker_tolerance != tolerance) {
+        handle->checker = std::make_shared<const AltermagnetChecker>(handle->structure, tolerance);
+        handle->checker_tolerance = tolerance;
+    }
+    return handle->checker;
+}
+
+void read_spins(const int8_t* values, size_t num_atoms, std::vector<SpinType>& spins) {
+    spins.resize(num_atoms);
+    for (size_t i = 0; i < num_atoms; ++i) {
+        switch (values[i]) {
+            case 1: spins[i] = SpinType::UP; break;
+            case -1: spins[i] = SpinType::DOWN; break;
+            case 0: spins[i] = SpinType::NONE; break;
+            default:
+                throw std::invalid_argument("Spin of atom " + std::to_string(i) + " is " +
+                                            std::to_string(values[i]) + " (expected 1, -1 or 0)");
+        }
+    }
+}
+
+int8_t spin_value(SpinType spin) {
+    return spin == SpinType::UP ? 1 : spin == SpinType::DOWN ? -1 : 0;
+}
+
+amcheck_verdict to_verdict(CheckOutcome outcome) {
+    switch (outcome) {
+        case CheckOutcome::ALTERMAGNET: return AMCHECK_ALTERMAGNET;
+        case CheckOutcome::NOT_ALTERMAGNET: return AMCHECK_NOT_ALTERMAGNET;
+        case CheckOutcome::INVALID: return AMCHECK_INVALID;
+    }
+    return AMCHECK_INVALID;
+}
+
+std::vector<std::string> split_species(const char* list) {
+    std::vector<std::string> species;
+    if (!list) return species;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        if (!item.empty()) species.push_back(item);
+    }
+    return species;
+}
+
+// Fields beyond what an older caller's struct holds keep their defaults
+#define AMCHECK_HAS_FIELD(options, field) \
+    ((options)->struct_size >= offsetof(amcheck_search_options, field) + sizeof((options)->field))
+
+SearchOptions to_search_options(const amcheck_search_options* options) {
+    SearchOptions search;
+    search.quiet = true;
+    if (!options) return search;
+    if (options->struct_size < sizeof(size_t)) {
+        throw std::invalid_argument("amcheck_search_options.struct_size is not set "
+                                    "(use amcheck_search_options_init)");
+    }
+    if (AMCHECK_HAS_FIELD(options, num_threads)) search.num_threads = options->num_threads;
+    if (AMCHECK_HAS_FIELD(options, max_configurations)) {
+        search.max_configurations = static_cast<size_t>(options->max_configurations);
+    }
+    if (AMCHECK_HAS_FIELD(options, time_budget_s)) search.time_budget_s = options->time_budget_s;
+    if (AMCHECK_HAS_FIELD(options, spread_order)) search.spread_order = options->spread_order != 0;
+    if (AMCHECK_HAS_FIELD(options, engine)) {
+        if (options->engine != AMCHECK_ENGINE_TABLE && options->engine != AMCHECK_ENGINE_REFERENCE) {
+            throw std::invalid_argument("Unknown engine " + std::to_string(options->engine));
+        }
+        search.engine = options->engine == AMCHECK_ENGINE_REFERENCE ? SearchEngine::REFERENCE : SearchEngine::TABLE;
+    }
+    if (AMCHECK_HAS_FIELD(options, magnetic)) search.magnetic.species = split_species(options->magnetic);
+    if (AMCHECK_HAS_FIELD(options, constraints) && options->constraints) search.constraints = options->constraints;
+    if (AMCHECK_HAS_FIELD(options, ternary)) search.ternary = options->ternary != 0;
+    if (AMCHECK_HAS_FIELD(options, symmetry_dedup)) search.symmetry_dedup = options->symmetry_dedup != 0;
+    if (AMCHECK_HAS_FIELD(options, progress_interval_s) && options->progress_interval_s > 0.0) {
+        search.progress_interval_s = options->progress_interval_s;
+    }
+    return search;
+}
+
+} // namespace
+
+extern "C" {
+
+const char* amcheck_version(void) {
+    return "1.0.0";
+}
+
+int amcheck_api_version(void) {
+    return AMCHECK_C_API_VERSION;
+}
+
+const char* amcheck_last_error(void) {
+    return last_error.c_str();
+}
+
+amcheck_status amcheck_structure_create(
+    const double lattice[9],
+    const double* fractional_positions,
+    const char* const* symbols,
+    size_t num_atoms,
+    amcheck_structure** out
+) {
+    std::unique_ptr<amcheck_structure> handle;
+    const amcheck_status status = guarded([&] {
+        require(lattice, "lattice");
+        require(fractional_positions, "fractional_positions");
+        require(symbols, "symbols");
+        require(out, "out");
+
+        handle = std::make_unique<amcheck_structure>();
+        CrystalStructure& structure = handle->structure;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) structure.cell(i, j) = lattice[3 * i + j];
+        }
+        if (std::abs(structure.cell.determinant()) < 1e-12) {
+            throw std::invalid_argument("Lattice vectors are linearly dependent");
+        }
+        for (size_t i = 0; i < num_atoms; ++i) {
+            require(symbols[i], "symbols[i]");
+            const std::string symbol = symbols[i];
+            const int number = structure.get_atomic_number(symbol);
+            if (number == 1 && symbol != "H") {
+                throw std::invalid_argument("Unknown element '" + symbol + "' for atom " + std::to_string(i));
+            }
+            const double* p = fractional_positions + 3 * i;
+            structure.atoms.emplace_back(Vector3d(p[0], p[1], p[2]), symbol, number);
+        }
+        group_by_element(structure);
+    });
+    return status == AMCHECK_OK ? finish_structure(std::move(handle), out) : status;
+}
+
+amcheck_status amcheck_structure_read(const char* filename, amcheck_structure** out) {
+    if (filename && out) {
+        std::ifstream in(filename);
+        if (!in.is_open()) {
+            last_error = std::string("Cannot open file: ") + filename;
+            return AMCHECK_ERROR_IO;
+        }
+    }
+    std::unique_ptr<amcheck_structure> handle;
+    const amcheck_status status = guarded([&] {
+        require(filename, "filename");
+        require(out, "out");
+        handle = std::make_unique<amcheck_structure>();
+        handle->structure.read_from_file(filename);
+    });
+    return status == AMCHECK_OK ? finish_structure(std::move(handle), out) : status;
+}
+
+amcheck_status amcheck_structure_parse(const char* poscar_text, amcheck_structure** out) {
+    std::unique_ptr<amcheck_structure> handle;
+    const amcheck_status status = guarded([&] {
+        require(poscar_text, "poscar_text");
+        require(out, "out");
+        handle = std::make_unique<amcheck_structure>();
+        std::istringstream in(poscar_text);
+        handle->structure.read_from_stream(in);
+    });
+    return status == AMCHECK_OK ? finish_structure(std::move(handle), out) : status;
+}
+
+void amcheck_structure_free(amcheck_structure* structure) {
+    delete structure;
+}
+
+size_t amcheck_structure_num_atoms(const amcheck_structure* structure) {
+    return structure ? structure->structure.atoms.size() : 0;
+}
+
+amcheck_status amcheck_analyze_symmetry(amcheck_structure* structure, double symprec) {
+    return guarded([&] {
+        require(structure, "structure");
+        if (!(symprec > 0.0)) throw std::invalid_argument("symprec must be positive");
+        std::lock_guard<std::mutex> lock(structure->checker_mutex);
+        analyze_symmetry(structure->structure, symprec);
+        structure->symprec = symprec;
+        structure->symmetry_ready = true;
+        structure->checker.reset();
+    });
+}
+
+size_t amcheck_structure_num_operations(const amcheck_structure* structure) {
+    return structure ? structure->structure.symmetry_operations.size() : 0;
+}
+
+amcheck_status amcheck_structure_operations(
+    const amcheck_structure* structure, double* rotations, double* translations
+) {
+    return guarded([&] {
+        require(structure, "structure");
+        const auto& operations = structure->structure.symmetry_operations;
+        for (size_t k = 0; k < operations.size(); ++k) {
+            for (int i = 0; i < 3; ++i) {
+                if (translations) translations[3 * k + i] = operations[k].second[i];
+                for (int j = 0; j < 3; ++j) {
+                    if (rotations) rotations[9 * k + 3 * i + j] = operations[k].first(i, j);
+                }
+            }
+        }
+    });
+}
+
+amcheck_status amcheck_structure_equivalent_atoms(const amcheck_structure* structure, int* labels) {
+    return guarded([&] {
+        require(structure, "structure");
+        require(labels, "labels");
+        std::copy(structure->structure.equivalent_atoms.begin(), structure->structure.equivalent_atoms.end(), labels);
+    });
+}
+
+amcheck_status amcheck_structure_spacegroup(const amcheck_structure* structure, char* buffer, size_t buffer_size) {
+#ifdef HAVE_SPGLIB
+    return guarded([&] {
+        require(structure, "structure");
+        require(buffer, "buffer");
+        if (buffer_size == 0) throw std::invalid_argument("buffer_size must be positive");
+        const std::string name = get_spacegroup_name(structure->structure, structure->symprec);
+        const size_t length = std::min(name.size(), buffer_size - 1);
+        std::memcpy(buffer, name.data(), length);
+        buffer[length] = '\0';
+    });
+#else
+    (void)structure;
+    (void)buffer;
+    (void)buffer_size;
+    last_error = "Space group names require spglib, which this build does not include";
+    return AMCHECK_ERROR_UNSUPPORTED;
+#endif
+}
+
+amcheck_status amcheck_structure_magnetic_sites(
+    const amcheck_structure* structure, const char* magnetic,
+    size_t* indices, size_t capacity, size_t* count
+) {
+    return guarded([&] {
+        require(structure, "structure");
+        require(count, "count");
+        MagneticSelection selection;
+        selection.species = split_species(magnetic);
+        const std::vector<size_t> sites = get_magnetic_atom_indices(structure->structure, selection);
+        *count = sites.size();
+        if (indices) std::copy_n(sites.begin(), std::min(capacity, sites.size()), indices);
+    });
+}
+
+amcheck_status amcheck_check(
+    amcheck_structure* structure, const int8_t* spins, double tolerance, amcheck_verdict* verdict
+) {
+    return guarded([&] {
+        require(structure, "structure");
+        require(spins, "spins");
+        require(verdict, "verdict");
+        const auto checker = checker_for(structure, tolerance);
+        std::vector<SpinType> pattern;
+        read_spins(spins, structure->structure.atoms.size(), pattern);
+        *verdict = to_verdict(checker->evaluate(pattern));
+    });
+}
+
+amcheck_status amcheck_check_batch(
+    amcheck_structure* structure, const int8_t* spins, size_t count, double tolerance,
+    unsigned int num_threads, amcheck_verdict* verdicts
+) {
+    return guarded([&] {
+        require(structure, "structure");
+        require(spins, "spins");
+        require(verdicts, "verdicts");
+        const auto checker = checker_for(structure, tolerance);
+        const size_t num_atoms = structure->structure.atoms.size();
+
+        // Decode everything first so a malformed pattern fails the call before any work starts
+        std::vector<std::vector<SpinType>> patterns(count);
+        for (size_t k = 0; k < count; ++k) read_spins(spins + k * num_atoms, num_atoms, patterns[k]);
+
+        auto worker = [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) verdicts[k] = to_verdict(checker->evaluate(patterns[k]));
+        };
+        const size_t workers = std::max<size_t>(1, std::min<size_t>(resolve_thread_count(num_threads), count / 256));
+        const size_t chunk = (count + workers - 1) / workers;
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < workers; ++t) {
+            threads.emplace_back(worker, std::min(count, t * chunk), std::min(count, (t + 1) * chunk));
+        }
+        worker(0, std::min(count, chunk));
+        for (auto& thread : threads) thread.join();
+    });
+}
+
+void amcheck_search_options_init(amcheck_search_options* options) {
+    if (!options) return;
+    std::memset(options, 0, sizeof(*options));
+    const SearchOptions defaults;
+    options->struct_size = sizeof(*options);
+    options->engine = AMCHECK_ENGINE_TABLE;
+    options->symmetry_dedup = defaults.symmetry_dedup ? 1 : 0;
+    options->progress_interval_s = defaults.progress_interval_s;
+}
+
+amcheck_status amcheck_search(
+    amcheck_structure* structure, double tolerance, const amcheck_search_options* options,
+    amcheck_found_callback on_found, amcheck_progress_callback on_progress, void* user_data,
+    amcheck_search_result* result
+) {
+    return guarded([&] {
+        require(structure, "structure");
+        const SearchOptions search = to_search_options(options);
+        {
+            std::lock_guard<std::mutex> lock(structure->checker_mutex);
+            ensure_symmetry(structure, tolerance);
+        }
+        const CrystalStructure& crystal = structure->structure;
+        const std::vector<size_t> magnetic_indices = get_magnetic_atom_indices(crystal, search.magnetic);
+        if (magnetic_indices.empty()) {
+            throw std::invalid_argument("Structure has no magnetic sites for " +
+                                        describe_magnetic_selection(search.magnetic));
+        }
+
+        // Callers get one callback at a time, whatever the number of workers
+        std::mutex found_mutex;
+        FoundCallback found;
+        if (on_found) {
+            found = [&](const SpinConfiguration& config) {
+                std::vector<int8_t> values(config.spins.size());
+                std::transform(config.spins.begin(), config.spins.end(), values.begin(), spin_value);
+                std::lock_guard<std::mutex> lock(found_mutex);
+                on_found(static_cast<uint64_t>(config.configuration_id), values.data(), values.size(), user_data);
+            };
+        }
+
+        SearchProgress last;
+        auto progress = [&](const SearchProgress& snapshot) {
+            if (snapshot.finished) last = snapshot;
+            if (on_progress) on_progress(snapshot.completed, snapshot.total, snapshot.found, user_data);
+        };
+
+        run_spin_search(crystal, magnetic_indices, tolerance, search, found, progress);
+
+        if (result) {
+            result->total = last.total;
+            result->completed = last.completed;
+            result->found = last.found;
+            result->elapsed_s = last.elapsed_s;
+            result->budget_exhausted = last.budget_exhausted ? 1 : 0;
+        }
+    });
+}
+
+} // extern "C"
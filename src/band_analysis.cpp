@@ -335,7 +335,7 @@ void print_detailed_band_analysis(const BandAnalysisResult& result) {
 std::map<double, std::string> get_high_symmetry_kpoints(
         int spacegroup,
         const std::string& lattice_system,
-        const std::vector<std::array<double, 3>>& reciprocal_vectors = {}) {
+        const std::vector<std::array<double, 3>>& reciprocal_vectors) {
     
     std::map<double, std::string> kpoints;
     
@@ -407,7 +407,7 @@ std::map<double, std::string> get_high_symmetry_kpoints(
 void generate_band_plot_script(const BandAnalysisResult& result, const std::string& input_filename,
                        const std::pair<double, double>& x_range, 
                        const std::pair<double, double>& y_range,
-                       const std::map<double, std::string>& kpoint_labels = {}) {
+                       const std::map<double, std::string>& kpoint_labels) {
     // Create output filename based on input
     std::string base_filename = input_filename;
     size_t last_dot = base_filename.find_last_of(".");
@@ -0,0 +1,188 @@
+#include "amcheck.h"
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef __linux__
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+namespace amcheck {
+
+namespace {
+
+#ifdef __linux__
+bool read_first_line(const std::string& path, std::string& line) {
+    std::ifstream in(path);
+    return in.is_open() && static_cast<bool>(std::getline(in, line));
+}
+
+// Controller paths of the calling process from /proc/self/cgroup: v2 uses "0::<path>",
+// v1 lists the controllers, e.g. "4:cpu,cpuacct:<path>"
+std::string cgroup_path(const std::string& controller) {
+    std::ifstream in("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t first = line.find(':');
+        const size_t second = line.find(':', first + 1);
+        if (first == std::string::npos || second == std::string::npos) continue;
+
+        const std::string controllers = line.substr(first + 1, second - first - 1);
+        const std::string path = line.substr(second + 1);
+        if (controller.empty() && controllers.empty()) return path;
+
+        std::stringstream ss(controllers);
+        std::string name;
+        while (std::getline(ss, name, ',')) {
+            if (!controller.empty() && name == controller) return path;
+        }
+    }
+    return "";
+}
+
+// Strips trailing path components until a readable file is found. Inside a container the
+// cgroup namespace usually mounts the job's own group at the root, so the recorded path
+// does not exist and the root file applies.
+template <typename Reader>
+double search_cgroup_hierarchy(const std::string& mount, std::string path, Reader reader) {
+    while (true) {
+        double quota = 0.0;
+        if (reader(mount + path, quota)) return quota;
+        if (path.empty() || path == "/") return 0.0;
+        const size_t slash = path.find_last_of('/');
+        path = slash == std::string::npos || slash == 0 ? "" : path.substr(0, slash);
+    }
+}
+
+// cgroup v2: cpu.max holds "<quota> <period>" or "max <period>"
+bool read_cpu_max(const std::string& dir, double& cpus) {
+    std::string line;
+    if (!read_first_line(dir + "/cpu.max", line)) return false;
+    std::istringstream in(line);
+    std::string quota;
+    double period = 0.0;
+    in >> quota >> period;
+    cpus = (quota == "max" || period <= 0.0) ? 0.0 : std::stod(quota) / period;
+    return true;
+}
+
+// cgroup v1: cpu.cfs_quota_us is -1 when unlimited
+bool read_cfs_quota(const std::string& dir, double& cpus) {
+    std::string quota_line, period_line;
+    if (!read_first_line(dir + "/cpu.cfs_quota_us", quota_line) ||
+        !read_first_line(dir + "/cpu.cfs_period_us", period_line)) {
+        return false;
+    }
+    const double quota = std::stod(quota_line);
+    const double period = std::stod(period_line);
+    cpus = (quota <= 0.0 || period <= 0.0) ? 0.0 : quota / period;
+    return true;
+}
+
+double detect_cgroup_quota() {
+    try {
+        // Unified hierarchy first, then the v1 cpu controller under its usual mount points
+        const std::string v2_path = cgroup_path("");
+        double cpus = search_cgroup_hierarchy("/sys/fs/cgroup", v2_path, read_cpu_max);
+        if (cpus > 0.0) return cpus;
+
+        const std::string v1_path = cgroup_path("cpu");
+        for (const char* mount : {"/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct", "/sys/fs/cgroup/cpuacct,cpu"}) {
+            cpus = search_cgroup_hierarchy(mount, v1_path, read_cfs_quota);
+            if (cpus > 0.0) return cpus;
+        }
+    } catch (const std::exception&) {
+        // Malformed cgroup files: behave as if there were no quota
+    }
+    return 0.0;
+}
+
+std::vector<int> affinity_cpus() {
+    std::vector<int> cpus;
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &mask)) cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+#endif
+
+} // namespace
+
+CpuBudget detect_cpu_budget() {
+    CpuBudget budget;
+    // hardware_concurrency() may report 0 when the value is not computable
+    budget.hardware = std::max(1u, std::thread::hardware_concurrency());
+    budget.available = budget.hardware;
+
+#ifdef __linux__
+    budget.affinity = static_cast<unsigned int>(affinity_cpus().size());
+    if (budget.affinity > 0) {
+        budget.available = std::min(budget.available, budget.affinity);
+    }
+
+    budget.cgroup_quota = detect_cgroup_quota();
+    if (budget.cgroup_quota > 0.0) {
+        // A quota of 1.5 CPUs still lets two threads make progress
+        const unsigned int quota_threads = static_cast<unsigned int>(std::ceil(budget.cgroup_quota - 1e-9));
+        budget.available = std::min(budget.available, std::max(1u, quota_threads));
+    }
+#endif
+
+    const char* env = std::getenv("AMCHECK_NUM_THREADS");
+    if (env != nullptr && *env != '\0') {
+        try {
+            const long requested = std::stol(env);
+            if (requested > 0) {
+                budget.environment = static_cast<unsigned int>(requested);
+            }
+        } catch (const std::exception&) {
+        }
+        if (budget.environment == 0) {
+            std::cerr << "WARNING: Ignoring invalid AMCHECK_NUM_THREADS=" << env << "\n";
+        }
+    }
+
+    return budget;
+}
+
+std::string describe_cpu_budget(const CpuBudget& budget) {
+    std::ostringstream out;
+    out << "hardware " << budget.hardware;
+    if (budget.affinity > 0) out << ", affinity " << budget.affinity;
+    if (budget.cgroup_quota > 0.0) out << ", cgroup quota " << budget.cgroup_quota;
+    if (budget.environment > 0) out << ", AMCHECK_NUM_THREADS " << budget.environment;
+    return out.str();
+}
+
+unsigned int resolve_thread_count(unsigned int requested) {
+    if (requested > 0) {
+        return requested;
+    }
+    const CpuBudget budget = detect_cpu_budget();
+    return budget.environment > 0 ? budget.environment : budget.available;
+}
+
+bool pin_current_thread(size_t worker_index) {
+#ifdef __linux__
+    // Round-robin over the CPUs this process may use, so pinning respects taskset/cpusets
+    const std::vector<int> cpus = affinity_cpus();
+    if (cpus.empty()) return false;
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpus[worker_index % cpus.size()], &mask);
+    return pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+#else
+    (void)worker_index;
+    return false;
+#endif
+}
+
+} // namespace amcheck
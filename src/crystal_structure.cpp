@@ -58,6 +58,10 @@ void CrystalStructure::read_from_file(const std::string& filename) {
         throw std::runtime_error("Cannot open file: " + filename);
     }
 
+    read_from_stream(file);
+}
+
+void CrystalStructure::read_from_stream(std::istream& file) {
     std::string line;
     
     // Read comment line
@@ -66,6 +70,9 @@ void CrystalStructure::read_from_file(const std::string& filename) {
     // Read scaling factor
     double scale;
     file >> scale;
+    if (!file) {
+        throw std::invalid_argument("POSCAR: cannot read the scaling factor");
+    }
     
     // Read lattice vectors
     for (int i = 0; i < 3; ++i) {
@@ -73,6 +80,9 @@ void CrystalStructure::read_from_file(const std::string& filename) {
             file >> cell(i, j);
         }
     }
+    if (!file) {
+        throw std::invalid_argument("POSCAR: cannot read the lattice vectors");
+    }
     cell *= scale;
     
     // Read element names
@@ -84,6 +94,9 @@ void CrystalStructure::read_from_file(const std::string& filename) {
     while (element_stream >> element) {
         elements.push_back(element);
     }
+    if (!file || elements.empty()) {
+        throw std::invalid_argument("POSCAR: missing element names");
+    }
     
     // Read element counts
     std::getline(file, line);
@@ -91,11 +104,20 @@ void CrystalStructure::read_from_file(const std::string& filename) {
     std::vector<int> counts;
     int count;
     while (count_stream >> count) {
+        if (count < 0) {
+            throw std::invalid_argument("POSCAR: negative atom count");
+        }
         counts.push_back(count);
     }
+    if (!file || counts.size() != elements.size()) {
+        throw std::invalid_argument("POSCAR: expected " + std::to_string(elements.size()) +
+                                    " atom counts, found " + std::to_string(counts.size()));
+    }
     
     // Read coordinate type
-    std::getline(file, line);
+    if (!std::getline(file, line) || line.empty()) {
+        throw std::invalid_argument("POSCAR: missing coordinate type line");
+    }
     bool direct = (line[0] == 'D' || line[0] == 'd');
     
     // Read atomic positions
@@ -104,6 +126,10 @@ void CrystalStructure::read_from_file(const std::string& filename) {
         for (int j = 0; j < counts[i]; ++j) {
             Vector3d pos;
             file >> pos[0] >> pos[1] >> pos[2];
+            if (!file) {
+                throw std::invalid_argument("POSCAR: cannot read position of atom " +
+                                            std::to_string(atoms.size() + 1));
+            }
             
             // Skip any extra text on the line (like element labels)
             std::getline(file, line);
@@ -134,6 +160,49 @@ void CrystalStructure::read_from_file(const std::string& filename) {
     }
 }
 
+CrystalStructure make_supercell(const CrystalStructure& structure, int na, int nb, int nc) {
+    if (na < 1 || nb < 1 || nc < 1) {
+        throw std::invalid_argument("Supercell multipliers must be positive");
+    }
+
+    CrystalStructure supercell;
+    supercell.cell = structure.cell;
+    supercell.cell.row(0) *= na;
+    supercell.cell.row(1) *= nb;
+    supercell.cell.row(2) *= nc;
+
+    const Vector3d scale(na, nb, nc);
+    
+    // Keep atoms of one original site contiguous so per-element blocks stay intact
+    for (size_t i = 0; i < structure.atoms.size(); ++i) {
+        const Atom& atom = structure.atoms[i];
+        for (int a = 0; a < na; ++a) {
+            for (int b = 0; b < nb; ++b) {
+                for (int c = 0; c < nc; ++c) {
+                    Vector3d pos = (atom.position + Vector3d(a, b, c)).cwiseQuotient(scale);
+                    supercell.atoms.emplace_back(pos, atom.chemical_symbol, atom.atomic_number, atom.spin);
+                    supercell.atoms.back().magnetic_moment = atom.magnetic_moment;
+                    if (i < structure.equivalent_atoms.size()) {
+                        supercell.equivalent_atoms.push_back(structure.equivalent_atoms[i]);
+                    }
+                }
+            }
+        }
+    }
+    
+    // Orbit ids must point at a member atom, as spglib's equivalent_atoms does
+    if (supercell.equivalent_atoms.size() == supercell.atoms.size()) {
+        const int images = na * nb * nc;
+        for (int& orbit : supercell.equivalent_atoms) {
+            orbit *= images;
+        }
+    } else {
+        supercell.equivalent_atoms.clear();
+    }
+
+    return supercell;
+}
+
 void CrystalStructure::write_vasp_file(const std::string& filename) const {
     std::ofstream file(filename);
     if (!file.is_open()) {
@@ -0,0 +1,325 @@
+#include "distortion_sweep.h"
+#include "site_symmetry.h"
+#include "worker_pool.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace amcheck {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+std::string strip_comment(const std::string& line) {
+    const size_t hash = line.find('#');
+    return hash == std::string::npos ? line : line.substr(0, hash);
+}
+
+double parse_number(const std::string& item, const std::string& what) {
+    size_t used = 0;
+    double value = 0.0;
+    try {
+        value = std::stod(item, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used != item.size()) {
+        throw std::invalid_argument(what + ": not a number: " + item);
+    }
+    return value;
+}
+
+// Rigid rotation of the atoms around every center; atoms shared by several centers move by the
+// average of their displacements, which for corner-sharing polyhedra tilting in alternating
+// senses is the displacement of either one
+std::vector<Vector3d> tilt_displacements(const CrystalStructure& parent, const DistortionMode& mode, double amplitude) {
+    const size_t n = parent.atoms.size();
+    const Matrix3d to_cartesian = parent.cell.transpose();
+    std::vector<Vector3d> sum(n, Vector3d::Zero());
+    std::vector<int> count(n, 0);
+    const Vector3d axis = mode.axis.normalized();
+
+    for (size_t c = 0; c < n; ++c) {
+        if (parent.atoms[c].chemical_symbol != mode.center) continue;
+        const Vector3d& xc = parent.atoms[c].position;
+        const double sense = std::cos(2.0 * PI * mode.wavevector.dot(xc));
+        const Matrix3d rotation = Eigen::AngleAxisd(sense * amplitude * PI / 180.0, axis).toRotationMatrix();
+
+        for (size_t l = 0; l < n; ++l) {
+            if (parent.atoms[l].chemical_symbol == mode.center) continue;
+            // Nearest periodic image of the neighbour
+            Vector3d best = Vector3d::Zero();
+            double best_distance = mode.cutoff;
+            bool found = false;
+            for (int i = -1; i <= 1; ++i) {
+                for (int j = -1; j <= 1; ++j) {
+                    for (int k = -1; k <= 1; ++k) {
+                        const Vector3d d = to_cartesian * (parent.atoms[l].position + Vector3d(i, j, k) - xc);
+                        if (d.norm() < best_distance) {
+                            best = d;
+                            best_distance = d.norm();
+                            found = true;
+                        }
+                    }
+                }
+            }
+            if (!found) continue;
+            sum[l] += rotation * best - best;
+            ++count[l];
+        }
+    }
+
+    for (size_t l = 0; l < n; ++l) {
+        if (count[l] > 0) sum[l] /= count[l];
+    }
+    return sum;
+}
+
+} // namespace
+
+std::string distortion_kind_to_string(DistortionKind kind) {
+    switch (kind) {
+        case DistortionKind::DISPLACEMENT: return "displacement";
+        case DistortionKind::STRAIN: return "strain";
+        case DistortionKind::TILT: return "tilt";
+    }
+    return "displacement";
+}
+
+std::vector<DistortionMode> read_distortion_modes(const std::string& filename, size_t num_atoms) {
+    std::ifstream in(filename);
+    if (!in) {
+        throw std::runtime_error("Cannot open distortion modes file: " + filename);
+    }
+
+    std::vector<DistortionMode> modes;
+    std::set<std::string> names;
+    std::string line;
+    size_t line_number = 0;
+    auto fail = [&](const std::string& message) {
+        throw std::runtime_error(filename + ":" + std::to_string(line_number) + ": " + message);
+    };
+    auto numbers = [&](std::istringstream& tokens, size_t count) {
+        std::vector<double> values;
+        std::string item;
+        while (values.size() < count && tokens >> item) {
+            try {
+                values.push_back(parse_number(item, "value"));
+            } catch (const std::invalid_argument& e) {
+                fail(e.what());
+            }
+        }
+        if (values.size() != count) fail("expected " + std::to_string(count) + " numbers");
+        return values;
+    };
+
+    while (std::getline(in, line)) {
+        ++line_number;
+        std::istringstream tokens(strip_comment(line));
+        std::string keyword;
+        if (!(tokens >> keyword)) continue;
+        if (keyword != "mode") fail("expected 'mode <name> <kind> ...', got '" + keyword + "'");
+
+        DistortionMode mode;
+        std::string kind;
+        if (!(tokens >> mode.name >> kind)) fail("expected 'mode <name> <kind> ...'");
+        if (!names.insert(mode.name).second) fail("duplicate mode name '" + mode.name + "'");
+
+        if (kind == "displacement") {
+            mode.kind = DistortionKind::DISPLACEMENT;
+            while (mode.displacements.size() < num_atoms && std::getline(in, line)) {
+                ++line_number;
+                const std::string content = strip_comment(line);
+                if (content.find_first_not_of(" \t\r") == std::string::npos) continue;
+                std::istringstream row(content);
+                const std::vector<double> d = numbers(row, 3);
+                mode.displacements.emplace_back(d[0], d[1], d[2]);
+            }
+            if (mode.displacements.size() != num_atoms) {
+                fail("mode '" + mode.name + "' needs one displacement per atom (" + std::to_string(num_atoms) + ")");
+            }
+        } else if (kind == "strain") {
+            mode.kind = DistortionKind::STRAIN;
+            const std::vector<double> e = numbers(tokens, 6);
+            mode.strain << e[0], e[5], e[4],
+                           e[5], e[1], e[3],
+                           e[4], e[3], e[2];
+        } else if (kind == "tilt") {
+            mode.kind = DistortionKind::TILT;
+            if (!(tokens >> mode.center)) fail("tilt needs a center element");
+            const std::vector<double> a = numbers(tokens, 4);
+            mode.axis = Vector3d(a[0], a[1], a[2]);
+            mode.cutoff = a[3];
+            if (mode.axis.norm() == 0.0 || mode.cutoff <= 0.0) fail("tilt needs a nonzero axis and a positive cutoff");
+            if (tokens >> std::ws && !tokens.eof()) {
+                const std::vector<double> q = numbers(tokens, 3);
+                mode.wavevector = Vector3d(q[0], q[1], q[2]);
+            }
+        } else {
+            fail("unknown mode kind '" + kind + "' (displacement, strain or tilt)");
+        }
+        modes.push_back(mode);
+    }
+
+    if (modes.empty()) {
+        throw std::runtime_error("No distortion modes in " + filename);
+    }
+    return modes;
+}
+
+std::vector<double> parse_amplitude_list(const std::string& text) {
+    std::vector<double> amplitudes;
+    const size_t colon = text.find(':');
+    if (colon != std::string::npos) {
+        const size_t second = text.find(':', colon + 1);
+        if (second == std::string::npos) {
+            throw std::invalid_argument("--amplitudes: expected start:stop:count, got " + text);
+        }
+        const double start = parse_number(text.substr(0, colon), "--amplitudes");
+        const double stop = parse_number(text.substr(colon + 1, second - colon - 1), "--amplitudes");
+        const double count = parse_number(text.substr(second + 1), "--amplitudes");
+        if (count < 1 || count != std::floor(count)) {
+            throw std::invalid_argument("--amplitudes: count must be a positive integer");
+        }
+        const size_t steps = static_cast<size_t>(count);
+        for (size_t i = 0; i < steps; ++i) {
+            amplitudes.push_back(steps == 1 ? start : start + (stop - start) * i / (steps - 1));
+        }
+    } else {
+        std::stringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) amplitudes.push_back(parse_number(item, "--amplitudes"));
+        }
+    }
+    if (amplitudes.empty()) {
+        throw std::invalid_argument("--amplitudes needs at least one value");
+    }
+    return amplitudes;
+}
+
+CrystalStructure apply_distortion(const CrystalStructure& parent, const DistortionMode& mode, double amplitude) {
+    CrystalStructure distorted;
+    distorted.cell = parent.cell;
+    distorted.atoms = parent.atoms;
+
+    if (mode.kind == DistortionKind::STRAIN) {
+        // Rows are the lattice vectors; fractional coordinates stay put
+        distorted.cell = parent.cell * (Matrix3d::Identity() + amplitude * mode.strain).transpose();
+        return distorted;
+    }
+
+    const std::vector<Vector3d> displacements = mode.kind == DistortionKind::TILT
+        ? tilt_displacements(parent, mode, amplitude) : mode.displacements;
+    const double scale = mode.kind == DistortionKind::TILT ? 1.0 : amplitude;
+    const Matrix3d to_fractional = parent.cell.transpose().inverse();
+    for (size_t i = 0; i < distorted.atoms.size(); ++i) {
+        distorted.atoms[i].position += to_fractional * (scale * displacements[i]);
+    }
+    return distorted;
+}
+
+std::vector<DistortionStep> run_distortion_sweep(
+    const CrystalStructure& parent,
+    const std::vector<DistortionMode>& modes,
+    const std::vector<double>& amplitudes,
+    const std::vector<SpinType>& spins,
+    double tolerance,
+    unsigned int num_threads
+) {
+    ScopedSpan span("distortion sweep");
+    if (spins.size() != parent.atoms.size()) {
+        throw std::invalid_argument("Spin pattern must have one entry per atom");
+    }
+
+    std::vector<DistortionStep> steps(modes.size() * amplitudes.size());
+    std::mutex error_mutex;
+    std::string error;
+    {
+        const size_t threads = std::max<size_t>(1, std::min<size_t>(num_threads, steps.size()));
+        WorkerPool pool(threads, 2 * threads);
+        for (size_t index = 0; index < steps.size(); ++index) {
+            pool.submit([&, index] {
+                DistortionStep& step = steps[index];
+                step.mode = index / amplitudes.size();
+                step.amplitude = amplitudes[index % amplitudes.size()];
+                try {
+                    CrystalStructure distorted = apply_distortion(parent, modes[step.mode], step.amplitude);
+                    step.operations = inherit_subgroup_symmetry(parent, distorted, tolerance);
+                    const AltermagnetChecker checker(distorted, tolerance);
+                    step.orbits = checker.num_orbits();
+                    step.outcome = checker.evaluate(spins);
+                } catch (const std::exception& e) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (error.empty()) error = modes[step.mode].name + ": " + e.what();
+                }
+            });
+        }
+    }
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+    return steps;
+}
+
+void print_distortion_sweep(
+    const CrystalStructure& parent,
+    const std::vector<DistortionMode>& modes,
+    const std::vector<double>& amplitudes,
+    const std::vector<DistortionStep>& steps,
+    std::ostream& out
+) {
+    out << "\nParent: " << parent.symmetry_operations.size() << " symmetry operations, "
+        << modes.size() << " mode(s) x " << amplitudes.size() << " amplitude(s)\n";
+
+    std::vector<std::string> switch_on;
+    for (size_t m = 0; m < modes.size(); ++m) {
+        out << "\nMode " << modes[m].name << " (" << distortion_kind_to_string(modes[m].kind) << ")\n";
+        out << "-----------------------------------------------------------------------\n";
+        out << "   Amplitude  Operations  Orbits  Verdict\n";
+        const DistortionStep* previous = nullptr;
+        std::vector<std::string> changes;
+        for (size_t a = 0; a < amplitudes.size(); ++a) {
+            const DistortionStep& step = steps[m * amplitudes.size() + a];
+            out << std::setw(12) << std::setprecision(6) << step.amplitude << "  " << std::setw(10) << step.operations
+                << "  " << std::setw(6) << step.orbits << "  " << outcome_to_string(step.outcome) << "\n";
+            if (previous != nullptr && previous->outcome != step.outcome) {
+                std::ostringstream change;
+                change << outcome_to_string(previous->outcome) << " -> " << outcome_to_string(step.outcome)
+                       << " between " << previous->amplitude << " and " << step.amplitude;
+                changes.push_back(change.str());
+                if (step.outcome == CheckOutcome::ALTERMAGNET) {
+                    std::ostringstream on;
+                    on << modes[m].name << " (from amplitude " << step.amplitude << ")";
+                    switch_on.push_back(on.str());
+                }
+            }
+            previous = &step;
+        }
+        out << "-----------------------------------------------------------------------\n";
+        if (changes.empty()) {
+            out << "Verdict unchanged over the sweep.\n";
+        }
+        for (const auto& change : changes) {
+            out << "Verdict changes: " << change << "\n";
+        }
+    }
+
+    out << "\n";
+    if (switch_on.empty()) {
+        out << "No mode switches altermagnetism on within the sampled amplitudes.\n";
+    } else {
+        out << "Modes that switch altermagnetism on:\n";
+        for (const auto& mode : switch_on) out << "  " << mode << "\n";
+    }
+}
+
+} // namespace amcheck
@@ -0,0 +1,263 @@
+#include "json_reader.h"
+#include "amcheck.h"
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+namespace amcheck {
+
+// Recursive-descent parser over one in-memory document
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text_(text) {}
+
+    JsonValue parse_document() {
+        JsonValue value = parse_value(0);
+        skip_whitespace();
+        if (pos_ != text_.size()) fail("unexpected trailing characters");
+        return value;
+    }
+
+private:
+    static constexpr int MAX_DEPTH = 64;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::invalid_argument("Invalid JSON at offset " + std::to_string(pos_) + ": " + message);
+    }
+
+    void skip_whitespace() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+                                       text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c) {
+        skip_whitespace();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) fail(std::string("expected '") + c + "'");
+    }
+
+    bool consume_word(const char* word) {
+        const std::string w(word);
+        if (text_.compare(pos_, w.size(), w) != 0) return false;
+        pos_ += w.size();
+        return true;
+    }
+
+    JsonValue parse_value(int depth) {
+        if (depth > MAX_DEPTH) fail("nesting too deep");
+        skip_whitespace();
+        if (pos_ >= text_.size()) fail("unexpected end of input");
+
+        JsonValue value;
+        const char c = text_[pos_];
+        if (c == '{') {
+            ++pos_;
+            value.type_ = JsonValue::Type::OBJECT;
+            if (consume('}')) return value;
+            do {
+                skip_whitespace();
+                if (pos_ >= text_.size() || text_[pos_] != '"') fail("expected a member name");
+                std::string key = parse_string();
+                expect(':');
+                value.object_[key] = parse_value(depth + 1);
+            } while (consume(','));
+            expect('}');
+        } else if (c == '[') {
+            ++pos_;
+            value.type_ = JsonValue::Type::ARRAY;
+            if (consume(']')) return value;
+            do {
+                value.array_.push_back(parse_value(depth + 1));
+            } while (consume(','));
+            expect(']');
+        } else if (c == '"') {
+            value.type_ = JsonValue::Type::STRING;
+            value.string_ = parse_string();
+        } else if (consume_word("true")) {
+            value.type_ = JsonValue::Type::BOOLEAN;
+            value.bool_ = true;
+        } else if (consume_word("false")) {
+            value.type_ = JsonValue::Type::BOOLEAN;
+        } else if (consume_word("null")) {
+            value.type_ = JsonValue::Type::NUL;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            const size_t start = pos_;
+            const char* begin = text_.c_str() + pos_;
+            char* end = nullptr;
+            value.number_ = std::strtod(begin, &end);
+            if (end == begin) fail("malformed number");
+            pos_ += static_cast<size_t>(end - begin);
+            value.type_ = JsonValue::Type::NUMBER;
+            value.string_ = text_.substr(start, pos_ - start);
+        } else {
+            fail(std::string("unexpected character '") + c + "'");
+        }
+        return value;
+    }
+
+    static void append_utf8(std::string& out, unsigned long code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    unsigned long parse_hex4() {
+        if (pos_ + 4 > text_.size()) fail("truncated \\u escape");
+        unsigned long code = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char h = text_[pos_++];
+            code <<= 4;
+            if (h >= '0' && h <= '9') code |= static_cast<unsigned long>(h - '0');
+            else if (h >= 'a' && h <= 'f') code |= static_cast<unsigned long>(h - 'a' + 10);
+            else if (h >= 'A' && h <= 'F') code |= static_cast<unsigned long>(h - 'A' + 10);
+            else fail("bad \\u escape");
+        }
+        return code;
+    }
+
+    std::string parse_string() {
+        ++pos_;  // opening quote
+        std::string out;
+        while (true) {
+            if (pos_ >= text_.size()) fail("unterminated string");
+            const char c = text_[pos_++];
+            if (c == '"') return out;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= text_.size()) fail("unterminated escape");
+            const char e = text_[pos_++];
+            switch (e) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned long code = parse_hex4();
+                    // Surrogate pair
+                    if (code >= 0xD800 && code < 0xDC00 && text_.compare(pos_, 2, "\\u") == 0) {
+                        pos_ += 2;
+                        const unsigned long low = parse_hex4();
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(out, code);
+                    break;
+                }
+                default: fail(std::string("bad escape '\\") + e + "'");
+            }
+        }
+    }
+
+    const std::string& text_;
+    size_t pos_ = 0;
+};
+
+namespace {
+
+const char* type_name(JsonValue::Type type) {
+    switch (type) {
+        case JsonValue::Type::NUL: return "null";
+        case JsonValue::Type::BOOLEAN: return "a boolean";
+        case JsonValue::Type::NUMBER: return "a number";
+        case JsonValue::Type::STRING: return "a string";
+        case JsonValue::Type::ARRAY: return "an array";
+        case JsonValue::Type::OBJECT: return "an object";
+    }
+    return "unknown";
+}
+
+void require_type(const JsonValue& value, JsonValue::Type expected) {
+    if (value.type() != expected) {
+        throw std::invalid_argument(std::string("expected ") + type_name(expected) + ", got " +
+                                    type_name(value.type()));
+    }
+}
+
+} // namespace
+
+bool JsonValue::as_bool() const {
+    require_type(*this, Type::BOOLEAN);
+    return bool_;
+}
+
+double JsonValue::as_number() const {
+    require_type(*this, Type::NUMBER);
+    return number_;
+}
+
+const std::string& JsonValue::as_string() const {
+    require_type(*this, Type::STRING);
+    return string_;
+}
+
+const std::vector<JsonValue>& JsonValue::as_array() const {
+    require_type(*this, Type::ARRAY);
+    return array_;
+}
+
+const std::map<std::string, JsonValue>& JsonValue::members() const {
+    require_type(*this, Type::OBJECT);
+    return object_;
+}
+
+const JsonValue* JsonValue::find(const std::string& key) const {
+    if (type_ != Type::OBJECT) return nullptr;
+    const auto it = object_.find(key);
+    return it == object_.end() ? nullptr : &it->second;
+}
+
+std::string JsonValue::to_json() const {
+    switch (type_) {
+        case Type::NUL: return "null";
+        case Type::BOOLEAN: return bool_ ? "true" : "false";
+        case Type::NUMBER: return string_;
+        case Type::STRING: return "\"" + json_escape(string_) + "\"";
+        case Type::ARRAY: {
+            std::string out = "[";
+            for (size_t i = 0; i < array_.size(); ++i) out += (i ? "," : "") + array_[i].to_json();
+            return out + "]";
+        }
+        case Type::OBJECT: {
+            std::string out = "{";
+            bool first = true;
+            for (const auto& [key, value] : object_) {
+                out += (first ? "\"" : ",\"") + json_escape(key) + "\":" + value.to_json();
+                first = false;
+            }
+            return out + "}";
+        }
+    }
+    return "null";
+}
+
+JsonValue JsonValue::parse(const std::string& text) {
+    return JsonParser(text).parse_document();
+}
+
+} // namespace amcheck
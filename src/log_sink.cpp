@@ -0,0 +1,157 @@
+#include "log_sink.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+namespace amcheck {
+
+AsyncLogSink::AsyncLogSink(std::ostream& out, HitFormatter formatter)
+    : AsyncLogSink(out, std::move(formatter), Options()) {}
+
+AsyncLogSink::AsyncLogSink(std::ostream& out, HitFormatter formatter, Options options)
+    : out_(out), formatter_(std::move(formatter)), options_(options),
+      head_(&stub_), tail_(&stub_), window_start_(std::chrono::steady_clock::now()) {
+    writer_ = std::thread(&AsyncLogSink::run, this);
+}
+
+AsyncLogSink::~AsyncLogSink() {
+    finish();
+}
+
+void AsyncLogSink::push(Record* record) {
+    record->next.store(nullptr, std::memory_order_relaxed);
+    Record* previous = head_.exchange(record, std::memory_order_acq_rel);
+    previous->next.store(record, std::memory_order_release);
+}
+
+AsyncLogSink::Record* AsyncLogSink::pop() {
+    Record* tail = tail_;
+    Record* next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &stub_) {
+        if (next == nullptr) return nullptr;
+        tail_ = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+        tail_ = next;
+        return tail;
+    }
+
+    // A producer has exchanged head_ but not linked its record yet; retry on the next pass
+    if (tail != head_.load(std::memory_order_acquire)) return nullptr;
+
+    push(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+        tail_ = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+void AsyncLogSink::post_hit(const SpinConfiguration& config) {
+    Record* record = new Record();
+    record->is_hit = true;
+    record->hit = config;
+    push(record);
+}
+
+void AsyncLogSink::post_text(std::string text) {
+    Record* record = new Record();
+    record->text = std::move(text);
+    push(record);
+}
+
+void AsyncLogSink::update_progress(size_t completed, size_t found) {
+    progress_completed_.store(completed, std::memory_order_relaxed);
+    progress_found_.store(found, std::memory_order_relaxed);
+    progress_dirty_.store(true, std::memory_order_release);
+}
+
+void AsyncLogSink::flush_window_summary() {
+    if (window_suppressed_ > 0) {
+        out_ << "  ... " << window_suppressed_ << " more hits in the last second"
+             << " (all hits are written to the results file)\n";
+    }
+    window_hits_ = 0;
+    window_suppressed_ = 0;
+    window_start_ = std::chrono::steady_clock::now();
+}
+
+void AsyncLogSink::drain(bool final_pass) {
+    bool wrote = false;
+
+    while (Record* record = pop()) {
+        if (progress_on_screen_) {
+            out_ << "\r" << std::string(80, ' ') << "\r";  // Clear progress line
+            progress_on_screen_ = false;
+        }
+        if (record->is_hit) {
+            if (window_hits_ < options_.max_hits_per_second) {
+                formatter_(out_, record->hit);
+                window_hits_++;
+            } else {
+                window_suppressed_++;
+                suppressed_total_++;
+            }
+        } else {
+            out_ << record->text;
+        }
+        wrote = true;
+        delete record;
+    }
+
+    if (final_pass || std::chrono::steady_clock::now() - window_start_ >= std::chrono::seconds(1)) {
+        if (window_suppressed_ > 0 && progress_on_screen_) {
+            out_ << "\r" << std::string(80, ' ') << "\r";
+            progress_on_screen_ = false;
+        }
+        wrote = wrote || window_suppressed_ > 0;
+        flush_window_summary();
+    }
+
+    if (!final_pass && progress_dirty_.exchange(false, std::memory_order_acquire)) {
+        // Progress is only informative; the caller prints the definitive 100% line
+        const size_t completed = progress_completed_.load(std::memory_order_relaxed);
+        const size_t total = std::max(options_.progress_total, completed);
+        out_ << "\rProgress: " << std::fixed << std::setprecision(1)
+             << (total > 0 ? 100.0 * completed / total : 0.0) << "% (" << completed << "/" << total
+             << ") - Found: " << progress_found_.load(std::memory_order_relaxed)
+             << " altermagnetic configs";
+        progress_on_screen_ = true;
+        wrote = true;
+    }
+
+    if (wrote) out_ << std::flush;
+}
+
+void AsyncLogSink::run() {
+    while (!stop_.load(std::memory_order_acquire)) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_.wait_for(lock, options_.flush_interval,
+                           [this] { return stop_.load(std::memory_order_acquire); });
+        }
+        drain(false);
+    }
+    drain(true);
+}
+
+void AsyncLogSink::finish() {
+    if (!writer_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_.store(true, std::memory_order_release);
+    }
+    wake_.notify_one();
+    writer_.join();
+
+    if (progress_on_screen_) {
+        out_ << "\r" << std::string(80, ' ') << "\r" << std::flush;
+        progress_on_screen_ = false;
+    }
+}
+
+} // namespace amcheck
@@ -1,28 +1,24 @@
 #include "amcheck.h"
+#include "altermagnet_sat.h"
+#include "distortion_sweep.h"
+#include "substitution.h"
+#include "profiler.h"
+#include "perf_counters.h"
+#include "search_plan.h"
+#include "pattern_verify.h"
+#include "spin_constraints.h"
+#include "serve_stdio.h"
+#include "structure_fingerprint.h"
+#include "tolerance_sweep.h"
+#include "watch_dir.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <numeric>
 #include <vector>
 #include <string>
 #include <stdexcept>
-
-// Forward declarations for functions in other files
-namespace amcheck {
-    void analyze_symmetry(CrystalStructure& structure, double tolerance = DEFAULT_TOLERANCE);
-    void assign_spins_interactively(CrystalStructure& structure);
-    void assign_spins_to_magnetic_atoms_only(CrystalStructure& structure);
-    void assign_magnetic_moments_interactively(CrystalStructure& structure);
-    void search_all_spin_configurations(const CrystalStructure& structure, const std::string& input_filename, double tolerance, bool verbose, bool use_gpu = true);
-    void print_banner();
-    void print_version();
-    void print_usage(const std::string& program_name);
-    void print_spacegroup_info(const CrystalStructure& structure);
-    void print_matrix(const Matrix3d& matrix, const std::string& name, int precision);
-    void print_hall_vector(const Matrix3d& antisymmetric_tensor);
-    
-    // Band analysis functions
-    BandAnalysisResult analyze_band_file(const std::string& filename, double threshold, bool verbose);
-    void print_band_analysis_summary(const BandAnalysisResult& result);
-    void print_detailed_band_analysis(const BandAnalysisResult& result);
-}
+#include <sstream>
 
 using namespace amcheck;
 
@@ -43,8 +39,53 @@ struct Arguments {
     double xmax = 0.0;  // X-axis maximum for band plot (0.0 means auto)
     double ymin = 0.0;  // Y-axis minimum for band plot
     double ymax = 0.0;  // Y-axis maximum for band plot (0.0 means auto)
+    SearchOptions search;  // --search-all engine settings
+    std::string profile_file;  // --profile: per-phase/per-thread timing JSON
+    std::string trace_file;    // --trace: Chrome trace-event JSON
+    bool perf_counters = false;  // --perf-counters: hardware counters per phase
+    bool plan = false;           // --plan: estimate the -a search instead of running it
+    bool exists = false;         // --exists: decide with a SAT solver whether any ordering is altermagnetic
+    std::string sat_proof;       // --sat-proof: stem for the --exists formula and DRAT proof
+    SpinSource spins;            // --spins / --magmom: standard mode without prompts
+    std::string verify_patterns; // --verify-patterns: check a file of spin patterns
+    std::string verify_output;   // --verify-output: verdict file (default: generated name)
+    std::string distort_modes;   // --distort: displacement/strain/tilt modes to sweep
+    std::vector<double> amplitudes = parse_amplitude_list("0:1:11");  // --amplitudes
+    std::string substitute;      // --substitute: host:dopant:count site substitutions to screen
+    bool serve_stdio = false;    // --serve-stdio: JSON-lines request server on stdin/stdout
+    std::string watch_dir;       // --watch: analyze files as they appear under a directory
+    std::string watch_summary;   // --watch-summary: summary file (default: <dir>/amcheck_watch_summary.tsv)
+    bool watch_once = false;     // --watch-once: analyze the current contents, then exit
+    double watch_poll = 0.0;     // --watch-poll: scan interval instead of inotify (0 = inotify)
+    bool keep_duplicates = false; // --keep-duplicates: search every -a input, even repeated structures
 };
 
+// "Fe,Mn" -> {"Fe", "Mn"}; empty items are dropped
+std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// A positive, finite number of seconds; the error names the option
+double parse_positive_seconds(const std::string& option, const std::string& text) {
+    double value = 0.0;
+    size_t used = 0;
+    try {
+        value = std::stod(text, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != text.size() || !std::isfinite(value) || value <= 0.0) {
+        throw std::invalid_argument(option + " must be a positive number of seconds, got '" + text + "'");
+    }
+    return value;
+}
+
 Arguments parse_arguments(int argc, char* argv[]) {
     Arguments args;
     
@@ -61,6 +102,18 @@ Arguments parse_arguments(int argc, char* argv[]) {
             args.ahc_mode = true;
         } else if (arg == "-a" || arg == "--search-all") {
             args.search_all_mode = true;
+        } else if (arg == "--plan") {
+            args.search_all_mode = true;
+            args.plan = true;
+        } else if (arg == "--exists") {
+            args.search_all_mode = true;
+            args.exists = true;
+        } else if (arg == "--sat-proof") {
+            if (i + 1 < argc) {
+                args.sat_proof = argv[++i];
+            } else {
+                throw std::invalid_argument("--sat-proof requires a file name stem");
+            }
         } else if (arg == "-b" || arg == "--band-analysis") {
             args.band_analysis_mode = true;
         } else if (arg == "--band-threshold") {
@@ -105,6 +158,197 @@ Arguments parse_arguments(int argc, char* argv[]) {
             } else {
                 throw std::invalid_argument("--tolerance requires a value");
             }
+        } else if (arg == "--tolerances") {
+            if (i + 1 < argc) {
+                args.search.tolerances = parse_tolerance_list(argv[++i]);
+            } else {
+                throw std::invalid_argument("--tolerances requires a comma-separated list");
+            }
+        } else if (arg == "--engine") {
+            if (i + 1 < argc) {
+                args.search.engine = string_to_engine(argv[++i]);
+            } else {
+                throw std::invalid_argument("--engine requires a value");
+            }
+        } else if (arg == "--profile") {
+            if (i + 1 < argc) {
+                args.profile_file = argv[++i];
+            } else {
+                throw std::invalid_argument("--profile requires a file name");
+            }
+        } else if (arg == "--trace") {
+            if (i + 1 < argc) {
+                args.trace_file = argv[++i];
+            } else {
+                throw std::invalid_argument("--trace requires a file name");
+            }
+        } else if (arg == "-j" || arg == "--threads") {
+            if (i + 1 < argc) {
+                const int threads = std::stoi(argv[++i]);
+                if (threads <= 0) {
+                    throw std::invalid_argument("--threads must be positive");
+                }
+                args.search.num_threads = static_cast<unsigned int>(threads);
+            } else {
+                throw std::invalid_argument("--threads requires a value");
+            }
+        } else if (arg == "--time-budget") {
+            if (i + 1 < argc) {
+                args.search.time_budget_s = std::stod(argv[++i]);
+                if (args.search.time_budget_s <= 0.0) {
+                    throw std::invalid_argument("--time-budget must be positive");
+                }
+            } else {
+                throw std::invalid_argument("--time-budget requires a value in seconds");
+            }
+        } else if (arg == "--max-configs") {
+            if (i + 1 < argc) {
+                const long long max_configs = std::stoll(argv[++i]);
+                if (max_configs <= 0) {
+                    throw std::invalid_argument("--max-configs must be positive");
+                }
+                args.search.max_configurations = static_cast<size_t>(max_configs);
+            } else {
+                throw std::invalid_argument("--max-configs requires a value");
+            }
+        } else if (arg == "--on-large") {
+            if (i + 1 < argc) {
+                args.search.on_large = string_to_large_policy(argv[++i]);
+            } else {
+                throw std::invalid_argument("--on-large requires a value");
+            }
+        } else if (arg == "--magnetic") {
+            if (i + 1 < argc) {
+                args.search.magnetic.species = split_list(argv[++i]);
+            } else {
+                throw std::invalid_argument("--magnetic requires a comma-separated list of elements");
+            }
+        } else if (arg == "--magnetic-orbits") {
+            if (i + 1 < argc) {
+                for (const std::string& orbit : split_list(argv[++i])) {
+                    args.search.magnetic.orbits.push_back(std::stoi(orbit));
+                }
+            } else {
+                throw std::invalid_argument("--magnetic-orbits requires a comma-separated list of orbit numbers");
+            }
+        } else if (arg == "--moments") {
+            if (i + 1 < argc) {
+                args.search.magnetic.moments = parse_moment_priors(argv[++i]);
+            } else {
+                throw std::invalid_argument("--moments requires Element=moment pairs");
+            }
+        } else if (arg == "--spins") {
+            if (i + 1 < argc) {
+                args.spins.pattern = argv[++i];
+            } else {
+                throw std::invalid_argument("--spins requires a spin pattern or file");
+            }
+        } else if (arg == "--magmom") {
+            if (i + 1 < argc) {
+                args.spins.moments_file = argv[++i];
+            } else {
+                throw std::invalid_argument("--magmom requires an INCAR, OUTCAR or vasprun.xml file");
+            }
+        } else if (arg == "--moment-threshold") {
+            if (i + 1 < argc) {
+                args.spins.threshold = std::stod(argv[++i]);
+            } else {
+                throw std::invalid_argument("--moment-threshold requires a value");
+            }
+        } else if (arg == "--verify-patterns") {
+            if (i + 1 < argc) {
+                args.verify_patterns = argv[++i];
+            } else {
+                throw std::invalid_argument("--verify-patterns requires a patterns file");
+            }
+        } else if (arg == "--distort") {
+            if (i + 1 < argc) {
+                args.distort_modes = argv[++i];
+            } else {
+                throw std::invalid_argument("--distort requires a modes file");
+            }
+        } else if (arg == "--amplitudes") {
+            if (i + 1 < argc) {
+                args.amplitudes = parse_amplitude_list(argv[++i]);
+            } else {
+                throw std::invalid_argument("--amplitudes requires a list or start:stop:count");
+            }
+        } else if (arg == "--substitute") {
+            if (i + 1 < argc) {
+                args.substitute = argv[++i];
+                parse_substitution_spec(args.substitute);
+            } else {
+                throw std::invalid_argument("--substitute requires host:dopant:count");
+            }
+        } else if (arg == "--serve-stdio") {
+            args.serve_stdio = true;
+        } else if (arg == "--watch") {
+            if (i + 1 < argc) {
+                args.watch_dir = argv[++i];
+            } else {
+                throw std::invalid_argument("--watch requires a directory");
+            }
+        } else if (arg == "--watch-summary") {
+            if (i + 1 < argc) {
+                args.watch_summary = argv[++i];
+            } else {
+                throw std::invalid_argument("--watch-summary requires a file name");
+            }
+        } else if (arg == "--keep-duplicates") {
+            args.keep_duplicates = true;
+        } else if (arg == "--watch-once") {
+            args.watch_once = true;
+        } else if (arg == "--watch-poll") {
+            if (i + 1 < argc) {
+                args.watch_poll = std::stod(argv[++i]);
+                if (args.watch_poll <= 0.0) {
+                    throw std::invalid_argument("--watch-poll must be positive");
+                }
+            } else {
+                throw std::invalid_argument("--watch-poll requires a value");
+            }
+        } else if (arg == "--verify-output") {
+            if (i + 1 < argc) {
+                args.verify_output = argv[++i];
+            } else {
+                throw std::invalid_argument("--verify-output requires a file name");
+            }
+        } else if (arg == "--constrain") {
+            if (i + 1 < argc) {
+                args.search.constraints += std::string(argv[++i]) + "\n";
+            } else {
+                throw std::invalid_argument("--constrain requires a constraint statement");
+            }
+        } else if (arg == "--constraints") {
+            if (i + 1 < argc) {
+                args.search.constraints += read_constraint_file(argv[++i]) + "\n";
+            } else {
+                throw std::invalid_argument("--constraints requires a file name");
+            }
+        } else if (arg == "--ternary") {
+            args.search.ternary = true;
+        } else if (arg == "--no-dedup") {
+            args.search.symmetry_dedup = false;
+        } else if (arg == "--no-gray") {
+            args.search.gray_walk = false;
+        } else if (arg == "--pin-threads") {
+            args.search.pin_threads = true;
+        } else if (arg == "-q" || arg == "--quiet") {
+            args.search.quiet = true;
+        } else if (arg == "--status-file") {
+            if (i + 1 < argc) {
+                args.search.status_file = argv[++i];
+            } else {
+                throw std::invalid_argument("--status-file requires a path");
+            }
+        } else if (arg == "--status-interval") {
+            if (i + 1 < argc) {
+                args.search.status_interval_s = parse_positive_seconds("--status-interval", argv[++i]);
+            } else {
+                throw std::invalid_argument("--status-interval requires a value");
+            }
+        } else if (arg == "--perf-counters") {
+            args.perf_counters = true;
         } else if (arg == "--gpu") {
             args.use_gpu = true;
             args.force_cpu = false;
@@ -131,13 +375,19 @@ void process_altermagnet_analysis(const std::string& filename, const Arguments&
     
     try {
         CrystalStructure structure;
-        structure.read_from_file(filename);
+        {
+            ScopedSpan span("parse");
+            structure.read_from_file(filename);
+        }
         
         std::cout << "Structure loaded successfully!\n";
         
         // Analyze symmetry
         std::cout << "Analyzing crystal symmetry...\n";
-        analyze_symmetry(structure, args.symprec);
+        {
+            ScopedSpan span("symmetry");
+            analyze_symmetry(structure, args.symprec);
+        }
         
         // Print space group information
         print_spacegroup_info(structure);
@@ -153,9 +403,13 @@ void process_altermagnet_analysis(const std::string& filename, const Arguments&
                   << aux_filename << "\n";
         structure.write_vasp_file(aux_filename);
         
-        // Get spins from user input (magnetic atoms only)
+        // Get spins from --spins/--magmom, otherwise from user input (magnetic atoms only)
         std::cout << "\nSetting up magnetic configuration...\n";
-        assign_spins_to_magnetic_atoms_only(structure);
+        if (!args.spins.empty()) {
+            assign_spins_from_source(structure, args.spins, args.search.magnetic, filename);
+        } else {
+            assign_spins_to_magnetic_atoms_only(structure, args.search.magnetic);
+        }
         
         // Extract data for altermagnet analysis
         std::vector<Vector3d> positions = structure.get_all_scaled_positions();
@@ -169,6 +423,7 @@ void process_altermagnet_analysis(const std::string& filename, const Arguments&
         
         // Perform altermagnet analysis
         std::cout << "\nPerforming altermagnet detection...\n";
+        ScopedSpan check_span("altermagnet check");
         bool is_am = is_altermagnet(
             structure.symmetry_operations,
             positions,
@@ -207,7 +462,10 @@ void process_ahc_analysis(const std::string& filename, const Arguments& args) {
     
     try {
         CrystalStructure structure;
-        structure.read_from_file(filename);
+        {
+            ScopedSpan span("parse");
+            structure.read_from_file(filename);
+        }
         
         std::cout << "Structure loaded successfully!\n\n";
         std::cout << "List of atoms:\n";
@@ -286,13 +544,19 @@ void process_search_all_analysis(const std::string& filename, const Arguments& a
     
     try {
         CrystalStructure structure;
-        structure.read_from_file(filename);
+        {
+            ScopedSpan span("parse");
+            structure.read_from_file(filename);
+        }
         
         std::cout << "Structure loaded successfully!\n";
         
         // Analyze symmetry
         std::cout << "Analyzing crystal symmetry...\n";
-        analyze_symmetry(structure, args.symprec);
+        {
+            ScopedSpan span("symmetry");
+            analyze_symmetry(structure, args.symprec);
+        }
         
         // Print space group information
         print_spacegroup_info(structure);
@@ -302,8 +566,147 @@ void process_search_all_analysis(const std::string& filename, const Arguments& a
                       << structure.symmetry_operations.size() << "\n";
         }
         
+        if (args.plan) {
+            print_search_plan(plan_spin_search(structure, args.tolerance, args.search), std::cout);
+            return;
+        }
+        
+        if (args.exists) {
+            // One formula and proof per input when several structures are queried
+            std::string proof_stem = args.sat_proof;
+            if (!proof_stem.empty() && args.files.size() > 1) proof_stem += "_" + output_file_stem(filename);
+            print_existence_result(find_altermagnetic_ordering(structure, args.tolerance, args.search, proof_stem),
+                                   std::cout);
+            return;
+        }
+        
         // Start comprehensive search
-        search_all_spin_configurations(structure, filename, args.tolerance, args.verbose, args.use_gpu && !args.force_cpu);
+        search_all_spin_configurations(structure, filename, args.tolerance, args.verbose, args.use_gpu && !args.force_cpu, args.search);
+        
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << "\n";
+    }
+}
+
+void report_duplicate_structure(const std::string& filename, const std::string& representative,
+                                const StructureFingerprint& fingerprint) {
+    std::cout << "\n";
+    std::cout << "=======================================================================\n";
+    std::cout << "                    COMPREHENSIVE SPIN SEARCH MODE\n";
+    std::cout << "=======================================================================\n";
+    std::cout << "Processing: " << filename << "\n";
+    std::cout << "-----------------------------------------------------------------------\n";
+    std::cout << "Same structure as " << representative << " (fingerprint " << fingerprint.hex() << ")\n";
+    std::cout << "Search skipped: the results of " << representative << " apply to this file.\n";
+    std::cout << "Configurations there are numbered in the atom order of " << representative << ".\n";
+}
+
+void process_pattern_verification(const std::string& filename, const Arguments& args) {
+    std::cout << "\n";
+    std::cout << "=======================================================================\n";
+    std::cout << "                    SPIN PATTERN VERIFICATION MODE\n";
+    std::cout << "=======================================================================\n";
+    std::cout << "Processing: " << filename << "\n";
+    std::cout << "-----------------------------------------------------------------------\n";
+    
+    try {
+        CrystalStructure structure;
+        {
+            ScopedSpan span("parse");
+            structure.read_from_file(filename);
+        }
+        
+        std::cout << "Structure loaded successfully!\n";
+        
+        std::cout << "Analyzing crystal symmetry...\n";
+        {
+            ScopedSpan span("symmetry");
+            analyze_symmetry(structure, args.symprec);
+        }
+        
+        print_spacegroup_info(structure);
+        
+        const std::string output_file = args.verify_output.empty()
+            ? output_file_stem(filename) + "_amcheck_verified_" + output_timestamp() + ".txt"
+            : args.verify_output;
+        verify_spin_patterns(structure, args.verify_patterns, output_file, args.tolerance, args.search);
+        
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << "\n";
+    }
+}
+
+void process_distortion_sweep(const std::string& filename, const Arguments& args) {
+    std::cout << "\n";
+    std::cout << "=======================================================================\n";
+    std::cout << "                       DISTORTION SWEEP MODE\n";
+    std::cout << "=======================================================================\n";
+    std::cout << "Processing: " << filename << "\n";
+    std::cout << "-----------------------------------------------------------------------\n";
+    
+    try {
+        CrystalStructure structure;
+        {
+            ScopedSpan span("parse");
+            structure.read_from_file(filename);
+        }
+        
+        std::cout << "Structure loaded successfully!\n";
+        
+        std::cout << "Analyzing crystal symmetry...\n";
+        {
+            ScopedSpan span("symmetry");
+            analyze_symmetry(structure, args.symprec);
+        }
+        
+        print_spacegroup_info(structure);
+        
+        // The sweep checks one fixed pattern, so it has to come without prompts
+        if (args.spins.empty()) {
+            throw std::invalid_argument("--distort needs the spin pattern from --spins or --magmom");
+        }
+        const std::vector<SpinType> spins = spins_from_source(structure, args.spins, args.search.magnetic, filename);
+        const std::vector<DistortionMode> modes = read_distortion_modes(args.distort_modes, structure.atoms.size());
+        
+        const std::vector<DistortionStep> steps = run_distortion_sweep(
+            structure, modes, args.amplitudes, spins, args.tolerance, resolve_thread_count(args.search.num_threads));
+        print_distortion_sweep(structure, modes, args.amplitudes, steps, std::cout);
+        
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << "\n";
+    }
+}
+
+void process_substitution_search(const std::string& filename, const Arguments& args) {
+    std::cout << "\n";
+    std::cout << "=======================================================================\n";
+    std::cout << "                      SITE SUBSTITUTION SEARCH MODE\n";
+    std::cout << "=======================================================================\n";
+    std::cout << "Processing: " << filename << "\n";
+    std::cout << "-----------------------------------------------------------------------\n";
+    
+    try {
+        CrystalStructure structure;
+        {
+            ScopedSpan span("parse");
+            structure.read_from_file(filename);
+        }
+        
+        std::cout << "Structure loaded successfully!\n";
+        
+        std::cout << "Analyzing crystal symmetry...\n";
+        {
+            ScopedSpan span("symmetry");
+            analyze_symmetry(structure, args.symprec);
+        }
+        
+        print_spacegroup_info(structure);
+        
+        const SubstitutionSpec spec = parse_substitution_spec(args.substitute);
+        const DecorationSet decorations = enumerate_decorations(structure, spec, args.tolerance);
+        const std::vector<DecorationResult> results =
+            search_decorations(structure, spec, decorations, args.tolerance, args.search);
+        print_substitution_results(structure, spec, decorations, results, std::cout);
         
     } catch (const std::exception& e) {
         std::cerr << "ERROR: " << e.what() << "\n";
@@ -319,7 +722,13 @@ void process_band_analysis(const std::string& filename, const Arguments& args) {
     std::cout << "-----------------------------------------------------------------------\n";
     
     try {
-        BandAnalysisResult result = analyze_band_file(filename, args.band_threshold, args.verbose);
+        BandAnalysisResult result;
+        {
+            ScopedSpan span("band analysis");
+            ScopedPerfCounters counters("band analysis");
+            result = analyze_band_file(filename, args.band_threshold, args.verbose);
+            counters.add_units(static_cast<uint64_t>(result.nkpts));
+        }
         
         // Print summary
         print_band_analysis_summary(result);
@@ -388,6 +797,7 @@ void process_band_analysis(const std::string& filename, const Arguments& args) {
             std::cout << "Using default k-point labeling.\n";
         }
         
+        ScopedSpan output_span("output");
         generate_band_plot_script(result, filename, {args.xmin, args.xmax}, {args.ymin, args.ymax}, kpoint_labels);
         
     } catch (const std::exception& e) {
@@ -409,6 +819,41 @@ int main(int argc, char* argv[]) {
             return 0;
         }
         
+        // Server mode owns stdout for responses: no banner, no input files
+        if (args.serve_stdio) {
+            std::ios::sync_with_stdio(false);
+            ServeOptions serve;
+            serve.symprec = args.symprec;
+            serve.tolerance = args.tolerance;
+            serve.search = args.search;
+            const size_t failed = serve_json_lines(std::cin, std::cout, serve);
+            if (failed > 0) {
+                std::cerr << "amcheck: " << failed << " request" << (failed == 1 ? "" : "s") << " failed\n";
+            }
+            return 0;
+        }
+        
+        // Watch mode: files come from the directory, results go to the summary file
+        if (!args.watch_dir.empty()) {
+            print_banner();
+            WatchOptions watch;
+            watch.directory = args.watch_dir;
+            watch.summary_file = args.watch_summary;
+            watch.analysis = args.search_all_mode ? WatchAnalysis::SEARCH
+                           : args.band_analysis_mode ? WatchAnalysis::BAND
+                           : WatchAnalysis::STANDARD;
+            watch.symprec = args.symprec;
+            watch.tolerance = args.tolerance;
+            watch.search = args.search;
+            watch.spins = args.spins;
+            watch.band_threshold = args.band_threshold;
+            watch.once = args.watch_once;
+            watch.poll = args.watch_poll > 0.0;
+            if (watch.poll) watch.poll_interval_s = args.watch_poll;
+            watch_directory(watch);
+            return 0;
+        }
+        
         if (args.files.empty()) {
             print_banner();
             std::cerr << "Error: No input files specified\n\n";
@@ -425,8 +870,54 @@ int main(int argc, char* argv[]) {
             std::cout << "Running in verbose mode\n";
         }
         
-        for (const std::string& filename : args.files) {
-            if (args.search_all_mode) {
+        if (!args.profile_file.empty() || !args.trace_file.empty()) {
+            Profiler::instance().enable();
+        }
+        
+        if (args.perf_counters) {
+            PerfCounters::instance().enable();
+        }
+        
+        // Screening: search each distinct crystal once. Constraints, orbit selections, spin
+        // patterns and distortion modes name atoms by position in the file, and --magmom reads
+        // each run's own moments, so those runs keep every input.
+        std::vector<size_t> representative(args.files.size());
+        std::iota(representative.begin(), representative.end(), 0);
+        std::vector<StructureFingerprint> fingerprints;
+        if (args.search_all_mode && args.verify_patterns.empty() && args.files.size() > 1 && !args.keep_duplicates) {
+            if (!args.search.constraints.empty() || !args.search.magnetic.orbits.empty()) {
+                std::cout << "Structure deduplication off: --constrain/--magnetic-orbits refer to atom numbers\n";
+            } else if (!args.spins.empty() || !args.distort_modes.empty() || !args.substitute.empty()) {
+                std::cout << "Structure deduplication off: --spins/--magmom, --distort and --substitute results "
+                          << "depend on each input's atom order and moments\n";
+            } else {
+                ScopedSpan span("fingerprint");
+                representative = find_duplicate_structures(args.files, args.symprec, &fingerprints);
+                const size_t unique = std::count_if(representative.begin(), representative.end(),
+                    [i = size_t(0)](size_t r) mutable { return r == i++; });
+                std::cout << "Structure deduplication: " << args.files.size() << " inputs, " << unique
+                          << " distinct structure" << (unique == 1 ? "" : "s") << "\n";
+                for (size_t i = 0; i < args.files.size(); ++i) {
+                    if (representative[i] != i) {
+                        std::cout << "  " << args.files[i] << " = " << args.files[representative[i]] << "\n";
+                    }
+                }
+            }
+        }
+        
+        for (size_t file_index = 0; file_index < args.files.size(); ++file_index) {
+            const std::string& filename = args.files[file_index];
+            ScopedSpan structure_span("structure", "structure", filename);
+            if (representative[file_index] != file_index) {
+                report_duplicate_structure(filename, args.files[representative[file_index]],
+                                           fingerprints[file_index]);
+            } else if (!args.verify_patterns.empty()) {
+                process_pattern_verification(filename, args);
+            } else if (!args.distort_modes.empty()) {
+                process_distortion_sweep(filename, args);
+            } else if (!args.substitute.empty()) {
+                process_substitution_search(filename, args);
+            } else if (args.search_all_mode) {
                 process_search_all_analysis(filename, args);
             } else if (args.ahc_mode) {
                 process_ahc_analysis(filename, args);
@@ -437,6 +928,18 @@ int main(int argc, char* argv[]) {
             }
         }
         
+        if (args.perf_counters) {
+            PerfCounters::instance().print_report(std::cout);
+        }
+        if (!args.profile_file.empty()) {
+            Profiler::instance().write_profile(args.profile_file);
+            std::cout << "\nProfile written to: " << args.profile_file << "\n";
+        }
+        if (!args.trace_file.empty()) {
+            Profiler::instance().write_trace(args.trace_file);
+            std::cout << "Trace written to: " << args.trace_file << "\n";
+        }
+        
         std::cout << "\n";
         std::cout << "=======================================================================\n";
         std::cout << "                            ANALYSIS COMPLETE\n";
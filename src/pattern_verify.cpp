@@ -0,0 +1,303 @@
+#include "pattern_verify.h"
+#include "altermagnet_checker.h"
+#include "profiler.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace amcheck {
+
+namespace {
+
+const char PACKED_MAGIC[8] = {'A', 'M', 'C', 'K', 'P', 'A', 'T', '1'};
+
+// Records are read, evaluated and written in batches so memory stays bounded for any file size
+const size_t BATCH_RECORDS = 65536;
+
+struct PatternRecord {
+    size_t number = 0;          // text line or binary record, 1-based
+    std::string config_id;      // "-" when the input did not carry one
+    std::vector<SpinType> spins;
+    bool parsed = false;
+    CheckOutcome outcome = CheckOutcome::INVALID;
+};
+
+std::string trim(const std::string& s) {
+    const size_t first = s.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return "";
+    return s.substr(first, s.find_last_not_of(" \t\r") - first + 1);
+}
+
+bool is_integer(const std::string& s) {
+    return !s.empty() && s.find_first_not_of("0123456789") == std::string::npos;
+}
+
+// Extracts the id and the pattern text from one line of any supported text layout
+void split_pattern_line(const std::string& line, std::string& config_id, std::string& pattern) {
+    config_id = "-";
+    if (line.compare(0, 8, "Config #") == 0) {
+        const size_t colon = line.find(':');
+        const std::string id = trim(line.substr(8, colon == std::string::npos ? std::string::npos : colon - 8));
+        if (is_integer(id)) config_id = id;
+        pattern = colon == std::string::npos ? "" : line.substr(colon + 1);
+        pattern = pattern.substr(0, pattern.find('|'));
+        return;
+    }
+
+    const size_t bar = line.find('|');
+    if (bar == std::string::npos) {
+        pattern = line;
+        return;
+    }
+    const std::string left = trim(line.substr(0, bar));
+    if (is_integer(left)) {
+        config_id = left;
+        pattern = line.substr(bar + 1);
+        pattern = pattern.substr(0, pattern.find('|'));
+    } else {
+        pattern = left;
+    }
+}
+
+// One token per atom, or one per magnetic site in atom order
+bool parse_record_spins(
+    const std::string& pattern,
+    size_t num_atoms,
+    const std::vector<size_t>& magnetic_indices,
+    std::vector<SpinType>& spins
+) {
+    std::vector<SpinType> parsed;
+    try {
+        parsed = parse_spin_pattern(pattern);
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+
+    if (parsed.size() == num_atoms) {
+        spins = std::move(parsed);
+        return true;
+    }
+    if (parsed.size() == magnetic_indices.size() && !parsed.empty()) {
+        spins.assign(num_atoms, SpinType::NONE);
+        for (size_t i = 0; i < magnetic_indices.size(); ++i) spins[magnetic_indices[i]] = parsed[i];
+        return true;
+    }
+    return false;
+}
+
+uint64_t read_le(const unsigned char* bytes, size_t width) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < width; ++i) value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    return value;
+}
+
+// Reader for both input formats; next_batch() returns false at end of input
+class PatternReader {
+public:
+    PatternReader(const std::string& filename, size_t num_atoms, const std::vector<size_t>& magnetic_indices)
+        : in_(filename, std::ios::binary), num_atoms_(num_atoms), magnetic_indices_(magnetic_indices) {
+        if (!in_.is_open()) {
+            throw std::runtime_error("Could not open patterns file: " + filename);
+        }
+
+        char magic[sizeof(PACKED_MAGIC)] = {};
+        in_.read(magic, sizeof(magic));
+        packed_ = in_.gcount() == sizeof(magic) && std::memcmp(magic, PACKED_MAGIC, sizeof(magic)) == 0;
+        if (!packed_) {
+            in_.clear();
+            in_.seekg(0);
+            return;
+        }
+
+        unsigned char header[8];
+        if (!in_.read(reinterpret_cast<char*>(header), sizeof(header))) {
+            throw std::runtime_error(filename + ": truncated packed header");
+        }
+        const uint64_t sites = read_le(header, 4);
+        if (sites != magnetic_indices.size()) {
+            throw std::runtime_error(filename + ": packed patterns have " + std::to_string(sites) +
+                                     " magnetic sites, the structure has " +
+                                     std::to_string(magnetic_indices.size()));
+        }
+        if (sites > 64) {
+            throw std::runtime_error(filename + ": packed patterns support at most 64 magnetic sites");
+        }
+    }
+
+    bool packed() const { return packed_; }
+
+    bool next_batch(std::vector<PatternRecord>& batch) {
+        batch.clear();
+        while (batch.size() < BATCH_RECORDS && (packed_ ? read_packed(batch) : read_text(batch))) {}
+        return !batch.empty();
+    }
+
+private:
+    bool read_text(std::vector<PatternRecord>& batch) {
+        std::string line;
+        while (std::getline(in_, line)) {
+            ++number_;
+            const std::string content = trim(line);
+            if (content.empty() || content[0] == '#') continue;
+
+            PatternRecord record;
+            record.number = number_;
+            std::string pattern;
+            split_pattern_line(content, record.config_id, pattern);
+            record.parsed = parse_record_spins(pattern, num_atoms_, magnetic_indices_, record.spins);
+            if (!record.parsed) record.spins.clear();
+            batch.push_back(std::move(record));
+            return true;
+        }
+        return false;
+    }
+
+    bool read_packed(std::vector<PatternRecord>& batch) {
+        unsigned char bytes[8];
+        if (!in_.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) return false;
+
+        PatternRecord record;
+        record.number = ++number_;
+        const uint64_t id = read_le(bytes, 8);
+        record.config_id = std::to_string(id);
+        record.spins.assign(num_atoms_, SpinType::NONE);
+        record.parsed = magnetic_indices_.size() == 64 || id >> magnetic_indices_.size() == 0;
+        if (record.parsed) {
+            decode_configuration_id(static_cast<size_t>(id), magnetic_indices_, record.spins);
+        } else {
+            record.spins.clear();
+        }
+        batch.push_back(std::move(record));
+        return true;
+    }
+
+    std::ifstream in_;
+    size_t num_atoms_;
+    const std::vector<size_t>& magnetic_indices_;
+    bool packed_ = false;
+    size_t number_ = 0;
+};
+
+} // namespace
+
+PatternVerifySummary verify_spin_patterns(
+    const CrystalStructure& structure,
+    const std::string& patterns_file,
+    const std::string& output_file,
+    double tolerance,
+    const SearchOptions& options
+) {
+    const auto start_time = std::chrono::steady_clock::now();
+    const size_t num_atoms = structure.atoms.size();
+    const std::vector<size_t> magnetic_indices = get_magnetic_atom_indices(structure, options.magnetic);
+
+    PatternReader reader(patterns_file, num_atoms, magnetic_indices);
+    std::ofstream out(output_file);
+    if (!out.is_open()) {
+        throw std::runtime_error("Could not open output file: " + output_file);
+    }
+
+    // Structure data is identical for every pattern; extract it once
+    const std::vector<Vector3d> positions = structure.get_all_scaled_positions();
+    std::vector<std::string> chemical_symbols;
+    for (const auto& atom : structure.atoms) {
+        chemical_symbols.push_back(atom.chemical_symbol);
+    }
+    std::unique_ptr<AltermagnetChecker> checker;
+    if (options.engine == SearchEngine::TABLE) {
+        ScopedSpan span("orbit setup");
+        checker = std::make_unique<AltermagnetChecker>(
+            structure.symmetry_operations, positions, structure.equivalent_atoms, tolerance);
+    }
+
+    auto evaluate = [&](const std::vector<SpinType>& spins) {
+        if (checker) return checker->evaluate(spins);
+        try {
+            return is_altermagnet(structure.symmetry_operations, positions, structure.equivalent_atoms,
+                                  chemical_symbols, spins, tolerance, false, true)
+                       ? CheckOutcome::ALTERMAGNET
+                       : CheckOutcome::NOT_ALTERMAGNET;
+        } catch (const std::exception&) {
+            return CheckOutcome::INVALID;
+        }
+    };
+
+    const unsigned int num_threads = resolve_thread_count(options.num_threads);
+
+    std::cout << "Verifying spin patterns from " << patterns_file
+              << (reader.packed() ? " (packed binary)" : "") << "\n";
+    std::cout << "Magnetic sublattice: " << describe_magnetic_selection(options.magnetic)
+              << " (" << magnetic_indices.size() << " of " << num_atoms << " atoms)\n";
+    std::cout << "Engine: " << engine_to_string(options.engine) << ", threads: " << num_threads << "\n";
+
+    out << "# AMCheck C++ - Spin pattern verification\n";
+    out << "# Patterns: " << patterns_file << "\n";
+    out << "# Structure: " << num_atoms << " atoms, " << magnetic_indices.size() << " magnetic\n";
+    out << "# Tolerance: " << tolerance << "\n";
+    out << "# Engine: " << engine_to_string(options.engine) << "\n";
+    out << "#\n";
+    out << "# Format: " << (reader.packed() ? "Record" : "Line") << "\tVerdict\tConfigID\tSpin_Pattern\n";
+    out << "#         verdict is altermagnet, not_altermagnet, invalid (unbalanced orbit) or parse_error\n";
+    out << "#\n";
+
+    PatternVerifySummary summary;
+    std::vector<PatternRecord> batch;
+    batch.reserve(BATCH_RECORDS);
+    while (reader.next_batch(batch)) {
+        {
+            ScopedSpan span("verify");
+            auto worker = [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    if (batch[i].parsed) batch[i].outcome = evaluate(batch[i].spins);
+                }
+            };
+            const size_t workers = std::max<size_t>(1, std::min<size_t>(num_threads, batch.size() / 256));
+            const size_t chunk = (batch.size() + workers - 1) / workers;
+            std::vector<std::thread> threads;
+            for (size_t t = 1; t < workers; ++t) {
+                threads.emplace_back(worker, std::min(batch.size(), t * chunk), std::min(batch.size(), (t + 1) * chunk));
+            }
+            worker(0, std::min(batch.size(), chunk));
+            for (auto& thread : threads) thread.join();
+        }
+
+        ScopedSpan span("output");
+        for (const PatternRecord& record : batch) {
+            summary.records++;
+            out << record.number << '\t';
+            if (!record.parsed) {
+                summary.parse_errors++;
+                out << "parse_error\t" << record.config_id << "\t-\n";
+                continue;
+            }
+            switch (record.outcome) {
+                case CheckOutcome::ALTERMAGNET: summary.altermagnets++; break;
+                case CheckOutcome::NOT_ALTERMAGNET: summary.not_altermagnets++; break;
+                case CheckOutcome::INVALID: summary.invalid++; break;
+            }
+            out << outcome_to_string(record.outcome) << '\t' << record.config_id << '\t';
+            for (size_t j = 0; j < record.spins.size(); ++j) {
+                out << (j ? " " : "") << spin_to_string(record.spins[j]);
+            }
+            out << '\n';
+        }
+    }
+
+    summary.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    std::cout << "\nPatterns verified: " << summary.records << " in " << summary.elapsed_s << " s\n";
+    std::cout << "  altermagnet:     " << summary.altermagnets << "\n";
+    std::cout << "  not_altermagnet: " << summary.not_altermagnets << "\n";
+    std::cout << "  invalid:         " << summary.invalid << "\n";
+    std::cout << "  parse_error:     " << summary.parse_errors << "\n";
+    std::cout << "Verdicts saved to: " << output_file << "\n";
+    return summary;
+}
+
+} // namespace amcheck
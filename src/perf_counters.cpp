@@ -0,0 +1,188 @@
+#include "perf_counters.h"
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace amcheck {
+
+namespace {
+
+#ifdef __linux__
+// Order matches the fields of PerfCounterValues
+const uint64_t kHardwareEvents[] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+constexpr size_t kNumEvents = sizeof(kHardwareEvents) / sizeof(kHardwareEvents[0]);
+
+int open_counter(uint64_t config, int group_fd) {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = group_fd == -1 ? 1 : 0;  // the leader starts the whole group
+    attr.exclude_kernel = 1;                   // user space only: works without privileges
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // Calling thread on any CPU
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+#endif
+
+double per_unit(uint64_t count, uint64_t units) {
+    return units > 0 ? static_cast<double>(count) / units : 0.0;
+}
+
+} // namespace
+
+PerfCounterValues& PerfCounterValues::operator+=(const PerfCounterValues& other) {
+    cycles += other.cycles;
+    instructions += other.instructions;
+    cache_misses += other.cache_misses;
+    branch_misses += other.branch_misses;
+    return *this;
+}
+
+PerfCounters& PerfCounters::instance() {
+    static PerfCounters counters;
+    return counters;
+}
+
+void PerfCounters::accumulate(const std::string& phase, const PerfCounterValues& values, uint64_t units,
+                              std::chrono::steady_clock::time_point start,
+                              std::chrono::steady_clock::time_point end) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = phases_.find(phase);
+    if (it == phases_.end()) {
+        phase_order_.push_back(phase);
+        it = phases_.emplace(phase, PhaseTotals()).first;
+        it->second.first_start = start;
+        it->second.last_end = end;
+    }
+    PhaseTotals& totals = it->second;
+    totals.values += values;
+    totals.units += units;
+    totals.threads++;
+    totals.first_start = std::min(totals.first_start, start);
+    totals.last_end = std::max(totals.last_end, end);
+}
+
+void PerfCounters::note_unavailable(const std::string& reason) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (unavailable_reason_.empty()) {
+        unavailable_reason_ = reason;
+    }
+}
+
+void PerfCounters::print_report(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    out << "\n=======================================================================\n";
+    out << "                    HARDWARE PERFORMANCE COUNTERS\n";
+    out << "=======================================================================\n";
+    if (phases_.empty()) {
+        out << "No counter data collected";
+        if (!unavailable_reason_.empty()) {
+            out << ": " << unavailable_reason_;
+        }
+        out << "\n=======================================================================\n";
+        return;
+    }
+
+    out << std::left << std::setw(14) << "Phase" << std::right
+        << std::setw(8) << "Threads" << std::setw(12) << "Units" << std::setw(14) << "Units/s"
+        << std::setw(8) << "IPC" << std::setw(14) << "Cycles/unit"
+        << std::setw(14) << "L-miss/unit" << std::setw(14) << "Br-miss/unit" << "\n";
+    out << "-----------------------------------------------------------------------\n";
+
+    for (const auto& name : phase_order_) {
+        const PhaseTotals& t = phases_.at(name);
+        const double wall_s = std::chrono::duration<double>(t.last_end - t.first_start).count();
+        const double ipc = t.values.cycles > 0 ? static_cast<double>(t.values.instructions) / t.values.cycles : 0.0;
+        out << std::left << std::setw(14) << name << std::right
+            << std::setw(8) << t.threads
+            << std::setw(12) << t.units
+            << std::setw(14) << std::fixed << std::setprecision(0) << (wall_s > 0.0 ? t.units / wall_s : 0.0)
+            << std::setw(8) << std::setprecision(2) << ipc
+            << std::setw(14) << std::setprecision(1) << per_unit(t.values.cycles, t.units)
+            << std::setw(14) << std::setprecision(3) << per_unit(t.values.cache_misses, t.units)
+            << std::setw(14) << std::setprecision(3) << per_unit(t.values.branch_misses, t.units) << "\n";
+    }
+    out << "-----------------------------------------------------------------------\n";
+    out << "Counts are user-space only; L-miss = last-level cache misses.\n";
+    if (!unavailable_reason_.empty()) {
+        out << "Some threads were not counted: " << unavailable_reason_ << "\n";
+    }
+    out << "=======================================================================\n";
+    out.unsetf(std::ios::floatfield);
+}
+
+ScopedPerfCounters::ScopedPerfCounters(const char* phase) : phase_(phase) {
+    PerfCounters& counters = PerfCounters::instance();
+    if (!counters.enabled()) return;
+
+#ifdef __linux__
+    for (size_t e = 0; e < kNumEvents; ++e) {
+        int fd = open_counter(kHardwareEvents[e], group_fd_);
+        if (fd < 0) {
+            const int err = errno;
+            for (int open_fd : fds_) close(open_fd);
+            fds_.clear();
+            std::string reason = std::string("perf_event_open failed (") + std::strerror(err) + ")";
+            if (err == EACCES || err == EPERM) {
+                reason += "; check /proc/sys/kernel/perf_event_paranoid";
+            } else if (err == ENOENT || err == EOPNOTSUPP) {
+                reason += "; this CPU or VM does not expose hardware events";
+            }
+            counters.note_unavailable(reason);
+            return;
+        }
+        if (group_fd_ == -1) group_fd_ = fd;
+        fds_.push_back(fd);
+    }
+
+    start_ = std::chrono::steady_clock::now();
+    ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    active_ = true;
+#else
+    counters.note_unavailable("hardware counters require Linux perf_event_open");
+#endif
+}
+
+ScopedPerfCounters::~ScopedPerfCounters() {
+#ifdef __linux__
+    if (active_) {
+        ioctl(group_fd_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        const auto end = std::chrono::steady_clock::now();
+
+        // PERF_FORMAT_GROUP layout: nr, then one value per event in opening order
+        uint64_t buffer[1 + kNumEvents] = {0};
+        const ssize_t bytes = read(group_fd_, buffer, sizeof(buffer));
+        if (bytes == static_cast<ssize_t>(sizeof(buffer)) && buffer[0] == kNumEvents) {
+            PerfCounterValues values;
+            values.cycles = buffer[1];
+            values.instructions = buffer[2];
+            values.cache_misses = buffer[3];
+            values.branch_misses = buffer[4];
+            PerfCounters::instance().accumulate(phase_, values, units_, start_, end);
+        } else {
+            PerfCounters::instance().note_unavailable("could not read the counter group");
+        }
+    }
+    for (int fd : fds_) close(fd);
+#endif
+}
+
+} // namespace amcheck
@@ -0,0 +1,192 @@
+#include "profiler.h"
+#include "amcheck.h"
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <stdexcept>
+#include <ctime>
+
+namespace amcheck {
+
+namespace {
+
+#if defined(_MSC_VER)
+// No per-thread CPU clock; report process CPU time for both
+double thread_clock_us() { return 1e6 * std::clock() / CLOCKS_PER_SEC; }
+double process_clock_us() { return 1e6 * std::clock() / CLOCKS_PER_SEC; }
+#else
+double clock_us(clockid_t clock) {
+    struct timespec ts;
+    if (clock_gettime(clock, &ts) != 0) {
+        return 0.0;
+    }
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+double thread_clock_us() { return clock_us(CLOCK_THREAD_CPUTIME_ID); }
+double process_clock_us() { return clock_us(CLOCK_PROCESS_CPUTIME_ID); }
+#endif
+
+std::ofstream open_report(const std::string& filename) {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        throw std::runtime_error("Cannot create profiling output file: " + filename);
+    }
+    out << std::fixed << std::setprecision(6);
+    return out;
+}
+
+struct Totals {
+    size_t count = 0;
+    double wall_us = 0.0;
+    double cpu_us = 0.0;
+};
+
+} // namespace
+
+Profiler::Profiler() : origin_(std::chrono::steady_clock::now()) {}
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+double Profiler::now_us() const {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin_).count();
+}
+
+void Profiler::record(ProfileSpan span) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    spans_.push_back(std::move(span));
+}
+
+unsigned int Profiler::current_thread_id() {
+    static std::atomic<unsigned int> next_id(0);
+    thread_local unsigned int id = next_id++;
+    return id;
+}
+
+double Profiler::thread_cpu_us() {
+    return thread_clock_us();
+}
+
+double Profiler::process_cpu_us() {
+    return process_clock_us();
+}
+
+void Profiler::write_profile(const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Keep phases in first-seen order so the report reads like the pipeline
+    std::vector<std::string> phase_order;
+    std::map<std::string, Totals> phases;
+    std::map<unsigned int, Totals> threads;
+    for (const auto& span : spans_) {
+        if (span.category == "phase") {
+            if (phases.find(span.name) == phases.end()) phase_order.push_back(span.name);
+            Totals& t = phases[span.name];
+            t.count++;
+            t.wall_us += span.wall_us;
+            t.cpu_us += span.cpu_us;
+        } else if (span.category == "worker") {
+            Totals& t = threads[span.thread_id];
+            t.count++;
+            t.wall_us += span.wall_us;
+            t.cpu_us += span.cpu_us;
+        }
+    }
+
+    std::ofstream out = open_report(filename);
+    out << "{\n";
+    out << "  \"wall_s\": " << now_us() / 1e6 << ",\n";
+    out << "  \"cpu_s\": " << process_cpu_us() / 1e6 << ",\n";
+
+    out << "  \"phases\": [";
+    for (size_t i = 0; i < phase_order.size(); ++i) {
+        const Totals& t = phases[phase_order[i]];
+        out << (i ? ",\n" : "\n") << "    {\"name\": \"" << json_escape(phase_order[i]) << "\""
+            << ", \"count\": " << t.count
+            << ", \"wall_s\": " << t.wall_us / 1e6
+            << ", \"cpu_s\": " << t.cpu_us / 1e6 << "}";
+    }
+    out << "\n  ],\n";
+
+    out << "  \"structures\": [";
+    bool first = true;
+    for (const auto& span : spans_) {
+        if (span.category != "structure") continue;
+        out << (first ? "\n" : ",\n") << "    {\"file\": \"" << json_escape(span.detail) << "\""
+            << ", \"wall_s\": " << span.wall_us / 1e6
+            << ", \"cpu_s\": " << span.cpu_us / 1e6 << "}";
+        first = false;
+    }
+    out << "\n  ],\n";
+
+    out << "  \"threads\": [";
+    first = true;
+    for (const auto& [id, t] : threads) {
+        out << (first ? "\n" : ",\n") << "    {\"thread\": " << id
+            << ", \"chunks\": " << t.count
+            << ", \"wall_s\": " << t.wall_us / 1e6
+            << ", \"cpu_s\": " << t.cpu_us / 1e6
+            << ", \"utilization\": " << (t.wall_us > 0.0 ? t.cpu_us / t.wall_us : 0.0) << "}";
+        first = false;
+    }
+    out << "\n  ]\n}\n";
+}
+
+void Profiler::write_trace(const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::ofstream out = open_report(filename);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+    std::map<unsigned int, bool> named_threads;
+    bool first = true;
+    for (const auto& span : spans_) {
+        if (!named_threads[span.thread_id]) {
+            named_threads[span.thread_id] = true;
+            out << (first ? "\n" : ",\n")
+                << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << span.thread_id
+                << ", \"args\": {\"name\": \"" << (span.thread_id == 0 ? "main" : "worker " + std::to_string(span.thread_id)) << "\"}}";
+            first = false;
+        }
+        // Structure spans are labelled with the file so they are identifiable on the timeline
+        const std::string& label = span.category == "structure" ? span.detail : span.name;
+        out << ",\n  {\"name\": \"" << json_escape(label) << "\""
+            << ", \"cat\": \"" << json_escape(span.category) << "\""
+            << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << span.thread_id
+            << ", \"ts\": " << span.start_us
+            << ", \"dur\": " << span.wall_us
+            << ", \"args\": {\"cpu_ms\": " << span.cpu_us / 1e3;
+        if (!span.detail.empty()) {
+            out << ", \"detail\": \"" << json_escape(span.detail) << "\"";
+        }
+        out << "}}";
+    }
+    out << "\n]}\n";
+}
+
+ScopedSpan::ScopedSpan(const char* name, const char* category, std::string detail)
+    : active_(Profiler::instance().enabled()), name_(name), category_(category) {
+    if (!active_) return;
+    detail_ = std::move(detail);
+    start_us_ = Profiler::instance().now_us();
+    start_cpu_us_ = std::string(category_) == "worker" ? Profiler::thread_cpu_us() : Profiler::process_cpu_us();
+}
+
+ScopedSpan::~ScopedSpan() {
+    if (!active_) return;
+    Profiler& profiler = Profiler::instance();
+
+    ProfileSpan span;
+    span.name = name_;
+    span.category = category_;
+    span.detail = std::move(detail_);
+    span.start_us = start_us_;
+    span.wall_us = profiler.now_us() - start_us_;
+    span.cpu_us = (span.category == "worker" ? Profiler::thread_cpu_us() : Profiler::process_cpu_us()) - start_cpu_us_;
+    span.thread_id = Profiler::current_thread_id();
+    profiler.record(std::move(span));
+}
+
+} // namespace amcheck
@@ -0,0 +1,446 @@
+#include "sat_solver.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace amcheck {
+
+namespace {
+
+constexpr double VARIABLE_DECAY = 0.95;
+constexpr double CLAUSE_DECAY = 0.999;
+constexpr size_t RESTART_UNIT = 100;       // conflicts per step of the Luby sequence
+constexpr size_t MIN_LEARNED_LIMIT = 2000;
+
+// x-th element (from 0) of the Luby sequence 1 1 2 1 1 2 4 1 1 2 ...
+size_t luby(size_t x) {
+    size_t size = 1;
+    size_t exponent = 0;
+    while (size < x + 1) {
+        ++exponent;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != x) {
+        size = (size - 1) >> 1;
+        --exponent;
+        x = x % size;
+    }
+    return static_cast<size_t>(1) << exponent;
+}
+
+} // namespace
+
+int SatSolver::new_variable() {
+    const int var = num_variables();
+    assigns_.push_back(0);
+    saved_phase_.push_back(-1);
+    levels_.push_back(0);
+    reasons_.push_back(NO_REASON);
+    seen_.push_back(0);
+    activity_.push_back(0.0);
+    heap_position_.push_back(-1);
+    watches_.emplace_back();
+    watches_.emplace_back();
+    heap_insert(var);
+    return var + 1;
+}
+
+void SatSolver::add_clause(const std::vector<int>& literals) {
+    std::vector<int> lits;
+    for (int literal : literals) {
+        if (literal == 0 || std::abs(literal) > num_variables()) {
+            throw std::invalid_argument("SAT clause refers to variable " + std::to_string(literal) +
+                                        " of " + std::to_string(num_variables()));
+        }
+        lits.push_back(internal(literal));
+    }
+    std::sort(lits.begin(), lits.end());
+    lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+    for (size_t i = 0; i + 1 < lits.size(); ++i) {
+        if ((lits[i] ^ 1) == lits[i + 1]) return;  // x or not x
+    }
+
+    std::vector<int> dimacs;
+    for (int lit : lits) dimacs.push_back(external(lit));
+    original_.push_back(std::move(dimacs));
+
+    if (lits.empty()) {
+        empty_clause_ = true;
+    } else if (lits.size() == 1) {
+        units_.push_back(lits[0]);
+    } else {
+        Clause clause;
+        clause.lits = std::move(lits);
+        clauses_.push_back(std::move(clause));
+        attach(static_cast<uint32_t>(clauses_.size() - 1));
+    }
+}
+
+bool SatSolver::value(int variable) const {
+    if (variable < 1 || static_cast<size_t>(variable) > model_.size()) {
+        throw std::out_of_range("No model value for SAT variable " + std::to_string(variable));
+    }
+    return model_[variable - 1];
+}
+
+void SatSolver::write_dimacs(std::ostream& out) const {
+    out << "p cnf " << num_variables() << " " << original_.size() << "\n";
+    for (const auto& clause : original_) {
+        for (int literal : clause) out << literal << " ";
+        out << "0\n";
+    }
+}
+
+void SatSolver::log_clause(const std::vector<int>& lits, bool deletion) {
+    if (!proof_) return;
+    if (deletion) *proof_ << "d ";
+    for (int lit : lits) *proof_ << external(lit) << " ";
+    *proof_ << "0\n";
+}
+
+void SatSolver::attach(uint32_t index) {
+    const Clause& clause = clauses_[index];
+    watches_[clause.lits[0]].push_back({index, clause.lits[1]});
+    watches_[clause.lits[1]].push_back({index, clause.lits[0]});
+}
+
+void SatSolver::enqueue(int lit, int reason) {
+    const int var = lit >> 1;
+    assigns_[var] = (lit & 1) ? -1 : 1;
+    levels_[var] = decision_level();
+    reasons_[var] = reason;
+    trail_.push_back(lit);
+}
+
+// Returns the index of a conflicting clause, or NO_REASON
+int SatSolver::propagate() {
+    int conflict = NO_REASON;
+    while (propagated_ < trail_.size()) {
+        const int false_lit = trail_[propagated_++] ^ 1;
+        ++stats_.propagations;
+        std::vector<Watch>& watches = watches_[false_lit];
+        size_t i = 0, j = 0;
+        while (i < watches.size()) {
+            const Watch watch = watches[i];
+            if (lit_value(watch.blocker) == 1) {
+                watches[j++] = watches[i++];
+                continue;
+            }
+            Clause& clause = clauses_[watch.clause];
+            ++i;
+            if (clause.deleted) continue;  // detached lazily
+
+            std::vector<int>& lits = clause.lits;
+            if (lits[0] == false_lit) std::swap(lits[0], lits[1]);
+            const int first = lits[0];
+            if (first != watch.blocker && lit_value(first) == 1) {
+                watches[j++] = {watch.clause, first};
+                continue;
+            }
+
+            bool moved = false;
+            for (size_t k = 2; k < lits.size(); ++k) {
+                if (lit_value(lits[k]) != -1) {
+                    std::swap(lits[1], lits[k]);
+                    watches_[lits[1]].push_back({watch.clause, first});
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) continue;
+
+            watches[j++] = {watch.clause, first};
+            if (lit_value(first) == -1) {
+                conflict = static_cast<int>(watch.clause);
+                propagated_ = trail_.size();
+                while (i < watches.size()) watches[j++] = watches[i++];
+            } else {
+                enqueue(first, static_cast<int>(watch.clause));
+            }
+        }
+        watches.resize(j);
+        if (conflict != NO_REASON) break;
+    }
+    return conflict;
+}
+
+// A literal of the learned clause is redundant when every other literal of its reason is
+// already in the clause or fixed at level 0
+bool SatSolver::redundant(int lit) const {
+    const int reason = reasons_[lit >> 1];
+    if (reason == NO_REASON) return false;
+    const std::vector<int>& lits = clauses_[reason].lits;
+    for (size_t k = 1; k < lits.size(); ++k) {
+        const int var = lits[k] >> 1;
+        if (!seen_[var] && levels_[var] > 0) return false;
+    }
+    return true;
+}
+
+void SatSolver::analyze(int conflict, std::vector<int>& learned, int& backtrack_level, int& lbd) {
+    learned.assign(1, 0);
+    int pending = 0;
+    int implied = -1;
+    size_t index = trail_.size();
+
+    do {
+        Clause& clause = clauses_[conflict];
+        if (clause.learned) bump_clause(clause);
+        for (size_t k = implied < 0 ? 0 : 1; k < clause.lits.size(); ++k) {
+            const int lit = clause.lits[k];
+            const int var = lit >> 1;
+            if (seen_[var] || levels_[var] == 0) continue;
+            bump_variable(var);
+            seen_[var] = 1;
+            if (levels_[var] >= decision_level()) {
+                ++pending;
+            } else {
+                learned.push_back(lit);
+            }
+        }
+        // Next literal of the current level on the trail, walking backwards
+        while (!seen_[trail_[--index] >> 1]) {}
+        implied = trail_[index];
+        conflict = reasons_[implied >> 1];
+        seen_[implied >> 1] = 0;
+        --pending;
+    } while (pending > 0);
+    learned[0] = implied ^ 1;
+
+    std::vector<int> marked(learned.begin() + 1, learned.end());
+    size_t kept = 1;
+    for (size_t k = 1; k < learned.size(); ++k) {
+        if (!redundant(learned[k])) learned[kept++] = learned[k];
+    }
+    learned.resize(kept);
+    for (int lit : marked) seen_[lit >> 1] = 0;
+
+    // The literal of the highest remaining level is watched next to the asserting one
+    backtrack_level = 0;
+    if (learned.size() > 1) {
+        size_t highest = 1;
+        for (size_t k = 2; k < learned.size(); ++k) {
+            if (levels_[learned[k] >> 1] > levels_[learned[highest] >> 1]) highest = k;
+        }
+        std::swap(learned[1], learned[highest]);
+        backtrack_level = levels_[learned[1] >> 1];
+    }
+
+    std::vector<int> levels;
+    for (int lit : learned) levels.push_back(levels_[lit >> 1]);
+    std::sort(levels.begin(), levels.end());
+    lbd = static_cast<int>(std::unique(levels.begin(), levels.end()) - levels.begin());
+}
+
+void SatSolver::backtrack(int level) {
+    if (decision_level() <= level) return;
+    for (size_t k = trail_.size(); k > trail_limits_[level]; --k) {
+        const int var = trail_[k - 1] >> 1;
+        saved_phase_[var] = assigns_[var];
+        assigns_[var] = 0;
+        reasons_[var] = NO_REASON;
+        heap_insert(var);
+    }
+    trail_.resize(trail_limits_[level]);
+    trail_limits_.resize(level);
+    propagated_ = trail_.size();
+}
+
+// Drops about half of the learned clauses, those with the most decision levels first; clauses
+// with LBD <= 2 and reasons of current assignments are kept
+void SatSolver::reduce_learned() {
+    std::vector<uint32_t> candidates;
+    for (uint32_t c = 0; c < clauses_.size(); ++c) {
+        if (clauses_[c].learned && !clauses_[c].deleted) candidates.push_back(c);
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b) {
+        if (clauses_[a].lbd != clauses_[b].lbd) return clauses_[a].lbd > clauses_[b].lbd;
+        return clauses_[a].activity < clauses_[b].activity;
+    });
+
+    for (size_t k = 0; k < candidates.size() / 2; ++k) {
+        Clause& clause = clauses_[candidates[k]];
+        if (clause.lbd <= 2) continue;
+        const int first = clause.lits[0];
+        if (lit_value(first) == 1 && reasons_[first >> 1] == static_cast<int>(candidates[k])) continue;
+        log_clause(clause.lits, true);
+        clause.deleted = true;
+        clause.lits.clear();
+        clause.lits.shrink_to_fit();
+        --learned_count_;
+        ++stats_.deleted;
+    }
+}
+
+void SatSolver::bump_variable(int var) {
+    activity_[var] += variable_increment_;
+    if (activity_[var] > 1e100) {
+        for (double& a : activity_) a *= 1e-100;
+        variable_increment_ *= 1e-100;
+    }
+    if (heap_position_[var] >= 0) heap_up(static_cast<size_t>(heap_position_[var]));
+}
+
+void SatSolver::bump_clause(Clause& clause) {
+    clause.activity += clause_increment_;
+    if (clause.activity > 1e20) {
+        for (Clause& c : clauses_) {
+            if (c.learned) c.activity *= 1e-20;
+        }
+        clause_increment_ *= 1e-20;
+    }
+}
+
+void SatSolver::heap_insert(int var) {
+    if (heap_position_[var] >= 0) return;
+    heap_position_[var] = static_cast<int>(heap_.size());
+    heap_.push_back(var);
+    heap_up(heap_.size() - 1);
+}
+
+void SatSolver::heap_up(size_t index) {
+    const int var = heap_[index];
+    while (index > 0) {
+        const size_t parent = (index - 1) / 2;
+        if (activity_[heap_[parent]] >= activity_[var]) break;
+        heap_[index] = heap_[parent];
+        heap_position_[heap_[index]] = static_cast<int>(index);
+        index = parent;
+    }
+    heap_[index] = var;
+    heap_position_[var] = static_cast<int>(index);
+}
+
+void SatSolver::heap_down(size_t index) {
+    const int var = heap_[index];
+    for (;;) {
+        size_t child = 2 * index + 1;
+        if (child >= heap_.size()) break;
+        if (child + 1 < heap_.size() && activity_[heap_[child + 1]] > activity_[heap_[child]]) ++child;
+        if (activity_[heap_[child]] <= activity_[var]) break;
+        heap_[index] = heap_[child];
+        heap_position_[heap_[index]] = static_cast<int>(index);
+        index = child;
+    }
+    heap_[index] = var;
+    heap_position_[var] = static_cast<int>(index);
+}
+
+int SatSolver::heap_pop() {
+    const int top = heap_.front();
+    heap_position_[top] = -1;
+    const int last = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) {
+        heap_[0] = last;
+        heap_position_[last] = 0;
+        heap_down(0);
+    }
+    return top;
+}
+
+SatSolver::Result SatSolver::solve(double time_budget_s) {
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    auto out_of_time = [&]() {
+        return time_budget_s > 0.0 &&
+               std::chrono::duration<double>(clock::now() - start).count() >= time_budget_s;
+    };
+    auto refute = [this]() {
+        empty_clause_ = true;
+        if (proof_) *proof_ << "0\n";
+        return Result::UNSATISFIABLE;
+    };
+
+    backtrack(0);
+    if (empty_clause_) return refute();
+    for (int unit : units_) {
+        if (lit_value(unit) == -1) return refute();
+        if (lit_value(unit) == 0) enqueue(unit, NO_REASON);
+    }
+    if (propagate() != NO_REASON) return refute();
+
+    size_t learned_limit = std::max(MIN_LEARNED_LIMIT, clauses_.size() / 3);
+    size_t restart_index = 0;
+    size_t restart_limit = RESTART_UNIT * luby(restart_index);
+    size_t conflicts_since_restart = 0;
+    std::vector<int> learned;
+
+    for (;;) {
+        const int conflict = propagate();
+        if (conflict != NO_REASON) {
+            ++stats_.conflicts;
+            ++conflicts_since_restart;
+            if (decision_level() == 0) return refute();
+
+            int backtrack_level = 0;
+            int lbd = 0;
+            analyze(conflict, learned, backtrack_level, lbd);
+            backtrack(backtrack_level);
+            log_clause(learned, false);
+            ++stats_.learned;
+            if (learned.size() == 1) {
+                enqueue(learned[0], NO_REASON);
+            } else {
+                Clause clause;
+                clause.lits = learned;
+                clause.learned = true;
+                clause.lbd = lbd;
+                clauses_.push_back(std::move(clause));
+                const uint32_t index = static_cast<uint32_t>(clauses_.size() - 1);
+                attach(index);
+                bump_clause(clauses_[index]);
+                ++learned_count_;
+                enqueue(learned[0], static_cast<int>(index));
+            }
+            variable_increment_ /= VARIABLE_DECAY;
+            clause_increment_ /= CLAUSE_DECAY;
+
+            if (stats_.conflicts % 256 == 0 && out_of_time()) {
+                backtrack(0);
+                return Result::UNKNOWN;
+            }
+            continue;
+        }
+
+        if (conflicts_since_restart >= restart_limit) {
+            backtrack(0);
+            ++stats_.restarts;
+            conflicts_since_restart = 0;
+            restart_limit = RESTART_UNIT * luby(++restart_index);
+        }
+        if (learned_count_ >= learned_limit) {
+            reduce_learned();
+            learned_limit += learned_limit / 10;
+        }
+
+        int next = -1;
+        while (!heap_.empty()) {
+            const int var = heap_pop();
+            if (assigns_[var] == 0) {
+                next = var;
+                break;
+            }
+        }
+        if (next < 0) {
+            model_.assign(assigns_.size(), false);
+            for (size_t v = 0; v < assigns_.size(); ++v) model_[v] = assigns_[v] == 1;
+            backtrack(0);
+            return Result::SATISFIABLE;
+        }
+
+        ++stats_.decisions;
+        if (stats_.decisions % 4096 == 0 && out_of_time()) {
+            heap_insert(next);
+            backtrack(0);
+            return Result::UNKNOWN;
+        }
+        trail_limits_.push_back(trail_.size());
+        enqueue(2 * next + (saved_phase_[next] == 1 ? 0 : 1), NO_REASON);
+    }
+}
+
+} // namespace amcheck
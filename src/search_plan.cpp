@@ -0,0 +1,350 @@
+#include "search_plan.h"
+#include "site_symmetry.h"
+#include "ternary_space.h"
+#include "spin_constraints.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+namespace amcheck {
+
+namespace {
+
+using Permutation = SitePermutation;
+
+// Cycle lengths of a permutation, grouped by the orbit of the sites they run through
+std::vector<std::vector<size_t>> cycles_by_orbit(const Permutation& p, const std::vector<size_t>& site_orbit,
+                                                 size_t num_orbits) {
+    std::vector<std::vector<size_t>> cycles(num_orbits);
+    std::vector<bool> seen(p.size(), false);
+    for (size_t start = 0; start < p.size(); ++start) {
+        if (seen[start]) continue;
+        size_t length = 0;
+        for (size_t i = start; !seen[i]; i = p[i]) {
+            seen[i] = true;
+            ++length;
+        }
+        cycles[site_orbit[start]].push_back(length);
+    }
+    return cycles;
+}
+
+// Balanced assignments that are constant on every cycle: for each orbit of even size k, the
+// number of ways to pick cycles holding exactly k/2 down spins. Single-site orbits are skipped
+// by the balance check, so both of their spins count.
+long double balanced_fixed_points(const std::vector<std::vector<size_t>>& cycles,
+                                  const std::vector<size_t>& orbit_sizes) {
+    long double total = 1;
+    for (size_t o = 0; o < orbit_sizes.size(); ++o) {
+        const size_t k = orbit_sizes[o];
+        if (k == 1) {
+            total *= 2;
+            continue;
+        }
+        if (k % 2 != 0) return 0;
+
+        std::vector<long double> ways(k / 2 + 1, 0);
+        ways[0] = 1;
+        for (size_t length : cycles[o]) {
+            for (size_t s = k / 2; s >= length; --s) {
+                ways[s] += ways[s - length];
+                if (s == length) break;
+            }
+        }
+        total *= ways[k / 2];
+    }
+    return total;
+}
+
+std::string format_count(long double value) {
+    std::ostringstream out;
+    if (value < 1e15L) {
+        out << std::fixed << std::setprecision(0) << value;
+    } else {
+        out << std::scientific << std::setprecision(3) << value;
+    }
+    return out.str();
+}
+
+// "table/gray" for the Gray-code walk, the engine name otherwise
+std::string engine_label(const EngineEstimate& estimate) {
+    return engine_to_string(estimate.engine) + (estimate.gray_walk ? "/gray" : "");
+}
+
+std::string format_duration(double seconds) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    if (!std::isfinite(seconds)) {
+        out << "n/a";
+    } else if (seconds < 120.0) {
+        out << seconds << " s";
+    } else if (seconds < 7200.0) {
+        out << seconds / 60.0 << " min";
+    } else if (seconds < 172800.0) {
+        out << seconds / 3600.0 << " h";
+    } else if (seconds < 3.15e9) {
+        out << seconds / 86400.0 << " days";
+    } else {
+        out << std::scientific << std::setprecision(2) << seconds / 3.15e7 << " years";
+    }
+    return out.str();
+}
+
+} // namespace
+
+SearchPlan plan_spin_search(
+    const CrystalStructure& structure,
+    double tolerance,
+    const SearchOptions& options,
+    double calibration_s
+) {
+    ScopedSpan span("plan");
+    SearchPlan plan;
+    const std::vector<size_t> magnetic_indices = get_magnetic_atom_indices(structure, options.magnetic);
+    const std::vector<int> numbers = orbit_numbers(structure);
+    const size_t n = magnetic_indices.size();
+
+    plan.num_atoms = structure.atoms.size();
+    plan.num_magnetic_atoms = n;
+    plan.symmetry_operations = structure.symmetry_operations.size();
+    plan.time_budget_s = options.time_budget_s;
+    plan.magnetic_selection = describe_magnetic_selection(options.magnetic);
+    plan.threads = resolve_thread_count(options.num_threads);
+
+    // Orbit decomposition of the magnetic sites, in ascending orbit label like is_altermagnet()
+    std::vector<size_t> site_orbit(n);
+    for (size_t i = 0; i < n; ++i) {
+        const int number = numbers[magnetic_indices[i]];
+        auto it = std::find_if(plan.orbits.begin(), plan.orbits.end(),
+                               [number](const MagneticOrbitPlan& o) { return o.orbit_number == number; });
+        if (it == plan.orbits.end()) {
+            MagneticOrbitPlan orbit;
+            orbit.orbit_number = number;
+            orbit.first_atom = magnetic_indices[i];
+            orbit.element = structure.atoms[magnetic_indices[i]].chemical_symbol;
+            plan.orbits.push_back(orbit);
+            it = plan.orbits.end() - 1;
+        }
+        it->sites.push_back(i);
+    }
+    std::sort(plan.orbits.begin(), plan.orbits.end(),
+              [](const MagneticOrbitPlan& a, const MagneticOrbitPlan& b) { return a.orbit_number < b.orbit_number; });
+    std::vector<size_t> orbit_sizes;
+    for (size_t o = 0; o < plan.orbits.size(); ++o) {
+        orbit_sizes.push_back(plan.orbits[o].sites.size());
+        for (size_t site : plan.orbits[o].sites) site_orbit[site] = o;
+    }
+
+    plan.raw_configurations = std::ldexp(1.0L, static_cast<int>(n));
+    const size_t space_size = n < 64 ? static_cast<size_t>(1) << n : 0;
+    plan.planned_configurations = options.max_configurations > 0 && (space_size == 0 || options.max_configurations < space_size)
+        ? options.max_configurations : space_size;
+    // Both spaces are built once; the calibration runs below reuse them
+    std::unique_ptr<ConstrainedSpace> constrained;
+    if (!options.constraints.empty() && !options.ternary) {
+        constrained = std::make_unique<ConstrainedSpace>(structure, magnetic_indices, options.constraints);
+        plan.constraints = constrained->describe();
+        plan.constrained_configurations = static_cast<long double>(constrained->size());
+        plan.planned_configurations = options.max_configurations > 0
+            ? std::min(constrained->size(), options.max_configurations) : constrained->size();
+    }
+    std::unique_ptr<TernarySpace> ternary;
+    if (options.ternary && n > 0) {
+        ternary = std::make_unique<TernarySpace>(structure, magnetic_indices, tolerance, options.symmetry_dedup);
+        plan.ternary = true;
+        plan.ternary_raw = ternary->raw_size();
+        plan.ternary_balanced = static_cast<long double>(ternary->size());
+        plan.ternary_dedup = ternary->symmetry_dedup();
+        plan.planned_configurations = options.max_configurations > 0
+            ? std::min(ternary->size(), options.max_configurations) : ternary->size();
+    }
+
+    // Per-orbit balanced counts are the identity permutation's fixed points, orbit by orbit
+    Permutation identity(n);
+    for (size_t i = 0; i < n; ++i) identity[i] = static_cast<uint32_t>(i);
+    const auto identity_cycles = cycles_by_orbit(identity, site_orbit, plan.orbits.size());
+    for (size_t o = 0; o < plan.orbits.size(); ++o) {
+        plan.orbits[o].balanced_choices = balanced_fixed_points({identity_cycles[o]}, {orbit_sizes[o]});
+    }
+    plan.balanced_configurations = balanced_fixed_points(identity_cycles, orbit_sizes);
+
+    // Site permutation group: the operations' permutations closed under composition, so Burnside's
+    // lemma applies even when the operation list is incomplete
+    const SitePermutationGroup site_group = magnetic_site_group(structure, magnetic_indices, tolerance);
+    const std::vector<Permutation>& group = site_group.elements;
+    plan.group_truncated = site_group.truncated;
+    plan.permutation_group_order = group.size();
+
+    // Burnside: distinct patterns = average number of patterns each group element fixes. A
+    // pattern fixed by "permute, then reverse every spin" alternates along each cycle, so every
+    // cycle must have even length; such patterns are automatically balanced.
+    long double raw_sum = 0, balanced_sum = 0, flipped_sum = 0;
+    for (const auto& g : group) {
+        const auto cycles = cycles_by_orbit(g, site_orbit, plan.orbits.size());
+        size_t num_cycles = 0;
+        bool all_even = true;
+        for (const auto& orbit_cycles : cycles) {
+            num_cycles += orbit_cycles.size();
+            for (size_t length : orbit_cycles) all_even = all_even && length % 2 == 0;
+        }
+        raw_sum += std::ldexp(1.0L, static_cast<int>(num_cycles));
+        balanced_sum += balanced_fixed_points(cycles, orbit_sizes);
+        if (all_even) flipped_sum += std::ldexp(1.0L, static_cast<int>(num_cycles));
+    }
+    const long double order = static_cast<long double>(group.size());
+    plan.distinct_raw = raw_sum / order;
+    plan.distinct_balanced = balanced_sum / order;
+    plan.distinct_balanced_with_flip = (balanced_sum + flipped_sum) / (2 * order);
+
+    // A full table search walks the ids in Gray-code order (one site flip and one orbit re-check
+    // per step), which spread order cannot time; it gets its own calibration. A search that may
+    // stop early runs in spread order, like search_all_spin_configurations() does.
+    const bool gray_walk = options.engine == SearchEngine::TABLE && options.gray_walk && !options.ternary &&
+                           options.constraints.empty() && options.tolerances.empty() && !options.spread_order &&
+                           options.time_budget_s <= 0.0 && space_size != 0 &&
+                           plan.planned_configurations == space_size;
+
+    // Calibration: the real search kernel on this structure, single thread, in spread order so
+    // the sample is not biased toward the first sites (the Gray-code walk needs natural order)
+    std::vector<EngineEstimate> variants(2);
+    variants[0].engine = SearchEngine::TABLE;
+    variants[1].engine = SearchEngine::REFERENCE;
+    if (gray_walk) {
+        variants.insert(variants.begin(), variants[0]);
+        variants[0].gray_walk = true;
+    }
+    for (EngineEstimate estimate : variants) {
+        if (n == 0) {
+            estimate.error = "no magnetic atoms";
+        } else {
+            try {
+                ScopedSpan calibration_span("calibration", "phase", engine_label(estimate));
+                SearchOptions calibration;
+                calibration.engine = estimate.engine;
+                calibration.num_threads = 1;
+                calibration.spread_order = !estimate.gray_walk;
+                calibration.gray_walk = estimate.gray_walk;
+                calibration.time_budget_s = calibration_s;
+                calibration.progress_interval_s = 3600.0;  // the reporter only enforces the budget
+                calibration.ternary = options.ternary;
+                calibration.symmetry_dedup = options.symmetry_dedup;
+                calibration.constraints = options.constraints;
+
+                SearchProgress final_progress;
+                run_spin_search(structure, magnetic_indices, tolerance, calibration, nullptr,
+                                [&final_progress](const SearchProgress& progress) {
+                                    if (progress.finished) final_progress = progress;
+                                },
+                                ternary.get(), constrained.get());
+                estimate.calibration_configs = final_progress.completed;
+                if (final_progress.elapsed_s > 0.0) {
+                    estimate.configs_per_second = final_progress.completed / final_progress.elapsed_s;
+                }
+            } catch (const std::exception& e) {
+                estimate.error = e.what();
+            }
+        }
+        plan.engines.push_back(estimate);
+    }
+
+    return plan;
+}
+
+void print_search_plan(const SearchPlan& plan, std::ostream& out) {
+    out << "\n=======================================================================\n";
+    out << "                    SEARCH PLAN (DRY RUN, NOTHING IS SEARCHED)\n";
+    out << "=======================================================================\n";
+    out << "Structure: " << plan.num_atoms << " total atoms (" << plan.num_magnetic_atoms << " magnetic: "
+        << plan.magnetic_selection << ")\n";
+    out << "Symmetry operations: " << plan.symmetry_operations << " (site permutation group order "
+        << plan.permutation_group_order << (plan.group_truncated ? ", truncated" : "") << ")\n";
+
+    out << "\nMagnetic orbits:\n";
+    out << "-----------------------------------------------------------------------\n";
+    out << "Orbit  First atom  Element  Sites  Balanced assignments\n";
+    for (const auto& orbit : plan.orbits) {
+        out << std::setw(5) << orbit.orbit_number << "  " << std::setw(10) << (orbit.first_atom + 1) << "  "
+            << std::setw(7) << orbit.element << "  "
+            << std::setw(5) << orbit.sites.size() << "  " << format_count(orbit.balanced_choices)
+            << (orbit.sites.size() == 1 ? " (single site, not checked)" : "")
+            << (orbit.sites.size() > 1 && orbit.sites.size() % 2 != 0 ? " (odd orbit, never balanced)" : "")
+            << "\n";
+    }
+    out << "-----------------------------------------------------------------------\n";
+
+    out << "\nConfiguration counts:\n";
+    auto count_line = [&out](const std::string& label, long double value) {
+        out << "  " << std::left << std::setw(38) << label << std::right << format_count(value) << "\n";
+    };
+    count_line("Raw (2^" + std::to_string(plan.num_magnetic_atoms) + "):", plan.raw_configurations);
+    count_line("Balanced (up = down in every orbit):", plan.balanced_configurations);
+    count_line("Symmetry-distinct raw:", plan.distinct_raw);
+    count_line("Symmetry-distinct balanced:", plan.distinct_balanced);
+    count_line("... also identifying spin reversal:", plan.distinct_balanced_with_flip);
+    if (plan.group_truncated) {
+        out << "  (group closure hit its size limit; the distinct counts are upper bounds)\n";
+    }
+    if (!plan.constraints.empty()) {
+        count_line("Allowed by the constraints:", plan.constrained_configurations);
+        out << "  (" << plan.constraints << ")\n";
+    }
+    if (plan.ternary) {
+        count_line("Ternary raw (3^" + std::to_string(plan.num_magnetic_atoms) + "):", plan.ternary_raw);
+        count_line("Ternary balanced (enumerated):", plan.ternary_balanced);
+    }
+
+    out << "\nPlanned configurations: ";
+    if (plan.planned_configurations == 0) {
+        out << "none without --max-configs (exhaustive search supports at most 63 magnetic atoms)\n";
+    } else {
+        out << plan.planned_configurations
+            << (static_cast<long double>(plan.planned_configurations) <
+                (plan.ternary ? plan.ternary_balanced
+                 : !plan.constraints.empty() ? plan.constrained_configurations
+                 : plan.raw_configurations) ? " (--max-configs)" : "")
+            << ", " << plan.threads << " worker thread(s)\n";
+    }
+
+    out << "\nEstimated runtime (single-thread calibration on this machine, linear thread scaling):\n";
+    out << "-----------------------------------------------------------------------\n";
+    out << "Engine       configs/s/thread  1 thread      " << std::setw(3) << plan.threads << " thread(s)  CPU-hours\n";
+    for (const auto& estimate : plan.engines) {
+        out << std::left << std::setw(11) << engine_label(estimate) << std::right << "  ";
+        if (!estimate.error.empty() || estimate.configs_per_second <= 0.0) {
+            out << "not available" << (estimate.error.empty() ? "" : ": " + estimate.error) << "\n";
+            continue;
+        }
+        const double serial_s = plan.planned_configurations / estimate.configs_per_second;
+        const double parallel_s = serial_s / plan.threads;
+        out << std::setw(16) << std::fixed << std::setprecision(0) << estimate.configs_per_second << "  "
+            << std::left << std::setw(12) << format_duration(serial_s) << "  "
+            << std::setw(12) << format_duration(parallel_s) << std::right << "  "
+            << std::setprecision(3) << serial_s / 3600.0;
+        if (plan.time_budget_s > 0.0 && parallel_s > plan.time_budget_s) {
+            out << "  (--time-budget covers ~" << std::setprecision(1)
+                << 100.0 * plan.time_budget_s / parallel_s << "%)";
+        }
+        out << "\n";
+    }
+    out << "-----------------------------------------------------------------------\n";
+    if (!plan.engines.empty() && plan.engines.front().gray_walk) {
+        out << "This full table search runs the Gray-code walk (table/gray); table times the spread\n";
+        out << "order that --max-configs and --time-budget searches use.\n";
+    }
+    if (plan.ternary) {
+        out << "The ternary search enumerates only balanced patterns"
+            << (plan.ternary_dedup ? " and evaluates one per symmetry class" : "") << ".\n";
+    } else if (!plan.constraints.empty()) {
+        out << "Only the configurations allowed by the constraints are enumerated.\n";
+    } else {
+        out << "Every engine enumerates the raw space; the balanced and symmetry-distinct counts\n";
+        out << "show how far a reduced enumeration could shrink it.\n";
+    }
+    out << "=======================================================================\n";
+}
+
+} // namespace amcheck
@@ -0,0 +1,356 @@
+#include "serve_stdio.h"
+#include "altermagnet_checker.h"
+#include "json_reader.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace amcheck {
+
+namespace {
+
+// Largest accepted "threads" and "max_configs"; a double holds whole numbers exactly up to 2^53
+constexpr double MAX_REQUEST_THREADS = 1024;
+constexpr double MAX_REQUEST_CONFIGURATIONS = 9007199254740992.0;
+
+// A structure ready for checks: parsed, symmetry analyzed and with its orbit tables built
+struct PreparedStructure {
+    CrystalStructure structure;
+    std::unique_ptr<AltermagnetChecker> checker;
+};
+
+// Bounded map from request source to prepared structure; the oldest entry is dropped first
+class StructureCache {
+public:
+    explicit StructureCache(size_t capacity) : capacity_(capacity) {}
+
+    std::shared_ptr<const PreparedStructure> get(
+        const std::string& key,
+        const std::function<std::shared_ptr<const PreparedStructure>()>& build
+    ) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto it = entries_.find(key);
+            if (it != entries_.end()) return it->second;
+        }
+        // Built outside the lock; two requests racing on a new key both build, one copy is kept
+        std::shared_ptr<const PreparedStructure> prepared = build();
+        if (capacity_ == 0) return prepared;
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto inserted = entries_.emplace(key, prepared);
+        if (!inserted.second) return inserted.first->second;
+        order_.push_back(key);
+        if (order_.size() > capacity_) {
+            entries_.erase(order_.front());
+            order_.pop_front();
+        }
+        return prepared;
+    }
+
+private:
+    size_t capacity_;
+    std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<const PreparedStructure>> entries_;
+    std::deque<std::string> order_;
+};
+
+struct ServeContext {
+    const ServeOptions& options;
+    StructureCache cache;
+};
+
+double number_member(const JsonValue& request, const char* key, double fallback) {
+    const JsonValue* value = request.find(key);
+    if (!value) return fallback;
+    if (!value->is_number()) throw std::invalid_argument(std::string("\"") + key + "\" must be a number");
+    return value->as_number();
+}
+
+// A whole number in [0, limit]; anything else (negative, fractional, huge) is rejected rather
+// than converted to an integer type
+double count_member(const JsonValue& request, const char* key, double fallback, double limit) {
+    if (!request.find(key)) return fallback;
+    const double value = number_member(request, key, fallback);
+    if (!(value >= 0.0 && value <= limit) || value != std::floor(value)) {
+        std::ostringstream message;
+        message << "\"" << key << "\" must be a whole number from 0 to " << std::fixed << std::setprecision(0) << limit;
+        throw std::invalid_argument(message.str());
+    }
+    return value;
+}
+
+std::vector<std::string> string_list(const JsonValue& value) {
+    std::vector<std::string> items;
+    if (value.is_string()) {
+        std::stringstream ss(value.as_string());
+        for (std::string item; std::getline(ss, item, ',');) {
+            if (!item.empty()) items.push_back(item);
+        }
+    } else {
+        for (const JsonValue& item : value.as_array()) items.push_back(item.as_string());
+    }
+    return items;
+}
+
+Vector3d vector_member(const JsonValue& value, const char* what) {
+    const auto& row = value.as_array();
+    if (row.size() != 3) throw std::invalid_argument(std::string(what) + " rows need three numbers");
+    return Vector3d(row[0].as_number(), row[1].as_number(), row[2].as_number());
+}
+
+// The request's structure source, read into structure, and a key identifying it for the cache
+std::string load_structure(const JsonValue& request, CrystalStructure* structure) {
+    if (const JsonValue* path = request.find("structure")) {
+        const std::string& filename = path->as_string();
+        struct stat info;
+        if (stat(filename.c_str(), &info) != 0) {
+            throw std::runtime_error("Cannot open file: " + filename);
+        }
+        // The modification time is part of the key, so an edited file is read again
+        if (structure) structure->read_from_file(filename);
+        return "file:" + filename + "@" + std::to_string(static_cast<long long>(info.st_mtime)) +
+               ":" + std::to_string(static_cast<long long>(info.st_size));
+    }
+    if (const JsonValue* text = request.find("poscar")) {
+        if (structure) {
+            std::istringstream in(text->as_string());
+            structure->read_from_stream(in);
+        }
+        return "poscar:" + text->as_string();
+    }
+    const JsonValue* lattice = request.find("lattice");
+    const JsonValue* positions = request.find("positions");
+    const JsonValue* symbols = request.find("symbols");
+    if (!lattice || !positions || !symbols) {
+        throw std::invalid_argument("Request needs \"structure\", \"poscar\" or \"lattice\", \"positions\" and \"symbols\"");
+    }
+    if (structure) {
+        const auto& rows = lattice->as_array();
+        if (rows.size() != 3) throw std::invalid_argument("lattice needs three rows");
+        for (int i = 0; i < 3; ++i) structure->cell.row(i) = vector_member(rows[i], "lattice").transpose();
+        const auto& sites = positions->as_array();
+        const auto& names = symbols->as_array();
+        if (sites.size() != names.size()) {
+            throw std::invalid_argument("positions and symbols differ in length");
+        }
+        std::map<std::string, int> orbit_of_element;
+        for (size_t i = 0; i < sites.size(); ++i) {
+            const std::string& symbol = names[i].as_string();
+            structure->atoms.emplace_back(vector_member(sites[i], "positions"), symbol,
+                                          structure->get_atomic_number(symbol));
+            // One orbit per element until symmetry is analyzed, as for POSCAR input
+            const auto inserted = orbit_of_element.emplace(symbol, static_cast<int>(orbit_of_element.size()));
+            structure->equivalent_atoms.push_back(inserted.first->second);
+        }
+    }
+    return "arrays:" + lattice->to_json() + positions->to_json() + symbols->to_json();
+}
+
+std::shared_ptr<const PreparedStructure> prepare(const JsonValue& request, ServeContext& context,
+                                                 double symprec, double tolerance) {
+    std::ostringstream key;
+    key.precision(17);
+    key << symprec << "|" << tolerance << "|" << load_structure(request, nullptr);
+    return context.cache.get(key.str(), [&] {
+        auto prepared = std::make_shared<PreparedStructure>();
+        load_structure(request, &prepared->structure);
+        if (prepared->structure.atoms.empty()) throw std::invalid_argument("Structure has no atoms");
+        analyze_symmetry(prepared->structure, symprec);
+        prepared->checker = std::make_unique<AltermagnetChecker>(prepared->structure, tolerance);
+        return std::shared_ptr<const PreparedStructure>(std::move(prepared));
+    });
+}
+
+// A pattern as a spin string or an array of 1/-1/0 or spin names, per atom or per magnetic site
+std::vector<SpinType> read_pattern(const JsonValue& value, size_t num_atoms,
+                                   const std::vector<size_t>& magnetic_indices) {
+    std::vector<SpinType> parsed;
+    if (value.is_string()) {
+        parsed = parse_spin_pattern(value.as_string());
+    } else {
+        for (const JsonValue& item : value.as_array()) {
+            if (item.is_number()) {
+                const double spin = item.as_number();
+                if (spin != 1.0 && spin != -1.0 && spin != 0.0) {
+                    throw std::invalid_argument("Numeric spins must be 1, -1 or 0");
+                }
+                parsed.push_back(spin > 0 ? SpinType::UP : spin < 0 ? SpinType::DOWN : SpinType::NONE);
+            } else {
+                parsed.push_back(string_to_spin(item.as_string()));
+            }
+        }
+    }
+
+    if (parsed.size() == num_atoms) return parsed;
+    if (parsed.size() == magnetic_indices.size() && !parsed.empty()) {
+        std::vector<SpinType> spins(num_atoms, SpinType::NONE);
+        for (size_t i = 0; i < magnetic_indices.size(); ++i) spins[magnetic_indices[i]] = parsed[i];
+        return spins;
+    }
+    std::string expected = std::to_string(num_atoms) + " (all atoms)";
+    if (magnetic_indices.size() != num_atoms) {
+        expected += " or " + std::to_string(magnetic_indices.size()) + " (magnetic atoms)";
+    }
+    throw std::invalid_argument("Pattern has " + std::to_string(parsed.size()) + " spins; expected " + expected);
+}
+
+std::string pattern_string(const std::vector<SpinType>& spins) {
+    std::string text;
+    for (size_t i = 0; i < spins.size(); ++i) {
+        if (i) text += ' ';
+        text += spin_to_string(spins[i]);
+    }
+    return text;
+}
+
+// Search settings: the command line defaults, overridden by the request's "search" object
+SearchOptions search_options(const JsonValue& search, const ServeContext& context,
+                             const MagneticSelection& magnetic) {
+    SearchOptions options = context.options.search;
+    options.magnetic = magnetic;
+    options.quiet = true;
+    options.status_file.clear();
+    options.on_large = LargeSearchPolicy::EXHAUSTIVE;
+    // Searches run inside one pool worker unless the request asks for more threads
+    options.num_threads = 1;
+    if (!search.is_object()) return options;
+
+    options.num_threads = static_cast<unsigned int>(count_member(search, "threads", 1, MAX_REQUEST_THREADS));
+    options.max_configurations = static_cast<size_t>(count_member(
+        search, "max_configs", static_cast<double>(options.max_configurations), MAX_REQUEST_CONFIGURATIONS));
+    options.time_budget_s = number_member(search, "time_budget", options.time_budget_s);
+    if (!(options.time_budget_s >= 0.0 && std::isfinite(options.time_budget_s))) {
+        throw std::invalid_argument("\"time_budget\" must be a non-negative number of seconds");
+    }
+    if (const JsonValue* spread = search.find("spread")) options.spread_order = spread->as_bool();
+    if (const JsonValue* engine = search.find("engine")) options.engine = string_to_engine(engine->as_string());
+    if (const JsonValue* constraints = search.find("constraints")) options.constraints = constraints->as_string();
+    if (const JsonValue* ternary = search.find("ternary")) options.ternary = ternary->as_bool();
+    if (const JsonValue* dedup = search.find("dedup")) options.symmetry_dedup = dedup->as_bool();
+    return options;
+}
+
+// Response members after "id", without the surrounding braces
+std::string handle_request(const JsonValue& request, ServeContext& context) {
+    if (!request.is_object()) throw std::invalid_argument("Request must be a JSON object");
+
+    const double symprec = number_member(request, "symprec", context.options.symprec);
+    const double tolerance = number_member(request, "tolerance", context.options.tolerance);
+    MagneticSelection magnetic = context.options.search.magnetic;
+    if (const JsonValue* species = request.find("magnetic")) magnetic.species = string_list(*species);
+
+    const auto prepared = prepare(request, context, symprec, tolerance);
+    const CrystalStructure& structure = prepared->structure;
+    const size_t num_atoms = structure.atoms.size();
+    const std::vector<size_t> magnetic_indices = get_magnetic_atom_indices(structure, magnetic);
+
+    std::ostringstream out;
+    out << "\"ok\":true";
+
+    if (const JsonValue* spins = request.find("spins")) {
+        const CheckOutcome outcome = prepared->checker->evaluate(read_pattern(*spins, num_atoms, magnetic_indices));
+        out << ",\"verdict\":\"" << outcome_to_string(outcome) << "\"";
+    } else if (const JsonValue* batch = request.find("batch")) {
+        out << ",\"verdicts\":[";
+        const auto& patterns = batch->as_array();
+        for (size_t i = 0; i < patterns.size(); ++i) {
+            const CheckOutcome outcome = prepared->checker->evaluate(read_pattern(patterns[i], num_atoms, magnetic_indices));
+            out << (i ? "," : "") << "\"" << outcome_to_string(outcome) << "\"";
+        }
+        out << "]";
+    } else if (const JsonValue* search = request.find("search")) {
+        if (search->is_bool() && !search->as_bool()) throw std::invalid_argument("\"search\" must be true or an object");
+        const SearchOptions options = search_options(*search, context, magnetic);
+        SearchProgress last;
+        const std::vector<SpinConfiguration> found = run_spin_search(
+            structure, magnetic_indices, tolerance, options, nullptr,
+            [&](const SearchProgress& progress) {
+                if (progress.finished) last = progress;
+            });
+        out << ",\"magnetic_sites\":" << magnetic_indices.size()
+            << ",\"total\":" << last.total << ",\"completed\":" << last.completed
+            << ",\"found\":" << found.size()
+            << ",\"budget_exhausted\":" << (last.budget_exhausted ? "true" : "false")
+            << ",\"elapsed_s\":" << last.elapsed_s
+            << ",\"id_base\":" << (options.ternary ? 3 : 2)
+            << ",\"configurations\":[";
+        for (size_t i = 0; i < found.size(); ++i) {
+            out << (i ? "," : "") << "{\"id\":" << found[i].configuration_id
+                << ",\"spins\":\"" << pattern_string(found[i].spins) << "\"}";
+        }
+        out << "]";
+    } else {
+        out << ",\"atoms\":" << num_atoms << ",\"operations\":" << structure.symmetry_operations.size()
+            << ",\"equivalent_atoms\":[";
+        for (size_t i = 0; i < num_atoms; ++i) out << (i ? "," : "") << structure.equivalent_atoms[i];
+        out << "],\"magnetic_atoms\":[";
+        for (size_t i = 0; i < magnetic_indices.size(); ++i) out << (i ? "," : "") << magnetic_indices[i] + 1;
+        out << "]";
+    }
+    return out.str();
+}
+
+} // namespace
+
+size_t serve_json_lines(std::istream& in, std::ostream& out, const ServeOptions& options) {
+    ServeContext context{options, StructureCache(options.max_cached_structures)};
+    std::mutex out_mutex;
+    std::atomic<size_t> failures(0);
+
+    auto respond = [&](const std::string& line) {
+        std::lock_guard<std::mutex> lock(out_mutex);
+        out << line << '\n';
+        out.flush();
+    };
+    auto fail = [&](const std::string& id, const std::string& message) {
+        failures.fetch_add(1, std::memory_order_relaxed);
+        respond("{\"id\":" + id + ",\"ok\":false,\"error\":\"" + json_escape(message) + "\"}");
+    };
+
+    // std::cin flushes its tied std::cout before every read; from the reader thread that would
+    // race with the workers' writes, which are only serialized by out_mutex
+    std::ostream* const tied = in.tie(nullptr);
+
+    const size_t num_threads = resolve_thread_count(options.search.num_threads);
+    WorkerPool pool(num_threads, 64 * num_threads);
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        auto request = std::make_shared<JsonValue>();
+        try {
+            *request = JsonValue::parse(line);
+        } catch (const std::exception& e) {
+            fail("null", e.what());
+            continue;
+        }
+        const JsonValue* id_value = request->find("id");
+        const std::string id = id_value ? id_value->to_json() : "null";
+
+        pool.submit([&, request, id] {
+            try {
+                respond("{\"id\":" + id + "," + handle_request(*request, context) + "}");
+            } catch (const std::exception& e) {
+                fail(id, e.what());
+            }
+        });
+    }
+    pool.finish();
+    in.tie(tied);
+    return failures.load();
+}
+
+} // namespace amcheck
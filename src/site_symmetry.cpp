@@ -0,0 +1,263 @@
+#include "site_symmetry.h"
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+
+namespace amcheck {
+
+namespace {
+
+// Image of every magnetic site under one operation, or an empty vector when the operation does
+// not permute the magnetic sites within their orbits (possible with the fallback operations)
+SitePermutation site_permutation(
+    const SymmetryOperation& op,
+    const std::vector<Vector3d>& positions,
+    const std::vector<size_t>& magnetic_indices,
+    const std::vector<int>& equiv_atoms,
+    double tol
+) {
+    const auto& [R, t] = op;
+    const size_t n = magnetic_indices.size();
+    SitePermutation image(n);
+    std::vector<bool> taken(n, false);
+
+    for (size_t i = 0; i < n; ++i) {
+        const Vector3d& pi = positions[magnetic_indices[i]];
+        bool found = false;
+        for (size_t j = 0; j < n && !found; ++j) {
+            if (taken[j] || equiv_atoms[magnetic_indices[j]] != equiv_atoms[magnetic_indices[i]]) continue;
+            Vector3d dp = R * pi + t - positions[magnetic_indices[j]];
+            dp = bring_in_cell(dp, tol);
+            if (dp.norm() < tol) {
+                image[i] = static_cast<uint32_t>(j);
+                taken[j] = true;
+                found = true;
+            }
+        }
+        if (!found) return SitePermutation();
+    }
+    return image;
+}
+
+} // namespace
+
+SitePermutationGroup magnetic_site_group(
+    const CrystalStructure& structure,
+    const std::vector<size_t>& magnetic_indices,
+    double tolerance,
+    size_t max_order
+) {
+    const size_t n = magnetic_indices.size();
+    const std::vector<Vector3d> positions = structure.get_all_scaled_positions();
+
+    SitePermutation identity(n);
+    for (size_t i = 0; i < n; ++i) identity[i] = static_cast<uint32_t>(i);
+
+    std::set<SitePermutation> generators;
+    for (const auto& op : structure.symmetry_operations) {
+        SitePermutation p = site_permutation(op, positions, magnetic_indices, structure.equivalent_atoms, tolerance);
+        if (!p.empty()) generators.insert(std::move(p));
+    }
+    generators.insert(identity);
+
+    SitePermutationGroup result;
+    result.elements.push_back(identity);
+    std::set<SitePermutation> seen{identity};
+    std::deque<SitePermutation> pending{identity};
+    while (!pending.empty() && !result.truncated) {
+        const SitePermutation current = pending.front();
+        pending.pop_front();
+        for (const auto& g : generators) {
+            SitePermutation product(n);
+            for (size_t i = 0; i < n; ++i) product[i] = g[current[i]];
+            if (seen.insert(product).second) {
+                result.elements.push_back(product);
+                pending.push_back(std::move(product));
+                if (result.elements.size() >= max_order) {
+                    result.truncated = true;
+                    break;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+bool operations_form_group(const std::vector<SymmetryOperation>& symops, double tolerance) {
+    for (const auto& [R1, t1] : symops) {
+        for (const auto& [R2, t2] : symops) {
+            const Matrix3d R = R1 * R2;
+            const Vector3d t = R1 * t2 + t1;
+            const bool known = std::any_of(symops.begin(), symops.end(), [&](const SymmetryOperation& op) {
+                return (op.first - R).norm() < tolerance && bring_in_cell(op.second - t, tolerance).norm() < tolerance;
+            });
+            if (!known) return false;
+        }
+    }
+    return true;
+}
+
+bool verdicts_invariant(
+    const AltermagnetChecker& checker,
+    const std::vector<SymmetryOperation>& symops,
+    const std::vector<size_t>& magnetic_indices,
+    double tolerance
+) {
+    // Magnetic sites as (orbit, position in orbit_sites())
+    std::vector<std::vector<size_t>> magnetic(checker.num_orbits());
+    std::vector<bool> is_magnetic;
+    for (size_t atom : magnetic_indices) {
+        if (atom >= is_magnetic.size()) is_magnetic.resize(atom + 1, false);
+        is_magnetic[atom] = true;
+    }
+    for (size_t o = 0; o < checker.num_orbits(); ++o) {
+        const std::vector<size_t>& sites = checker.orbit_sites(o);
+        for (size_t i = 0; i < sites.size(); ++i) {
+            if (sites[i] < is_magnetic.size() && is_magnetic[sites[i]]) magnetic[o].push_back(i);
+        }
+    }
+
+    auto find_operation = [&](const Matrix3d& R, const Vector3d& t) {
+        for (size_t k = 0; k < symops.size(); ++k) {
+            if ((symops[k].first - R).norm() < tolerance &&
+                bring_in_cell(symops[k].second - t, tolerance).norm() < tolerance) {
+                return k;
+            }
+        }
+        return symops.size();
+    };
+
+    for (size_t h = 0; h < symops.size(); ++h) {
+        // Site images under h; operations that do not permute the magnetic sites are not
+        // group generators, and an ambiguous image is treated as asymmetric
+        std::vector<std::vector<size_t>> image(checker.num_orbits());
+        bool permutes = true;
+        for (size_t o = 0; o < checker.num_orbits() && permutes; ++o) {
+            for (size_t i : magnetic[o]) {
+                size_t target = SIZE_MAX;
+                for (size_t j : magnetic[o]) {
+                    if (!checker.maps_onto(o, i, j, h)) continue;
+                    if (target != SIZE_MAX) return false;
+                    target = j;
+                }
+                if (target == SIZE_MAX) permutes = false;
+                image[o].push_back(target);
+            }
+        }
+        if (!permutes) continue;
+
+        const auto& [Rh, th] = symops[h];
+        const Matrix3d Rh_inv = Rh.inverse();
+        for (size_t g = 0; g < symops.size(); ++g) {
+            const auto& [Rg, tg] = symops[g];
+            const Matrix3d R = Rh * Rg * Rh_inv;
+            const size_t conjugate = find_operation(R, th + Rh * tg - R * th);
+            if (conjugate == symops.size()) return false;
+
+            for (size_t o = 0; o < checker.num_orbits(); ++o) {
+                const std::vector<size_t>& sites = magnetic[o];
+                for (size_t a = 0; a < sites.size(); ++a) {
+                    for (size_t b = 0; b < sites.size(); ++b) {
+                        const size_t i = sites[a], j = sites[b];
+                        const size_t pi = image[o][a], pj = image[o][b];
+                        if (checker.maps_onto(o, i, j, g) != checker.maps_onto(o, pi, pj, conjugate)) return false;
+                        if (i < j && checker.relates(o, i, j, g) !=
+                                     checker.relates(o, std::min(pi, pj), std::max(pi, pj), conjugate)) {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+std::vector<size_t> atom_permutation(const CrystalStructure& structure, const SymmetryOperation& op, double tolerance) {
+    const auto& [R, t] = op;
+    const size_t n = structure.atoms.size();
+    const Matrix3d metric = structure.cell * structure.cell.transpose();
+    std::vector<size_t> image;
+    if ((R.transpose() * metric * R - metric).norm() > tolerance * metric.norm()) return image;
+    // Each atom is the image of one atom only, so coinciding atoms still give a permutation
+    std::vector<bool> used(n, false);
+    for (size_t i = 0; i < n; ++i) {
+        const Vector3d x = R * structure.atoms[i].position + t;
+        for (size_t j = 0; j < n && image.size() == i; ++j) {
+            if (!used[j] && structure.atoms[j].chemical_symbol == structure.atoms[i].chemical_symbol &&
+                bring_in_cell(x - structure.atoms[j].position, tolerance).norm() < tolerance) {
+                image.push_back(j);
+                used[j] = true;
+            }
+        }
+        if (image.size() != i + 1) return std::vector<size_t>();
+    }
+    return image;
+}
+
+size_t inherit_subgroup_symmetry(const CrystalStructure& parent, CrystalStructure& derived, double tolerance) {
+    const size_t n = derived.atoms.size();
+    if (parent.atoms.size() != n || parent.equivalent_atoms.size() != n) {
+        throw std::invalid_argument("Derived structure must have the parent's atoms");
+    }
+    // Union-find over atoms joined by the operations that are symmetries of the derived structure
+    std::vector<size_t> root(n);
+    std::iota(root.begin(), root.end(), 0);
+    auto find = [&root](size_t i) {
+        while (root[i] != i) i = root[i] = root[root[i]];
+        return i;
+    };
+
+    // An operation is dropped when the parent has it and the derived structure does not. The
+    // fallback list (no spglib) also holds operations that are not symmetries of the parent; they
+    // stay, so the checker treats both structures alike.
+    std::vector<SymmetryOperation> kept;
+    bool dropped = false;
+    for (const auto& op : parent.symmetry_operations) {
+        const std::vector<size_t> image = atom_permutation(derived, op, tolerance);
+        if (image.empty()) {
+            if (!atom_permutation(parent, op, tolerance).empty()) {
+                dropped = true;
+                continue;
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                if (parent.equivalent_atoms[i] == parent.equivalent_atoms[image[i]]) root[find(i)] = find(image[i]);
+            }
+        }
+        kept.push_back(op);
+    }
+
+    if (!dropped) {
+        // Same orbits, except that an orbit whose atoms no longer share a species is split (the
+        // fallback labels group atoms by element without operations connecting them)
+        derived.equivalent_atoms = parent.equivalent_atoms;
+        std::map<std::pair<int, std::string>, int> split;
+        std::map<int, std::string> first_species;
+        int next_label = n > 0 ? *std::max_element(parent.equivalent_atoms.begin(), parent.equivalent_atoms.end()) + 1 : 0;
+        for (size_t i = 0; i < n; ++i) {
+            const int label = parent.equivalent_atoms[i];
+            const std::string& species = derived.atoms[i].chemical_symbol;
+            if (first_species.emplace(label, species).first->second == species) continue;
+            const auto inserted = split.emplace(std::make_pair(label, species), next_label);
+            if (inserted.second) ++next_label;
+            derived.equivalent_atoms[i] = inserted.first->second;
+        }
+    } else {
+        // Label every orbit by its first atom, as spglib does
+        derived.equivalent_atoms.assign(n, 0);
+        std::vector<int> label(n, -1);
+        for (size_t i = 0; i < n; ++i) {
+            const size_t r = find(i);
+            if (label[r] < 0) label[r] = static_cast<int>(i);
+            derived.equivalent_atoms[i] = label[r];
+        }
+    }
+    derived.symmetry_operations = std::move(kept);
+    return derived.symmetry_operations.size();
+}
+
+} // namespace amcheck
@@ -0,0 +1,246 @@
+#include "spin_constraints.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace amcheck {
+
+namespace {
+
+// Union-find over the magnetic sites plus one UP reference node. parity[i] is the spin of i
+// relative to its parent (0 = same, 1 = opposite).
+class ParityUnionFind {
+public:
+    explicit ParityUnionFind(size_t n) : parent_(n), parity_(n, 0) {
+        for (size_t i = 0; i < n; ++i) parent_[i] = i;
+    }
+
+    // Root of i and the parity of i relative to that root
+    std::pair<size_t, int> find(size_t i) {
+        int parity = 0;
+        size_t root = i;
+        while (parent_[root] != root) {
+            parity ^= parity_[root];
+            root = parent_[root];
+        }
+        // Path compression: point every node on the path straight at the root
+        int remaining = parity;
+        while (parent_[i] != root) {
+            const size_t next = parent_[i];
+            const int step = parity_[i];
+            parent_[i] = root;
+            parity_[i] = remaining;
+            remaining ^= step;
+            i = next;
+        }
+        return {root, parity};
+    }
+
+    // Records spin(a) = spin(b) XOR parity; false if that contradicts what is already known
+    bool relate(size_t a, size_t b, int parity) {
+        const auto [ra, pa] = find(a);
+        const auto [rb, pb] = find(b);
+        if (ra == rb) return (pa ^ pb) == parity;
+        parent_[ra] = rb;
+        parity_[ra] = pa ^ pb ^ parity;
+        return true;
+    }
+
+private:
+    std::vector<size_t> parent_;
+    std::vector<int> parity_;
+};
+
+std::vector<std::string> split_statements(const std::string& spec) {
+    std::vector<std::string> statements;
+    std::istringstream lines(spec);
+    std::string line;
+    while (std::getline(lines, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream parts(line);
+        std::string statement;
+        while (std::getline(parts, statement, ';')) {
+            const size_t first = statement.find_first_not_of(" \t\r");
+            if (first != std::string::npos) {
+                statements.push_back(statement.substr(first, statement.find_last_not_of(" \t\r") - first + 1));
+            }
+        }
+    }
+    return statements;
+}
+
+size_t parse_atom_number(const std::string& token, size_t num_atoms, const std::string& statement) {
+    size_t consumed = 0;
+    long long number = 0;
+    try {
+        number = std::stoll(token, &consumed);
+    } catch (const std::exception&) {
+        consumed = 0;
+    }
+    if (consumed != token.size() || number < 1 || static_cast<size_t>(number) > num_atoms) {
+        throw std::invalid_argument("Constraint '" + statement + "': '" + token + "' is not an atom number (1-" +
+                                    std::to_string(num_atoms) + ")");
+    }
+    return static_cast<size_t>(number - 1);
+}
+
+} // namespace
+
+ConstrainedSpace::ConstrainedSpace(
+    const CrystalStructure& structure,
+    const std::vector<size_t>& magnetic_indices,
+    const std::string& spec
+) : num_sites_(magnetic_indices.size()) {
+    const size_t n = magnetic_indices.size();
+    const size_t num_atoms = structure.atoms.size();
+    const size_t reference = n;  // the UP reference node
+    if (n >= 64) {
+        throw std::invalid_argument("Constrained search supports at most 63 magnetic atoms");
+    }
+
+    // Atom number -> position in the magnetic site list
+    std::vector<long long> site_of_atom(num_atoms, -1);
+    for (size_t i = 0; i < n; ++i) site_of_atom[magnetic_indices[i]] = static_cast<long long>(i);
+
+    ParityUnionFind sets(n + 1);
+
+    for (const std::string& statement : split_statements(spec)) {
+        std::istringstream in(statement);
+        std::string keyword;
+        in >> keyword;
+        std::vector<std::string> args;
+        for (std::string token; in >> token;) args.push_back(token);
+        ++num_statements_;
+
+        auto site = [&](const std::string& token) {
+            const size_t atom = parse_atom_number(token, num_atoms, statement);
+            if (site_of_atom[atom] < 0) {
+                throw std::invalid_argument("Constraint '" + statement + "': atom " + token + " (" +
+                                            structure.atoms[atom].chemical_symbol + ") is not a magnetic site");
+            }
+            return static_cast<size_t>(site_of_atom[atom]);
+        };
+        auto relate = [&](size_t a, size_t b, int parity) {
+            if (!sets.relate(a, b, parity)) {
+                throw std::invalid_argument("Constraint '" + statement + "' contradicts the statements before it");
+            }
+        };
+        auto relate_all = [&](const std::vector<size_t>& sites) {
+            for (size_t k = 1; k < sites.size(); ++k) relate(sites[0], sites[k], 0);
+        };
+
+        if (keyword == "fix") {
+            if (args.empty()) throw std::invalid_argument("Constraint '" + statement + "': expected atom:spin pairs");
+            for (const std::string& pair : args) {
+                const size_t sep = pair.find_first_of(":=");
+                const std::string spin = sep == std::string::npos ? "" : pair.substr(sep + 1);
+                if (spin != "u" && spin != "U" && spin != "d" && spin != "D") {
+                    throw std::invalid_argument("Constraint '" + statement + "': expected atom:u or atom:d, got '" +
+                                                pair + "'");
+                }
+                relate(site(pair.substr(0, sep)), reference, (spin == "d" || spin == "D") ? 1 : 0);
+            }
+        } else if (keyword == "parallel") {
+            if (args.size() < 2) throw std::invalid_argument("Constraint '" + statement + "': expected at least two atoms");
+            std::vector<size_t> sites;
+            for (const std::string& token : args) sites.push_back(site(token));
+            relate_all(sites);
+        } else if (keyword == "antiparallel") {
+            if (args.size() != 2) throw std::invalid_argument("Constraint '" + statement + "': expected two atoms");
+            relate(site(args[0]), site(args[1]), 1);
+        } else if (keyword == "layers") {
+            static const std::string axes = "abc";
+            if (args.empty() || args.size() > 2 || args[0].size() != 1 || axes.find(args[0][0]) == std::string::npos) {
+                throw std::invalid_argument("Constraint '" + statement + "': expected layers a|b|c [tolerance]");
+            }
+            const int axis = static_cast<int>(axes.find(args[0][0]));
+            const double layer_tol = args.size() == 2 ? std::stod(args[1]) : 0.01;
+
+            // Sites whose coordinates along the axis agree modulo 1 form one plane
+            std::vector<bool> assigned(n, false);
+            for (size_t i = 0; i < n; ++i) {
+                if (assigned[i]) continue;
+                const double zi = structure.get_scaled_position(magnetic_indices[i])[axis];
+                std::vector<size_t> plane{i};
+                for (size_t j = i + 1; j < n; ++j) {
+                    const double dz = zi - structure.get_scaled_position(magnetic_indices[j])[axis];
+                    if (!assigned[j] && std::abs(dz - std::round(dz)) < layer_tol) {
+                        plane.push_back(j);
+                        assigned[j] = true;
+                    }
+                }
+                relate_all(plane);
+            }
+        } else if (keyword == "ferro-orbit") {
+            if (args.empty()) throw std::invalid_argument("Constraint '" + statement + "': expected orbit numbers");
+            const std::vector<int> numbers = orbit_numbers(structure);
+            for (const std::string& token : args) {
+                const int orbit = std::stoi(token);
+                std::vector<size_t> sites;
+                for (size_t i = 0; i < n; ++i) {
+                    if (numbers[magnetic_indices[i]] == orbit) sites.push_back(i);
+                }
+                if (sites.empty()) {
+                    throw std::invalid_argument("Constraint '" + statement + "': orbit " + token +
+                                                " has no magnetic sites");
+                }
+                relate_all(sites);
+            }
+        } else {
+            throw std::invalid_argument("Unknown constraint '" + keyword +
+                                        "' (expected fix, parallel, antiparallel, layers or ferro-orbit)");
+        }
+    }
+
+    // Sites in the reference's block have a fixed spin; every other block is one free bit
+    const auto [reference_root, reference_parity] = sets.find(reference);
+    std::vector<long long> block_of_root(n + 1, -1);
+    for (size_t i = 0; i < n; ++i) {
+        const auto [root, parity] = sets.find(i);
+        if (root == reference_root) {
+            if (parity ^ reference_parity) base_id_ |= static_cast<size_t>(1) << i;
+            fixed_mask_ |= static_cast<size_t>(1) << i;
+            ++fixed_sites_;
+            continue;
+        }
+        if (block_of_root[root] < 0) {
+            block_of_root[root] = static_cast<long long>(block_masks_.size());
+            block_masks_.push_back(0);
+        }
+        block_masks_[block_of_root[root]] |= static_cast<size_t>(1) << i;
+        if (parity) base_id_ |= static_cast<size_t>(1) << i;
+    }
+}
+
+bool ConstrainedSpace::allows(size_t config_id) const {
+    const size_t difference = config_id ^ base_id_;
+    if (difference & fixed_mask_) return false;
+    for (size_t mask : block_masks_) {
+        const size_t bits = difference & mask;
+        if (bits != 0 && bits != mask) return false;
+    }
+    return true;
+}
+
+std::string ConstrainedSpace::describe() const {
+    std::ostringstream out;
+    out << num_statements_ << " statement" << (num_statements_ == 1 ? "" : "s") << "; " << fixed_sites_
+        << " of " << num_sites_ << " magnetic sites fixed, " << block_masks_.size() << " free spin block"
+        << (block_masks_.size() == 1 ? "" : "s") << " (2^" << block_masks_.size() << " = " << size()
+        << " configurations)";
+    return out.str();
+}
+
+std::string read_constraint_file(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open constraints file: " + filename);
+    }
+    std::stringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+} // namespace amcheck
@@ -0,0 +1,339 @@
+#include "amcheck.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+
+namespace amcheck {
+
+namespace {
+
+std::string lowercase(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+    return s;
+}
+
+std::string strip_comment(const std::string& line) {
+    const size_t comment = line.find_first_of("#!");
+    return comment == std::string::npos ? line : line.substr(0, comment);
+}
+
+// INCAR: MAGMOM may use continuation lines ending in a backslash
+std::vector<double> read_incar_magmom(std::istream& in) {
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string content = strip_comment(line);
+        const size_t eq = content.find('=');
+        if (eq == std::string::npos) continue;
+
+        std::string key = content.substr(0, eq);
+        key.erase(0, key.find_first_not_of(" \t"));
+        key.erase(key.find_last_not_of(" \t") + 1);
+        if (lowercase(key) != "magmom") continue;
+
+        std::string value = content.substr(eq + 1);
+        while (true) {
+            const size_t last = value.find_last_not_of(" \t\r");
+            if (last == std::string::npos || value[last] != '\\' || !std::getline(in, line)) break;
+            value = value.substr(0, last) + " " + strip_comment(line);
+        }
+        // Several tags can share a line: "MAGMOM = 2*5 ; ISPIN = 2"
+        return parse_magmom(value.substr(0, value.find(';')));
+    }
+    throw std::runtime_error("no MAGMOM tag found");
+}
+
+// OUTCAR: the last "magnetization (x)" table holds the final moments; its last column is the
+// total. Noncollinear runs also print "magnetization (z)", which is the component used.
+std::vector<double> read_outcar_magnetization(std::istream& in) {
+    std::vector<double> last_x, last_z;
+    std::string line;
+    while (std::getline(in, line)) {
+        const bool is_x = line.find("magnetization (x)") != std::string::npos;
+        const bool is_z = line.find("magnetization (z)") != std::string::npos;
+        if (!is_x && !is_z) continue;
+
+        // Skip to the "# of ion ... tot" header and the dashed rule below it
+        while (std::getline(in, line) && line.find("# of ion") == std::string::npos) {}
+        std::getline(in, line);
+
+        std::vector<double> moments;
+        while (std::getline(in, line)) {
+            std::istringstream row(line);
+            int ion = 0;
+            if (!(row >> ion)) break;  // "------" or "tot" ends the table
+            double value = 0.0, total = 0.0;
+            while (row >> value) total = value;
+            moments.push_back(total);
+        }
+        (is_z ? last_z : last_x) = std::move(moments);
+    }
+    if (!last_z.empty()) return last_z;
+    if (!last_x.empty()) return last_x;
+    throw std::runtime_error("no magnetization table found (was the run spin-polarized, with LORBIT set?)");
+}
+
+// Trailing number of a <set comment="spin 1">, "kpoint 3" or "band 12" line, 1-based
+size_t set_index(const std::string& line) {
+    const size_t start = line.find("comment=\"");
+    const size_t end = line.find('"', start + 9);
+    size_t digits = end;
+    while (digits > start + 9 && std::isdigit(static_cast<unsigned char>(line[digits - 1]))) --digits;
+    if (start == std::string::npos || digits == end) throw std::runtime_error("malformed set: " + line);
+    return std::stoul(line.substr(digits, end - digits));
+}
+
+// Numbers between <r> and </r> (or <v> and </v>)
+std::vector<double> row_values(const std::string& line) {
+    const size_t open = line.find('>');
+    std::istringstream row(line.substr(open + 1, line.rfind("</") - open - 1));
+    std::vector<double> values;
+    double value = 0.0;
+    while (row >> value) values.push_back(value);
+    return values;
+}
+
+// <eigenvalues> block: occupations[spin][kpoint][band]
+std::vector<std::vector<std::vector<double>>> read_occupations(std::istream& in) {
+    std::vector<std::vector<std::vector<double>>> occupations;
+    std::string line;
+    while (std::getline(in, line) && line.find("</eigenvalues>") == std::string::npos) {
+        if (line.find("comment=\"spin") != std::string::npos) {
+            occupations.emplace_back();
+        } else if (line.find("comment=\"kpoint") != std::string::npos && !occupations.empty()) {
+            occupations.back().emplace_back();
+        } else if (line.find("<r>") != std::string::npos && !occupations.empty() && !occupations.back().empty()) {
+            const std::vector<double> values = row_values(line);
+            if (values.size() < 2) throw std::runtime_error("malformed eigenvalue row: " + line);
+            occupations.back().back().push_back(values[1]);
+        }
+    }
+    return occupations;
+}
+
+// vasprun.xml: final moments from the site-projected occupations of the last <projected> block
+// (written with LORBIT >= 10), as OUTCAR's magnetization table: for every ion the sum over
+// k-points (weighted), bands (occupied fraction) and orbitals of the up projection minus the down
+// projection. Noncollinear runs project onto (total, mx, my, mz); mz is used.
+std::vector<double> read_vasprun_magnetization(std::istream& in) {
+    std::vector<double> weights;
+    std::vector<std::vector<std::vector<double>>> occupations;
+    std::vector<std::vector<double>> charge;   // [spin component][ion], last <projected> block
+    std::string line;
+    while (std::getline(in, line)) {
+        if (weights.empty() && line.find("name=\"weights\"") != std::string::npos) {
+            while (std::getline(in, line) && line.find("</varray>") == std::string::npos) {
+                const std::vector<double> values = row_values(line);
+                if (!values.empty()) weights.push_back(values[0]);
+            }
+        } else if (line.find("<eigenvalues>") != std::string::npos) {
+            occupations = read_occupations(in);
+        } else if (line.find("<projected>") != std::string::npos) {
+            charge.clear();
+            size_t spin = 0, kpoint = 0, band = 0, ion = 0;
+            while (std::getline(in, line) && line.find("</projected>") == std::string::npos) {
+                if (line.find("<eigenvalues>") != std::string::npos) {
+                    occupations = read_occupations(in);
+                } else if (line.find("comment=\"spin") != std::string::npos) {
+                    spin = set_index(line);
+                    if (charge.size() < spin) charge.resize(spin);
+                } else if (line.find("comment=\"kpoint") != std::string::npos) {
+                    kpoint = set_index(line);
+                } else if (line.find("comment=\"band") != std::string::npos) {
+                    band = set_index(line);
+                    ion = 0;
+                } else if (line.find("<r>") != std::string::npos && spin > 0 && kpoint > 0 && band > 0) {
+                    // Collinear components use their own spin channel; noncollinear runs have one
+                    const size_t channel = occupations.size() > 1 ? spin - 1 : 0;
+                    if (kpoint > weights.size() || channel >= occupations.size() ||
+                        kpoint > occupations[channel].size() || band > occupations[channel][kpoint - 1].size()) {
+                        throw std::runtime_error("projections do not match the k-point weights and occupations");
+                    }
+                    const std::vector<double> values = row_values(line);
+                    double projection = 0.0;
+                    for (double value : values) projection += value;
+                    std::vector<double>& component = charge[spin - 1];
+                    if (component.size() <= ion) component.resize(ion + 1, 0.0);
+                    component[ion++] += weights[kpoint - 1] * occupations[channel][kpoint - 1][band - 1] * projection;
+                }
+            }
+        }
+    }
+    if (charge.empty()) {
+        throw std::runtime_error("no <projected> block found (set LORBIT to write site projections)");
+    }
+    if (charge.size() == 2 && charge[0].size() == charge[1].size()) {
+        std::vector<double> moments(charge[0].size());
+        for (size_t i = 0; i < moments.size(); ++i) moments[i] = charge[0][i] - charge[1][i];
+        return moments;
+    }
+    if (charge.size() == 4) return charge[3];
+    throw std::runtime_error("the run is not spin-polarized (ISPIN = 1)");
+}
+
+} // namespace
+
+std::vector<double> parse_magmom(const std::string& value) {
+    std::vector<double> moments;
+    std::istringstream in(value);
+    std::string token;
+    while (in >> token) {
+        // VASP shorthand: "4*0" is four zeros
+        const size_t star = token.find('*');
+        try {
+            if (star == std::string::npos) {
+                moments.push_back(std::stod(token));
+            } else {
+                const int count = std::stoi(token.substr(0, star));
+                const double moment = std::stod(token.substr(star + 1));
+                moments.insert(moments.end(), static_cast<size_t>(std::max(0, count)), moment);
+            }
+        } catch (const std::exception&) {
+            throw std::invalid_argument("Invalid MAGMOM entry: " + token);
+        }
+    }
+    return moments;
+}
+
+std::vector<double> read_magnetic_moments(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open moments file: " + filename);
+    }
+
+    const std::string name = lowercase(filename.substr(filename.find_last_of("/\\") + 1));
+    try {
+        if (name.find("outcar") != std::string::npos) return read_outcar_magnetization(in);
+        if (name.size() >= 4 && name.compare(name.size() - 4, 4, ".xml") == 0) return read_vasprun_magnetization(in);
+        return read_incar_magmom(in);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(filename + ": " + e.what());
+    }
+}
+
+std::vector<SpinType> spins_from_moments(const std::vector<double>& moments, size_t num_atoms, double threshold) {
+    std::vector<double> collinear = moments;
+    if (moments.size() == 3 * num_atoms && moments.size() != num_atoms) {
+        // Noncollinear MAGMOM lists (mx, my, mz) per ion; the spin axis is z
+        collinear.clear();
+        for (size_t i = 0; i < num_atoms; ++i) collinear.push_back(moments[3 * i + 2]);
+    }
+    if (collinear.size() != num_atoms) {
+        throw std::invalid_argument("Got " + std::to_string(moments.size()) + " magnetic moments for " +
+                                    std::to_string(num_atoms) + " atoms");
+    }
+
+    std::vector<SpinType> spins;
+    for (double m : collinear) {
+        spins.push_back(std::abs(m) < threshold ? SpinType::NONE : (m > 0 ? SpinType::UP : SpinType::DOWN));
+    }
+    return spins;
+}
+
+std::vector<SpinType> parse_spin_pattern(const std::string& text) {
+    std::vector<SpinType> spins;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::string content = strip_comment(line);
+        std::replace(content.begin(), content.end(), ',', ' ');
+        std::istringstream tokens(content);
+        std::string token;
+        while (tokens >> token) {
+            spins.push_back(string_to_spin(token));
+        }
+    }
+    return spins;
+}
+
+std::vector<SpinType> spins_from_source(
+    const CrystalStructure& structure,
+    const SpinSource& source,
+    const MagneticSelection& selection,
+    const std::string& structure_filename,
+    std::string* moments_path
+) {
+    const size_t num_atoms = structure.atoms.size();
+    const std::vector<size_t> magnetic_indices = get_magnetic_atom_indices(structure, selection);
+    std::vector<SpinType> spins(num_atoms, SpinType::NONE);
+
+    if (!source.moments_file.empty()) {
+        // A bare name is looked up next to the structure, so one option serves a whole batch of
+        // run directories: amcheck --magmom OUTCAR run*/POSCAR. A run without its own file is an
+        // error rather than silently reusing the one in the current directory.
+        std::string path = source.moments_file;
+        const size_t slash = structure_filename.find_last_of("/\\");
+        if (slash != std::string::npos && path.find_first_of("/\\") == std::string::npos) {
+            path = structure_filename.substr(0, slash + 1) + path;
+            if (!std::ifstream(path).good()) {
+                throw std::runtime_error("No " + source.moments_file + " next to " + structure_filename);
+            }
+        }
+        if (moments_path) *moments_path = path;
+        spins = spins_from_moments(read_magnetic_moments(path), num_atoms, source.threshold);
+
+        // Moments on atoms outside an explicit sublattice are ignored
+        if (!selection.is_default()) {
+            std::vector<SpinType> selected(num_atoms, SpinType::NONE);
+            for (size_t idx : magnetic_indices) selected[idx] = spins[idx];
+            spins = selected;
+        }
+    } else {
+        std::string pattern = source.pattern;
+        std::ifstream file(pattern);
+        if (file.is_open()) {
+            std::stringstream content;
+            content << file.rdbuf();
+            pattern = content.str();
+        }
+        const std::vector<SpinType> parsed = parse_spin_pattern(pattern);
+
+        // One token per atom, or one per magnetic site in atom order
+        if (parsed.size() == num_atoms) {
+            spins = parsed;
+        } else if (parsed.size() == magnetic_indices.size()) {
+            for (size_t i = 0; i < magnetic_indices.size(); ++i) spins[magnetic_indices[i]] = parsed[i];
+        } else {
+            std::string expected = std::to_string(num_atoms) + " (all atoms)";
+            if (magnetic_indices.size() != num_atoms) {
+                expected += " or " + std::to_string(magnetic_indices.size()) + " (magnetic atoms)";
+            }
+            throw std::invalid_argument("--spins has " + std::to_string(parsed.size()) + " entries; expected " + expected);
+        }
+    }
+    return spins;
+}
+
+void assign_spins_from_source(
+    CrystalStructure& structure,
+    const SpinSource& source,
+    const MagneticSelection& selection,
+    const std::string& structure_filename
+) {
+    const size_t num_atoms = structure.atoms.size();
+    std::string moments_path;
+    const std::vector<SpinType> spins = spins_from_source(structure, source, selection, structure_filename, &moments_path);
+    if (!moments_path.empty()) {
+        std::cout << "Read magnetic moments from " << moments_path << " (|m| < " << source.threshold
+                  << " muB counts as non-magnetic)\n";
+    }
+
+    int total_up = 0, total_down = 0;
+    for (size_t i = 0; i < num_atoms; ++i) {
+        structure.atoms[i].spin = spins[i];
+        if (spins[i] == SpinType::UP) total_up++;
+        if (spins[i] == SpinType::DOWN) total_down++;
+    }
+
+    std::cout << "Spins: ";
+    for (size_t i = 0; i < num_atoms; ++i) {
+        std::cout << (i ? " " : "") << spin_to_string(spins[i]);
+    }
+    std::cout << "\n";
+    std::cout << "Magnetic atoms: " << (total_up + total_down) << " (UP: " << total_up
+              << ", DOWN: " << total_down << ")\n";
+}
+
+} // namespace amcheck
@@ -1,14 +1,13 @@
 #include "amcheck.h"
 #include <iostream>
+#include <sstream>
+#include <cmath>
 #include <stdexcept>
 #include <set>
 #include <unordered_set>
 
 namespace amcheck {
 
-// Function to analyze symmetry - declaration for use in this file
-void analyze_symmetry(CrystalStructure& structure, double tolerance = DEFAULT_TOLERANCE);
-
 // Magnetic elements database - transition metals and lanthanides/actinides
 bool is_magnetic_element(const std::string& chemical_symbol) {
     static const std::unordered_set<std::string> magnetic_elements = {
@@ -44,6 +43,97 @@ std::vector<size_t> get_magnetic_atom_indices(const CrystalStructure& structure)
     return magnetic_indices;
 }
 
+std::vector<size_t> get_magnetic_atom_indices(const CrystalStructure& structure,
+                                              const MagneticSelection& selection) {
+    if (selection.is_default()) {
+        return get_magnetic_atom_indices(structure);
+    }
+    
+    const std::vector<int> numbers = orbit_numbers(structure);
+    const int num_orbits = numbers.empty() ? 0 : *std::max_element(numbers.begin(), numbers.end());
+    for (int orbit : selection.orbits) {
+        if (orbit < 1 || orbit > num_orbits) {
+            throw std::invalid_argument("Orbit " + std::to_string(orbit) + " does not exist (this structure has " +
+                                        std::to_string(num_orbits) + " orbits)");
+        }
+    }
+    
+    // Explicit species/orbits replace the element list; priors only adjust the element list
+    const bool explicit_sites = !selection.species.empty() || !selection.orbits.empty();
+    std::vector<size_t> magnetic_indices;
+    for (size_t i = 0; i < structure.atoms.size(); ++i) {
+        const std::string& symbol = structure.atoms[i].chemical_symbol;
+        bool magnetic;
+        if (explicit_sites) {
+            magnetic = std::find(selection.species.begin(), selection.species.end(), symbol) != selection.species.end() ||
+                       std::find(selection.orbits.begin(), selection.orbits.end(), numbers[i]) != selection.orbits.end();
+        } else {
+            auto prior = selection.moments.find(symbol);
+            magnetic = prior != selection.moments.end() ? std::abs(prior->second) >= MIN_MAGNETIC_MOMENT
+                                                        : is_magnetic_element(symbol);
+        }
+        if (magnetic) {
+            magnetic_indices.push_back(i);
+        }
+    }
+    
+    return magnetic_indices;
+}
+
+std::vector<int> orbit_numbers(const CrystalStructure& structure) {
+    std::vector<int> labels = structure.equivalent_atoms;
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+    
+    std::vector<int> numbers;
+    for (int label : structure.equivalent_atoms) {
+        numbers.push_back(static_cast<int>(std::lower_bound(labels.begin(), labels.end(), label) - labels.begin()) + 1);
+    }
+    return numbers;
+}
+
+std::map<std::string, double> parse_moment_priors(const std::string& text) {
+    std::map<std::string, double> moments;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        const size_t eq = item.find('=');
+        if (eq == std::string::npos || eq == 0 || eq + 1 == item.size()) {
+            throw std::invalid_argument("--moments expects Element=moment pairs, got '" + item + "'");
+        }
+        moments[item.substr(0, eq)] = std::stod(item.substr(eq + 1));
+    }
+    return moments;
+}
+
+std::string describe_magnetic_selection(const MagneticSelection& selection) {
+    if (selection.is_default()) {
+        return "default element list";
+    }
+    
+    std::ostringstream out;
+    const char* separator = "";
+    if (!selection.species.empty()) {
+        out << "elements";
+        for (size_t i = 0; i < selection.species.size(); ++i) out << (i ? "," : " ") << selection.species[i];
+        separator = "; ";
+    }
+    if (!selection.orbits.empty()) {
+        out << separator << "orbits";
+        for (size_t i = 0; i < selection.orbits.size(); ++i) out << (i ? "," : " ") << selection.orbits[i];
+        separator = "; ";
+    }
+    if (!selection.moments.empty()) {
+        out << separator << "moment priors";
+        const char* comma = " ";
+        for (const auto& [element, moment] : selection.moments) {
+            out << comma << element << "=" << moment;
+            comma = ",";
+        }
+    }
+    return out.str();
+}
+
 // Get orbit indices that contain magnetic atoms
 std::vector<size_t> get_magnetic_orbit_indices(const CrystalStructure& structure) {
     std::vector<size_t> magnetic_atom_indices = get_magnetic_atom_indices(structure);
@@ -61,8 +151,11 @@ std::vector<size_t> get_magnetic_orbit_indices(const CrystalStructure& structure
     return magnetic_orbit_indices;
 }
 
-void assign_spins_to_magnetic_atoms_only(CrystalStructure& structure) {
+void assign_spins_to_magnetic_atoms_only(CrystalStructure& structure, const MagneticSelection& selection) {
     std::cout << "Auto-detecting magnetic atoms and assigning spins..." << std::endl;
+    if (!selection.is_default()) {
+        std::cout << "Magnetic sublattice: " << describe_magnetic_selection(selection) << std::endl;
+    }
     
     // First, set all atoms to non-magnetic
     for (auto& atom : structure.atoms) {
@@ -70,7 +163,7 @@ void assign_spins_to_magnetic_atoms_only(CrystalStructure& structure) {
     }
     
     // Get magnetic atom indices
-    std::vector<size_t> magnetic_indices = get_magnetic_atom_indices(structure);
+    std::vector<size_t> magnetic_indices = get_magnetic_atom_indices(structure, selection);
     
     if (magnetic_indices.empty()) {
         std::cout << "No magnetic atoms detected in the structure.\n";
@@ -0,0 +1,138 @@
+#include "status_file.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace amcheck {
+
+StatusFileWriter::StatusFileWriter(std::string path, std::string input_label, double min_interval_s)
+    : path_(std::move(path)), input_label_(std::move(input_label)), min_interval_s_(min_interval_s) {
+#ifndef _WIN32
+    struct stat info;
+    is_fifo_ = stat(path_.c_str(), &info) == 0 && S_ISFIFO(info.st_mode);
+    if (is_fifo_) {
+        // A departing reader must not kill the search; write() reports EPIPE instead
+        std::signal(SIGPIPE, SIG_IGN);
+    }
+#endif
+}
+
+StatusFileWriter::~StatusFileWriter() {
+#ifndef _WIN32
+    if (fifo_fd_ >= 0) close(fifo_fd_);
+#endif
+}
+
+void StatusFileWriter::update(const SearchProgress& progress) {
+    if (!progress.finished && last_elapsed_s_ >= 0.0 &&
+        progress.elapsed_s - last_elapsed_s_ < min_interval_s_) {
+        return;
+    }
+
+    // Rates over the interval since the previous update (first update: since the start)
+    const double previous_elapsed = std::max(0.0, last_elapsed_s_);
+    const double dt = progress.elapsed_s - previous_elapsed;
+    last_thread_completed_.resize(progress.thread_completed.size(), 0);
+    thread_rates_.assign(progress.thread_completed.size(), 0.0);
+    if (dt > 0.0) {
+        recent_rate_ = (progress.completed - last_completed_) / dt;
+        for (size_t t = 0; t < progress.thread_completed.size(); ++t) {
+            thread_rates_[t] = (progress.thread_completed[t] - last_thread_completed_[t]) / dt;
+        }
+    }
+
+    publish(to_json(progress));
+
+    last_elapsed_s_ = progress.elapsed_s;
+    last_completed_ = progress.completed;
+    last_thread_completed_ = progress.thread_completed;
+}
+
+std::string StatusFileWriter::to_json(const SearchProgress& progress) const {
+    const double average_rate = progress.elapsed_s > 0.0 ? progress.completed / progress.elapsed_s : 0.0;
+    const size_t remaining = progress.total > progress.completed ? progress.total - progress.completed : 0;
+    const double rate_for_eta = recent_rate_ > 0.0 ? recent_rate_ : average_rate;
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"state\": \"" << (progress.budget_exhausted ? "stopped" : progress.finished ? "done" : "running") << "\""
+        << ", \"input\": \"" << json_escape(input_label_) << "\""
+        << ", \"completed\": " << progress.completed
+        << ", \"total\": " << progress.total
+        << ", \"found\": " << progress.found
+        << ", \"fraction\": " << (progress.total > 0 ? static_cast<double>(progress.completed) / progress.total : 1.0)
+        << ", \"elapsed_s\": " << progress.elapsed_s
+        << ", \"rate\": " << recent_rate_
+        << ", \"average_rate\": " << average_rate;
+    if (progress.finished) {
+        out << ", \"eta_s\": 0";
+    } else if (rate_for_eta > 0.0) {
+        out << ", \"eta_s\": " << remaining / rate_for_eta;
+    } else {
+        out << ", \"eta_s\": null";
+    }
+    out << ", \"updated_unix\": " << std::chrono::duration_cast<std::chrono::seconds>(now).count()
+        << ", \"threads\": [";
+    for (size_t t = 0; t < progress.thread_completed.size(); ++t) {
+        out << (t ? ", " : "") << "{\"thread\": " << t
+            << ", \"completed\": " << progress.thread_completed[t]
+            << ", \"rate\": " << (t < thread_rates_.size() ? thread_rates_[t] : 0.0) << "}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+void StatusFileWriter::publish(const std::string& json) {
+#ifndef _WIN32
+    if (is_fifo_) {
+        // Keep the pipe open while a reader is attached so it sees one stream of lines.
+        // O_NONBLOCK: open fails with ENXIO when nobody reads, instead of stalling the search.
+        if (fifo_fd_ < 0) {
+            fifo_fd_ = open(path_.c_str(), O_WRONLY | O_NONBLOCK);
+            if (fifo_fd_ < 0) return;
+        }
+        const std::string line = json + "\n";
+        if (write(fifo_fd_, line.data(), line.size()) < 0 && errno != EAGAIN) {
+            // EPIPE: the reader went away; reopen on a later update
+            close(fifo_fd_);
+            fifo_fd_ = -1;
+        }
+        return;  // EAGAIN (pipe full) just drops this update
+    }
+#endif
+
+    const std::string temporary = path_ + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        out << json << "\n";
+        if (!out) {
+            if (!warned_) {
+                std::cerr << "WARNING: Cannot write status file " << temporary << "\n";
+                warned_ = true;
+            }
+            return;
+        }
+    }
+#ifdef _WIN32
+    std::remove(path_.c_str());  // rename() does not replace an existing file on Windows
+#endif
+    if (std::rename(temporary.c_str(), path_.c_str()) != 0 && !warned_) {
+        std::cerr << "WARNING: Cannot update status file " << path_ << ": " << std::strerror(errno) << "\n";
+        warned_ = true;
+    }
+}
+
+} // namespace amcheck
@@ -0,0 +1,236 @@
+#include "structure_fingerprint.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+
+#ifdef HAVE_SPGLIB
+#include <spglib.h>
+#endif
+
+namespace amcheck {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+struct Cell {
+    Matrix3d lattice;                    // rows are the lattice vectors
+    std::vector<Vector3d> positions;     // fractional
+    std::vector<std::string> species;
+};
+
+#ifdef HAVE_SPGLIB
+// Primitive standardized cell; the input is returned unchanged when spglib finds no symmetry
+Cell standardize(const Cell& input, double symprec) {
+    const size_t n = input.positions.size();
+    std::map<std::string, int> type_of;
+    std::vector<std::string> species_of_type;
+    for (const auto& s : input.species) {
+        if (type_of.emplace(s, static_cast<int>(species_of_type.size())).second) species_of_type.push_back(s);
+    }
+
+    double lattice[3][3];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            lattice[i][j] = input.lattice(j, i);  // spglib takes the vectors as columns
+        }
+    }
+    std::vector<double> flat(3 * n);
+    std::vector<int> types(n);
+    for (size_t i = 0; i < n; ++i) {
+        for (int k = 0; k < 3; ++k) flat[3 * i + k] = input.positions[i][k];
+        types[i] = type_of[input.species[i]];
+    }
+
+    const int count = spg_standardize_cell(lattice, reinterpret_cast<double(*)[3]>(flat.data()), types.data(),
+                                           static_cast<int>(n), 1, 0, symprec);
+    if (count <= 0) return input;
+
+    Cell cell;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            cell.lattice(j, i) = lattice[i][j];
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        cell.positions.emplace_back(flat[3 * i], flat[3 * i + 1], flat[3 * i + 2]);
+        cell.species.push_back(species_of_type[types[i]]);
+    }
+    return cell;
+}
+#endif
+
+// Size reduction of the basis: no vector can be shortened by adding a multiple of another.
+// Returns the integer matrix M with reduced = M * lattice.
+Matrix3d reduce_basis(const Matrix3d& lattice) {
+    Matrix3d m = Matrix3d::Identity();
+    Matrix3d b = lattice;
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        bool changed = false;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                if (i == j) continue;
+                const double k = std::round(b.row(j).dot(b.row(i)) / b.row(i).squaredNorm());
+                if (k != 0.0) {
+                    b.row(j) -= k * b.row(i);
+                    m.row(j) -= k * m.row(i);
+                    changed = true;
+                }
+            }
+        }
+        if (!changed) break;
+    }
+    return m;
+}
+
+// The 24 signed permutation matrices with determinant +1
+std::vector<Matrix3d> proper_axis_permutations() {
+    std::vector<Matrix3d> result;
+    std::array<int, 3> order = {0, 1, 2};
+    do {
+        for (int signs = 0; signs < 8; ++signs) {
+            Matrix3d p = Matrix3d::Zero();
+            for (int i = 0; i < 3; ++i) p(i, order[i]) = (signs >> i & 1) ? -1.0 : 1.0;
+            if (p.determinant() > 0.0) result.push_back(p);
+        }
+    } while (std::next_permutation(order.begin(), order.end()));
+    return result;
+}
+
+using LatticeKey = std::array<long long, 6>;
+
+LatticeKey lattice_key(const Matrix3d& lattice, double length_step) {
+    LatticeKey key;
+    for (int i = 0; i < 3; ++i) {
+        key[i] = std::llround(lattice.row(i).norm() / length_step);
+        const Vector3d u = lattice.row((i + 1) % 3);
+        const Vector3d v = lattice.row((i + 2) % 3);
+        const double cosine = std::max(-1.0, std::min(1.0, u.dot(v) / (u.norm() * v.norm())));
+        key[3 + i] = std::llround(std::acos(cosine) * 180.0 / PI * 10.0);  // 0.1 degree
+    }
+    return key;
+}
+
+using Site = std::tuple<std::string, long long, long long, long long>;
+
+long long grid(double x, long long cells) {
+    x -= std::floor(x);
+    const long long q = std::llround(x * static_cast<double>(cells));
+    return q % cells;
+}
+
+} // namespace
+
+std::string StructureFingerprint::hex() const {
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
+
+StructureFingerprint structure_fingerprint(const CrystalStructure& structure, double symprec) {
+    if (structure.atoms.empty()) throw std::invalid_argument("Cannot fingerprint a structure without atoms");
+
+    Cell cell;
+    cell.lattice = structure.cell;
+    for (const auto& atom : structure.atoms) {
+        cell.positions.push_back(atom.position);
+        cell.species.push_back(atom.chemical_symbol);
+    }
+#ifdef HAVE_SPGLIB
+    cell = standardize(cell, symprec);
+#endif
+
+    std::map<std::string, size_t> composition;
+    for (const auto& s : cell.species) ++composition[s];
+    // Anchor species: the rarest, so the fewest origin choices are tried
+    std::string anchor = composition.begin()->first;
+    for (const auto& [symbol, count] : composition) {
+        if (count < composition[anchor]) anchor = symbol;
+    }
+
+    const double step = 2.0 * std::max(symprec, 1e-5);
+    const Matrix3d reduction = reduce_basis(cell.lattice);
+
+    LatticeKey best_lattice;
+    std::vector<Site> best_sites;
+    bool have_best = false;
+
+    for (const Matrix3d& permutation : proper_axis_permutations()) {
+        const Matrix3d m = permutation * reduction;
+        const Matrix3d lattice = m * cell.lattice;
+        const LatticeKey key = lattice_key(lattice, step);
+        if (have_best && best_lattice < key) continue;
+
+        // Row-vector fractional coordinates transform with the inverse of m
+        const Matrix3d to_new = m.inverse().transpose();
+        std::vector<Vector3d> positions;
+        for (const auto& f : cell.positions) positions.push_back(to_new * f);
+        std::array<long long, 3> cells;
+        for (int i = 0; i < 3; ++i) cells[i] = std::max(1LL, std::llround(lattice.row(i).norm() / step));
+
+        for (size_t origin = 0; origin < positions.size(); ++origin) {
+            if (cell.species[origin] != anchor) continue;
+            std::vector<Site> sites;
+            sites.reserve(positions.size());
+            for (size_t i = 0; i < positions.size(); ++i) {
+                const Vector3d f = positions[i] - positions[origin];
+                sites.emplace_back(cell.species[i], grid(f[0], cells[0]), grid(f[1], cells[1]), grid(f[2], cells[2]));
+            }
+            std::sort(sites.begin(), sites.end());
+            if (!have_best || key < best_lattice || sites < best_sites) {
+                best_lattice = key;
+                best_sites = std::move(sites);
+                have_best = true;
+            }
+        }
+    }
+
+    std::ostringstream canonical;
+    for (const auto& [symbol, count] : composition) canonical << symbol << count;
+    canonical << '|';
+    for (size_t i = 0; i < best_lattice.size(); ++i) canonical << (i ? "," : "") << best_lattice[i];
+    canonical << '|';
+    for (const auto& [symbol, x, y, z] : best_sites) canonical << symbol << ':' << x << ',' << y << ',' << z << ';';
+
+    StructureFingerprint fingerprint;
+    fingerprint.canonical = canonical.str();
+    fingerprint.hash = 1469598103934665603ULL;
+    for (unsigned char c : fingerprint.canonical) {
+        fingerprint.hash ^= c;
+        fingerprint.hash *= 1099511628211ULL;
+    }
+    return fingerprint;
+}
+
+std::vector<size_t> find_duplicate_structures(
+    const std::vector<std::string>& files,
+    double symprec,
+    std::vector<StructureFingerprint>* fingerprints
+) {
+    std::vector<size_t> representative(files.size());
+    std::unordered_map<std::string, size_t> first_with;
+    if (fingerprints) fingerprints->assign(files.size(), StructureFingerprint());
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        representative[i] = i;
+        StructureFingerprint fingerprint;
+        try {
+            CrystalStructure structure;
+            structure.read_from_file(files[i]);
+            fingerprint = structure_fingerprint(structure, symprec);
+        } catch (const std::exception&) {
+            continue;  // reported when the file is processed
+        }
+        representative[i] = first_with.emplace(fingerprint.canonical, i).first->second;
+        if (fingerprints) (*fingerprints)[i] = std::move(fingerprint);
+    }
+    return representative;
+}
+
+} // namespace amcheck
@@ -0,0 +1,306 @@
+#include "substitution.h"
+#include "site_symmetry.h"
+#include "worker_pool.h"
+#include "profiler.h"
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace amcheck {
+
+namespace {
+
+constexpr size_t MAX_GROUP_ORDER = 50000;
+constexpr double MAX_DECORATIONS = 1e8;
+
+uint64_t permute_mask(uint64_t mask, const SitePermutation& p) {
+    uint64_t image = 0;
+    for (size_t i = 0; i < p.size(); ++i) {
+        if ((mask >> i) & 1) image |= static_cast<uint64_t>(1) << p[i];
+    }
+    return image;
+}
+
+double binomial(size_t n, size_t k) {
+    double value = 1.0;
+    for (size_t i = 1; i <= k; ++i) value = value * static_cast<double>(n - k + i) / static_cast<double>(i);
+    return value;
+}
+
+// Site permutations of the host sites under the parent operations that are symmetries of the
+// parent, closed under composition up to MAX_GROUP_ORDER elements
+SitePermutationGroup host_site_group(const CrystalStructure& parent, const std::vector<size_t>& host_sites,
+                                     double tolerance) {
+    const size_t n = host_sites.size();
+    std::vector<int> host_position(parent.atoms.size(), -1);
+    for (size_t i = 0; i < n; ++i) host_position[host_sites[i]] = static_cast<int>(i);
+
+    std::set<SitePermutation> generators;
+    for (const auto& op : parent.symmetry_operations) {
+        const std::vector<size_t> image = atom_permutation(parent, op, tolerance);
+        if (image.empty()) continue;
+        SitePermutation p(n);
+        for (size_t i = 0; i < n; ++i) p[i] = static_cast<uint32_t>(host_position[image[host_sites[i]]]);
+        generators.insert(p);
+    }
+
+    SitePermutation identity(n);
+    for (size_t i = 0; i < n; ++i) identity[i] = static_cast<uint32_t>(i);
+    SitePermutationGroup group;
+    group.elements.push_back(identity);
+    std::set<SitePermutation> seen{identity};
+    std::deque<SitePermutation> pending{identity};
+    while (!pending.empty() && !group.truncated) {
+        const SitePermutation current = pending.front();
+        pending.pop_front();
+        for (const auto& g : generators) {
+            SitePermutation product(n);
+            for (size_t i = 0; i < n; ++i) product[i] = g[current[i]];
+            if (seen.insert(product).second) {
+                group.elements.push_back(product);
+                pending.push_back(std::move(product));
+                if (group.elements.size() >= MAX_GROUP_ORDER) {
+                    group.truncated = true;
+                    break;
+                }
+            }
+        }
+    }
+    return group;
+}
+
+} // namespace
+
+SubstitutionSpec parse_substitution_spec(const std::string& text) {
+    std::vector<std::string> parts;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ':')) parts.push_back(item);
+    if (parts.size() != 3 || parts[0].empty() || parts[1].empty() || parts[2].empty()) {
+        throw std::invalid_argument("--substitute expects host:dopant:count, e.g. Ti:Fe:2 or Ti:Fe:1-3");
+    }
+
+    SubstitutionSpec spec;
+    spec.host = parts[0];
+    spec.dopant = parts[1];
+    const size_t dash = parts[2].find('-');
+    try {
+        size_t used = 0;
+        const std::string first = parts[2].substr(0, dash);
+        spec.min_count = std::stoul(first, &used);
+        if (used != first.size()) throw std::invalid_argument(first);
+        spec.max_count = spec.min_count;
+        if (dash != std::string::npos) {
+            const std::string last = parts[2].substr(dash + 1);
+            spec.max_count = std::stoul(last, &used);
+            if (used != last.size()) throw std::invalid_argument(last);
+        }
+    } catch (const std::exception&) {
+        throw std::invalid_argument("--substitute: bad count '" + parts[2] + "'");
+    }
+    if (spec.min_count == 0 || spec.max_count < spec.min_count) {
+        throw std::invalid_argument("--substitute: count must be a positive number or range");
+    }
+    return spec;
+}
+
+DecorationSet enumerate_decorations(const CrystalStructure& parent, const SubstitutionSpec& spec, double tolerance) {
+    ScopedSpan span("decorations");
+    DecorationSet result;
+    for (size_t i = 0; i < parent.atoms.size(); ++i) {
+        if (parent.atoms[i].chemical_symbol == spec.host) result.host_sites.push_back(i);
+    }
+    const size_t n = result.host_sites.size();
+    if (n == 0) {
+        throw std::invalid_argument("--substitute: the structure has no " + spec.host + " sites");
+    }
+    if (n > 63) {
+        throw std::invalid_argument("--substitute: at most 63 " + spec.host + " sites are supported, the structure has " +
+                                    std::to_string(n));
+    }
+    if (spec.max_count > n) {
+        throw std::invalid_argument("--substitute: cannot replace " + std::to_string(spec.max_count) + " of " +
+                                    std::to_string(n) + " " + spec.host + " sites");
+    }
+    if (parent.get_atomic_number(spec.dopant) == 1 && spec.dopant != "H") {
+        throw std::invalid_argument("--substitute: unknown element '" + spec.dopant + "'");
+    }
+    double candidates = 0.0;
+    for (size_t k = spec.min_count; k <= spec.max_count; ++k) candidates += binomial(n, k);
+    if (candidates > MAX_DECORATIONS) {
+        throw std::invalid_argument("--substitute: " + std::to_string(static_cast<double>(candidates)) +
+                                    " decorations are too many to enumerate; narrow the count range");
+    }
+
+    const SitePermutationGroup group = host_site_group(parent, result.host_sites, tolerance);
+    result.group_order = group.elements.size();
+    result.group_truncated = group.truncated;
+
+    const uint64_t all = n == 64 ? ~static_cast<uint64_t>(0) : (static_cast<uint64_t>(1) << n) - 1;
+    for (size_t k = spec.min_count; k <= spec.max_count; ++k) {
+        for (uint64_t mask = (static_cast<uint64_t>(1) << k) - 1; mask != 0 && mask <= all;) {
+            ++result.total;
+
+            // Canonical: no image is smaller. The stabilizer gives the size of the class.
+            size_t stabilizer = 0;
+            bool canonical = true;
+            for (const auto& g : group.elements) {
+                const uint64_t image = permute_mask(mask, g);
+                if (image < mask) {
+                    canonical = false;
+                    break;
+                }
+                stabilizer += image == mask;
+            }
+            if (canonical) {
+                Decoration decoration;
+                for (size_t i = 0; i < n; ++i) {
+                    if ((mask >> i) & 1) decoration.sites.push_back(result.host_sites[i]);
+                }
+                // A truncated set is not a group: classes may be split and sizes are unknown
+                decoration.multiplicity = group.truncated ? 0 : group.elements.size() / stabilizer;
+                result.distinct.push_back(decoration);
+            }
+
+            // Next mask with the same number of set bits (Gosper)
+            const uint64_t low = mask & (~mask + 1);
+            const uint64_t ripple = mask + low;
+            if (ripple == 0 || ripple > all) break;
+            mask = ripple | (((mask ^ ripple) >> 2) / low);
+        }
+    }
+    return result;
+}
+
+CrystalStructure decorate(const CrystalStructure& parent, const Decoration& decoration, const std::string& dopant) {
+    CrystalStructure structure;
+    structure.cell = parent.cell;
+    structure.atoms = parent.atoms;
+    const int atomic_number = parent.get_atomic_number(dopant);
+    for (size_t site : decoration.sites) {
+        structure.atoms[site].chemical_symbol = dopant;
+        structure.atoms[site].atomic_number = atomic_number;
+        structure.atoms[site].spin = SpinType::NONE;
+    }
+    return structure;
+}
+
+std::vector<DecorationResult> search_decorations(
+    const CrystalStructure& parent,
+    const SubstitutionSpec& spec,
+    const DecorationSet& decorations,
+    double tolerance,
+    const SearchOptions& options
+) {
+    ScopedSpan span("substitution search");
+    std::vector<DecorationResult> results(decorations.distinct.size());
+    const bool bounded = options.max_configurations > 0 || options.time_budget_s > 0.0;
+
+    const size_t threads = std::max<size_t>(1, std::min<size_t>(resolve_thread_count(options.num_threads),
+                                                                results.size()));
+    WorkerPool pool(threads, 2 * threads);
+    for (size_t index = 0; index < results.size(); ++index) {
+        pool.submit([&, index] {
+            DecorationResult& result = results[index];
+            try {
+                CrystalStructure structure = decorate(parent, decorations.distinct[index], spec.dopant);
+                result.operations = inherit_subgroup_symmetry(parent, structure, tolerance);
+                const std::vector<size_t> magnetic = get_magnetic_atom_indices(structure, options.magnetic);
+                result.magnetic_sites = magnetic.size();
+                if (magnetic.empty()) {
+                    result.note = "no magnetic sites";
+                    return;
+                }
+                if (magnetic.size() > 63 || (magnetic.size() > LARGE_SEARCH_MAGNETIC_ATOMS && !bounded)) {
+                    result.note = std::to_string(magnetic.size()) +
+                        " magnetic sites; bound the searches with --max-configs or --time-budget";
+                    return;
+                }
+
+                // One single-threaded search per decoration; the decorations share the workers
+                SearchOptions run = options;
+                run.num_threads = 1;
+                run.quiet = true;
+                run.status_file.clear();
+                run.spread_order = options.spread_order || options.max_configurations > 0;
+                SearchProgress final_progress;
+                const std::vector<SpinConfiguration> found = run_spin_search(
+                    structure, magnetic, tolerance, run, nullptr,
+                    [&final_progress](const SearchProgress& progress) {
+                        if (progress.finished) final_progress = progress;
+                    });
+                result.tested = final_progress.completed;
+                result.found = found.size();
+                if (!found.empty()) result.example = found.front().spins;
+            } catch (const std::exception& e) {
+                result.note = e.what();
+            }
+        });
+    }
+    pool.finish();
+    return results;
+}
+
+void print_substitution_results(
+    const CrystalStructure& parent,
+    const SubstitutionSpec& spec,
+    const DecorationSet& decorations,
+    const std::vector<DecorationResult>& results,
+    std::ostream& out
+) {
+    out << "\nSubstitution: " << spec.host << " -> " << spec.dopant << ", " << spec.min_count;
+    if (spec.max_count != spec.min_count) out << "-" << spec.max_count;
+    out << " of " << decorations.host_sites.size() << " " << spec.host << " sites\n";
+    out << "Decorations: " << decorations.total << " total, " << decorations.distinct.size()
+        << " symmetry-distinct (site permutation group order " << decorations.group_order
+        << (decorations.group_truncated ? ", truncated" : "") << ")\n";
+    if (decorations.group_truncated) {
+        out << "  (group closure hit its size limit; some duplicates remain and multiplicities are unknown)\n";
+    }
+
+    out << "\n-----------------------------------------------------------------------\n";
+    out << "   #  Multiplicity  Operations  Magnetic      Tested  Altermagnetic  Replaced atoms\n";
+    size_t altermagnetic = 0;
+    for (size_t d = 0; d < results.size(); ++d) {
+        const DecorationResult& result = results[d];
+        const Decoration& decoration = decorations.distinct[d];
+        std::ostringstream sites;
+        for (size_t i = 0; i < decoration.sites.size(); ++i) sites << (i ? "," : "") << decoration.sites[i] + 1;
+        const std::string multiplicity = decoration.multiplicity > 0 ? std::to_string(decoration.multiplicity) : "-";
+        out << std::setw(4) << d + 1 << "  " << std::setw(12) << multiplicity << "  "
+            << std::setw(10) << result.operations << "  " << std::setw(8) << result.magnetic_sites << "  ";
+        if (!result.note.empty()) {
+            out << std::setw(10) << "-" << "  " << std::setw(13) << "-" << "  " << sites.str()
+                << " (" << result.note << ")\n";
+            continue;
+        }
+        out << std::setw(10) << result.tested << "  " << std::setw(13) << result.found << "  " << sites.str() << "\n";
+        altermagnetic += result.found > 0;
+    }
+    out << "-----------------------------------------------------------------------\n";
+
+    out << "\n" << altermagnetic << " of " << results.size() << " distinct decorations admit an altermagnetic ordering";
+    out << (altermagnetic > 0 ? ":" : ".") << "\n";
+    for (size_t d = 0; d < results.size(); ++d) {
+        if (results[d].found == 0) continue;
+        out << "  #" << d + 1 << ": ";
+        for (size_t j = 0; j < results[d].example.size(); ++j) {
+            if (j > 0) out << " ";
+            out << spin_to_string(results[d].example[j]);
+        }
+        out << " | ";
+        for (size_t j = 0; j < parent.atoms.size(); ++j) {
+            if (j > 0) out << " ";
+            const bool replaced = std::find(decorations.distinct[d].sites.begin(), decorations.distinct[d].sites.end(), j)
+                != decorations.distinct[d].sites.end();
+            out << (replaced ? spec.dopant : parent.atoms[j].chemical_symbol);
+        }
+        out << "\n";
+    }
+}
+
+} // namespace amcheck
@@ -0,0 +1,153 @@
+#include "ternary_space.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+
+namespace amcheck {
+
+namespace {
+
+uint8_t spin_digit(SpinType spin) {
+    switch (spin) {
+        case SpinType::UP: return 0;
+        case SpinType::DOWN: return 1;
+        case SpinType::NONE: return 2;
+    }
+    return 2;
+}
+
+} // namespace
+
+TernarySpace::TernarySpace(const CrystalStructure& structure, const std::vector<size_t>& magnetic_indices,
+                           double tolerance, bool symmetry_dedup)
+    : magnetic_indices_(magnetic_indices), dedup_(symmetry_dedup) {
+    const size_t n = magnetic_indices.size();
+    if (n > MAX_SITES) {
+        throw std::invalid_argument("Ternary search supports at most " + std::to_string(MAX_SITES) +
+                                    " magnetic atoms (got " + std::to_string(n) + ")");
+    }
+
+    // Orbits in ascending equivalent_atoms label, like is_altermagnet(); whether an orbit is
+    // checked at all depends on its size in the whole structure, not only on the selected sites
+    std::map<int, size_t> structure_orbit_sizes;
+    for (int label : structure.equivalent_atoms) structure_orbit_sizes[label]++;
+    std::map<int, Orbit> by_label;
+    for (size_t i = 0; i < n; ++i) {
+        by_label[structure.equivalent_atoms[magnetic_indices[i]]].sites.push_back(i);
+    }
+
+    for (auto& [label, orbit] : by_label) {
+        orbit.unconstrained = structure_orbit_sizes[label] == 1;
+        if (orbit.unconstrained) {
+            orbit.choices = 3;
+        } else {
+            // counts[r][t + k]: words of length r over {UP, DOWN, NONE} with (#UP - #DOWN) == t
+            const size_t k = orbit.sites.size();
+            const size_t width = 2 * k + 1;
+            auto existing = std::find(count_sizes_.begin(), count_sizes_.end(), k);
+            orbit.table = static_cast<size_t>(existing - count_sizes_.begin());
+            if (existing == count_sizes_.end()) {
+                std::vector<size_t> counts((k + 1) * width, 0);
+                counts[k] = 1;
+                for (size_t r = 1; r <= k; ++r) {
+                    for (size_t t = 0; t < width; ++t) {
+                        size_t total = counts[(r - 1) * width + t];                  // NONE
+                        if (t > 0) total += counts[(r - 1) * width + t - 1];         // UP
+                        if (t + 1 < width) total += counts[(r - 1) * width + t + 1]; // DOWN
+                        counts[r * width + t] = total;
+                    }
+                }
+                count_sizes_.push_back(k);
+                counts_.push_back(std::move(counts));
+            }
+            orbit.choices = completions(orbit, k, 0);
+        }
+        size_ *= orbit.choices;  // at most 3^40, which fits
+        orbits_.push_back(std::move(orbit));
+    }
+
+    dedup_ = dedup_ && operations_form_group(structure.symmetry_operations, tolerance) &&
+             verdicts_invariant(AltermagnetChecker(structure, tolerance), structure.symmetry_operations,
+                                magnetic_indices, tolerance);
+    if (dedup_) {
+        group_ = magnetic_site_group(structure, magnetic_indices, tolerance);
+        for (const auto& g : group_.elements) {
+            SitePermutation inverse(g.size());
+            for (size_t i = 0; i < g.size(); ++i) inverse[g[i]] = static_cast<uint32_t>(i);
+            inverses_.push_back(std::move(inverse));
+        }
+    }
+}
+
+long double TernarySpace::raw_size() const {
+    return std::pow(3.0L, static_cast<long double>(magnetic_indices_.size()));
+}
+
+size_t TernarySpace::completions(const Orbit& orbit, size_t remaining, long long balance) const {
+    const long long k = static_cast<long long>(count_sizes_[orbit.table]);
+    if (balance < -k || balance > k) return 0;
+    return counts_[orbit.table][remaining * (2 * k + 1) + static_cast<size_t>(balance + k)];
+}
+
+size_t TernarySpace::decode(size_t index, std::vector<SpinType>& spins) const {
+    static const SpinType states[3] = {SpinType::UP, SpinType::DOWN, SpinType::NONE};
+    static const long long deltas[3] = {1, -1, 0};
+
+    size_t id = 0;
+    size_t place[MAX_SITES];
+    for (size_t i = 0, p = 1; i < magnetic_indices_.size(); ++i, p *= 3) place[i] = p;
+
+    for (const Orbit& orbit : orbits_) {
+        size_t local = index % orbit.choices;
+        index /= orbit.choices;
+
+        if (orbit.unconstrained) {
+            spins[magnetic_indices_[orbit.sites[0]]] = states[local];
+            id += local * place[orbit.sites[0]];
+            continue;
+        }
+
+        // Unrank: at each site take the first state whose balanced completions cover local
+        long long balance = 0;
+        const size_t k = orbit.sites.size();
+        for (size_t s = 0; s < k; ++s) {
+            for (size_t c = 0; c < 3; ++c) {
+                const size_t count = completions(orbit, k - s - 1, -(balance + deltas[c]));
+                if (local < count) {
+                    spins[magnetic_indices_[orbit.sites[s]]] = states[c];
+                    id += c * place[orbit.sites[s]];
+                    balance += deltas[c];
+                    break;
+                }
+                local -= count;
+            }
+        }
+    }
+    return id;
+}
+
+bool TernarySpace::is_canonical(const std::vector<SpinType>& spins) const {
+    if (!dedup_) return true;
+
+    const size_t n = magnetic_indices_.size();
+    uint8_t digits[MAX_SITES];
+    for (size_t i = 0; i < n; ++i) digits[i] = spin_digit(spins[magnetic_indices_[i]]);
+
+    static const uint8_t flipped[3] = {1, 0, 2};
+    for (size_t e = 0; e < inverses_.size(); ++e) {
+        const SitePermutation& inverse = inverses_[e];
+        // The image puts digits[inverse[j]] at site j; compare from the most significant digit
+        for (int flip = 0; flip < 2; ++flip) {
+            if (e == 0 && flip == 0) continue;  // the identity itself
+            for (size_t j = n; j-- > 0;) {
+                const uint8_t image = flip ? flipped[digits[inverse[j]]] : digits[inverse[j]];
+                if (image < digits[j]) return false;
+                if (image > digits[j]) break;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace amcheck
@@ -0,0 +1,330 @@
+#include "tolerance_sweep.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace amcheck {
+
+namespace {
+
+constexpr double NEVER = std::numeric_limits<double>::infinity();
+
+// Distance of a fractional vector to the nearest lattice point, in the form the checks compare
+// against the tolerance: bring_in_cell() folds components near 1 only when they are within the
+// tolerance of 1, and with a tolerance of 0.5 it folds every component to its nearer side, so
+// "residual < tol" holds exactly when the check with tolerance tol passes
+double residual(const Vector3d& dp) {
+    return bring_in_cell(dp, 0.5).norm();
+}
+
+inline bool are_antiparallel(SpinType a, SpinType b) {
+    return (a == SpinType::UP && b == SpinType::DOWN) ||
+           (a == SpinType::DOWN && b == SpinType::UP);
+}
+
+// Tolerances at which one magnetic site is in an inversion or translation pair: above ray, or
+// inside one of the open intervals (pure translations stop counting at their own length)
+struct SitePairing {
+    double ray = NEVER;
+    size_t first_interval = 0;
+    size_t end_interval = 0;
+};
+
+struct Interval {
+    size_t site;   // index into the orbit's SitePairing entries while collecting
+    double low;
+    double high;
+};
+
+// One balanced magnetic orbit of the evaluated pattern: altermagnetic at t when t > symmetric
+// (every magnetic site is in a symmetry pair) and some magnetic site is not paired at t
+struct OrbitThresholds {
+    double symmetric = NEVER;
+    size_t first_site = 0;
+    size_t end_site = 0;
+};
+
+struct Thresholds {
+    std::vector<OrbitThresholds> orbits;
+    std::vector<SitePairing> sites;
+    std::vector<Interval> intervals;
+
+    bool altermagnet_at(double t) const {
+        for (const OrbitThresholds& orbit : orbits) {
+            if (!(t > orbit.symmetric)) continue;
+            for (size_t s = orbit.first_site; s < orbit.end_site; ++s) {
+                const SitePairing& site = sites[s];
+                bool paired = t > site.ray;
+                for (size_t k = site.first_interval; k < site.end_interval && !paired; ++k) {
+                    paired = intervals[k].low < t && t < intervals[k].high;
+                }
+                if (!paired) return true;
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+ToleranceSweep::ToleranceSweep(const CrystalStructure& structure, std::vector<double> tolerances) {
+    std::sort(tolerances.begin(), tolerances.end());
+    tolerances.erase(std::unique(tolerances.begin(), tolerances.end()), tolerances.end());
+    if (tolerances.empty() || tolerances.size() > MAX_TOLERANCES) {
+        throw std::invalid_argument("A tolerance sweep takes 1 to " + std::to_string(MAX_TOLERANCES) + " tolerances");
+    }
+    if (tolerances.front() <= 0.0 || tolerances.back() >= 0.5) {
+        throw std::invalid_argument("Tolerances must lie between 0 and 0.5");
+    }
+    tolerances_ = std::move(tolerances);
+
+    const std::vector<SymmetryOperation>& symops = structure.symmetry_operations;
+    const std::vector<Vector3d> positions = structure.get_all_scaled_positions();
+    const std::vector<int>& equiv_atoms = structure.equivalent_atoms;
+    if (equiv_atoms.size() != positions.size()) {
+        throw std::invalid_argument("Number of orbit labels must equal number of positions");
+    }
+
+    // Traces are integers, so these tests do not depend on the tolerance
+    for (const auto& [R, t] : symops) {
+        op_kind_.push_back(std::abs(R.trace() + 3) < 0.5 ? OpKind::INVERSION
+                           : std::abs(R.trace() - 3) < 0.5 ? OpKind::TRANSLATION : OpKind::OTHER);
+        translation_length_.push_back(t.norm());
+    }
+
+    // Same orbit order as AltermagnetChecker: ascending orbit identifiers
+    std::vector<int> labels = equiv_atoms;
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+    const double cutoff = tolerances_.back();
+    for (int label : labels) {
+        Orbit orbit;
+        for (size_t i = 0; i < equiv_atoms.size(); ++i) {
+            if (equiv_atoms[i] == label) orbit.sites.push_back(i);
+        }
+        const size_t n = orbit.sites.size();
+        for (size_t i = 0; i < n; ++i) {
+            const Vector3d& pi = positions[orbit.sites[i]];
+            for (size_t op = 0; op < symops.size(); ++op) {
+                const auto& [R, t] = symops[op];
+                orbit.first.push_back(static_cast<uint32_t>(orbit.candidates.size()));
+                for (size_t j = 0; j < n; ++j) {
+                    // A site is never antiparallel to itself, so i == j cannot pair
+                    if (j == i) continue;
+                    const Vector3d& pj = positions[orbit.sites[j]];
+                    Candidate candidate{static_cast<uint32_t>(j), residual(R * pi + t - pj), NEVER};
+                    // The checks test the relation only for i < j; expressions as in the checker
+                    if (j > i && op_kind_[op] == OpKind::INVERSION) {
+                        const Vector3d midpoint = (pi + pj) / 2.0;
+                        candidate.related = residual(R * midpoint + t - midpoint);
+                    } else if (j > i && op_kind_[op] == OpKind::TRANSLATION) {
+                        candidate.related = residual(pi + t - pj);
+                    }
+                    if (!(candidate.match < cutoff)) candidate.match = NEVER;
+                    if (!(candidate.related < cutoff)) candidate.related = NEVER;
+                    if (candidate.match != NEVER || candidate.related != NEVER) {
+                        orbit.candidates.push_back(candidate);
+                    }
+                }
+            }
+        }
+        orbit.first.push_back(static_cast<uint32_t>(orbit.candidates.size()));
+        orbits_.push_back(std::move(orbit));
+    }
+}
+
+uint64_t ToleranceSweep::evaluate(const std::vector<SpinType>& spins, std::vector<double>* flips) const {
+    if (flips) flips->clear();
+
+    // Same validation as AltermagnetChecker::evaluate(); none of it depends on the tolerance
+    bool check_was_performed = false;
+    for (const Orbit& orbit : orbits_) {
+        if (orbit.sites.size() == 1) continue;
+        int N_u = 0, N_d = 0;
+        for (size_t site : orbit.sites) {
+            N_u += spins[site] == SpinType::UP;
+            N_d += spins[site] == SpinType::DOWN;
+        }
+        if (N_u == 0 && N_d == 0) continue;
+        if (N_u != N_d) return 0;
+        check_was_performed = true;
+    }
+    if (!check_was_performed) return 0;
+
+    // Per-thread scratch space keeps the hot path allocation-free
+    thread_local Thresholds thresholds;
+    thread_local std::vector<double> survival;
+    thread_local std::vector<int> slot;
+    thresholds.orbits.clear();
+    thresholds.sites.clear();
+    thresholds.intervals.clear();
+
+    const size_t num_ops = op_kind_.size();
+    for (const Orbit& orbit : orbits_) {
+        const size_t n = orbit.sites.size();
+        if (n == 1) continue;
+        auto spin = [&](size_t i) { return spins[orbit.sites[i]]; };
+        if (std::all_of(orbit.sites.begin(), orbit.sites.end(),
+                        [&](size_t site) { return spins[site] == SpinType::NONE; })) {
+            continue;
+        }
+
+        // Survival threshold of each operation: every magnetic site needs an antiparallel image
+        survival.assign(num_ops, NEVER);
+        for (size_t op = 0; op < num_ops; ++op) {
+            double threshold = 0.0;
+            for (size_t i = 0; i < n && threshold != NEVER; ++i) {
+                if (spin(i) == SpinType::NONE) continue;
+                double nearest = NEVER;
+                for (uint32_t c = orbit.first[i * num_ops + op]; c < orbit.first[i * num_ops + op + 1]; ++c) {
+                    const Candidate& candidate = orbit.candidates[c];
+                    if (are_antiparallel(spin(i), spin(candidate.target))) {
+                        nearest = std::min(nearest, candidate.match);
+                    }
+                }
+                threshold = std::max(threshold, nearest);
+            }
+            survival[op] = threshold;
+        }
+
+        // Pair thresholds per magnetic site, collected as in check_orbit() over pairs i < j
+        OrbitThresholds entry;
+        entry.first_site = thresholds.sites.size();
+        const size_t first_interval = thresholds.intervals.size();
+        slot.assign(n, -1);
+        for (size_t i = 0; i < n; ++i) {
+            if (spin(i) == SpinType::NONE) continue;
+            slot[i] = static_cast<int>(thresholds.sites.size() - entry.first_site);
+            thresholds.sites.emplace_back();
+        }
+        thread_local std::vector<double> pair_symmetric;
+        pair_symmetric.assign(n, NEVER);
+        for (size_t i = 0; i < n; ++i) {
+            if (spin(i) == SpinType::NONE) continue;
+            for (size_t op = 0; op < num_ops; ++op) {
+                if (survival[op] == NEVER) continue;
+                for (uint32_t c = orbit.first[i * num_ops + op]; c < orbit.first[i * num_ops + op + 1]; ++c) {
+                    const Candidate& candidate = orbit.candidates[c];
+                    const size_t j = candidate.target;
+                    if (j < i || !are_antiparallel(spin(i), spin(j))) continue;
+                    const double matched = std::max(candidate.match, survival[op]);
+                    pair_symmetric[i] = std::min(pair_symmetric[i], matched);
+                    pair_symmetric[j] = std::min(pair_symmetric[j], matched);
+
+                    const double low = std::max(candidate.related, survival[op]);
+                    if (low == NEVER) continue;
+                    if (op_kind_[op] == OpKind::INVERSION) {
+                        SitePairing* base = thresholds.sites.data() + entry.first_site;
+                        base[slot[i]].ray = std::min(base[slot[i]].ray, low);
+                        base[slot[j]].ray = std::min(base[slot[j]].ray, low);
+                    } else if (low < translation_length_[op]) {
+                        thresholds.intervals.push_back({static_cast<size_t>(slot[i]), low, translation_length_[op]});
+                        thresholds.intervals.push_back({static_cast<size_t>(slot[j]), low, translation_length_[op]});
+                    }
+                }
+            }
+        }
+        entry.symmetric = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            if (spin(i) != SpinType::NONE) entry.symmetric = std::max(entry.symmetric, pair_symmetric[i]);
+        }
+        entry.end_site = thresholds.sites.size();
+        if (entry.symmetric == NEVER) {
+            // No tolerance below the largest listed one pairs every site: never altermagnetic
+            thresholds.sites.resize(entry.first_site);
+            thresholds.intervals.resize(first_interval);
+            continue;
+        }
+
+        // Group the orbit's intervals by site
+        std::sort(thresholds.intervals.begin() + first_interval, thresholds.intervals.end(),
+                  [](const Interval& a, const Interval& b) { return a.site < b.site; });
+        for (size_t k = first_interval; k < thresholds.intervals.size(); ++k) {
+            SitePairing& site = thresholds.sites[entry.first_site + thresholds.intervals[k].site];
+            if (site.end_interval == 0) site.first_interval = k;
+            site.end_interval = k + 1;
+        }
+        thresholds.orbits.push_back(entry);
+    }
+
+    uint64_t verdicts = 0;
+    for (size_t k = 0; k < tolerances_.size(); ++k) {
+        if (thresholds.altermagnet_at(tolerances_[k])) verdicts |= static_cast<uint64_t>(1) << k;
+    }
+    if (!flips) return verdicts;
+
+    for (size_t k = 0; k + 1 < tolerances_.size(); ++k) {
+        const double lower = tolerances_[k];
+        const double upper = tolerances_[k + 1];
+        if (((verdicts >> k) & 1) == ((verdicts >> (k + 1)) & 1)) continue;
+
+        // The verdict can only change at a threshold; collect those in between
+        thread_local std::vector<double> points;
+        points.clear();
+        auto consider = [&](double value) {
+            if (value > lower && value < upper) points.push_back(value);
+        };
+        for (const OrbitThresholds& orbit : thresholds.orbits) consider(orbit.symmetric);
+        for (const SitePairing& site : thresholds.sites) consider(site.ray);
+        for (const Interval& interval : thresholds.intervals) {
+            consider(interval.low);
+            consider(interval.high);
+        }
+        std::sort(points.begin(), points.end());
+        points.erase(std::unique(points.begin(), points.end()), points.end());
+
+        // Walk lower, then (midpoint, threshold) per threshold, then (midpoint, upper). A change
+        // that shows up at a midpoint happens just above the point before it; one that shows up
+        // at a point (a translation length, excluded from its own interval) happens at the point
+        // itself, so the last tolerance with the old verdict is the double just below it.
+        double previous_point = lower;
+        bool previous = (verdicts >> k) & 1;
+        double flip = lower;
+        for (size_t p = 0; p <= points.size(); ++p) {
+            const double point = p < points.size() ? points[p] : upper;
+            const bool between = thresholds.altermagnet_at(previous_point + (point - previous_point) / 2.0);
+            if (between != previous) flip = previous_point;
+            const bool at = thresholds.altermagnet_at(point);
+            if (at != between) flip = std::nextafter(point, lower);
+            previous = at;
+            previous_point = point;
+        }
+        flips->push_back(flip);
+    }
+    return verdicts;
+}
+
+std::vector<double> parse_tolerance_list(const std::string& text) {
+    std::vector<double> tolerances;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        size_t used = 0;
+        double value = 0.0;
+        try {
+            value = std::stod(item, &used);
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        if (used != item.size()) {
+            throw std::invalid_argument("--tolerances: not a number: " + item);
+        }
+        tolerances.push_back(value);
+    }
+    std::sort(tolerances.begin(), tolerances.end());
+    tolerances.erase(std::unique(tolerances.begin(), tolerances.end()), tolerances.end());
+    if (tolerances.empty() || tolerances.size() > ToleranceSweep::MAX_TOLERANCES) {
+        throw std::invalid_argument("--tolerances takes 1 to " + std::to_string(ToleranceSweep::MAX_TOLERANCES) +
+                                    " comma-separated values");
+    }
+    if (tolerances.front() <= 0.0 || tolerances.back() >= 0.5) {
+        throw std::invalid_argument("--tolerances: values must lie between 0 and 0.5");
+    }
+    return tolerances;
+}
+
+} // namespace amcheck
@@ -5,9 +5,13 @@
 #endif
 #include <iostream>
 #include <iomanip>
+#include <cstdio>
 
 #ifdef _WIN32
     #include <windows.h>
+    #include <io.h>
+#else
+    #include <unistd.h>
 #endif
 
 namespace amcheck {
@@ -33,6 +37,38 @@ bool should_use_unicode() {
 #endif
 }
 
+// Batch jobs run with stdin redirected or closed; prompting there would block forever
+bool stdin_is_interactive() {
+#ifdef _WIN32
+    return _isatty(_fileno(stdin)) != 0;
+#else
+    return isatty(fileno(stdin)) != 0;
+#endif
+}
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
 void print_banner() {
     std::cout << "\n";
     
@@ -168,12 +204,52 @@ void print_usage(const std::string& program_name) {
         std::cout << "   --version          Show version and credits\n";
         std::cout << "   -s, --symprec      Symmetry precision (default: " << DEFAULT_TOLERANCE << ")\n";
         std::cout << "   -t, --tolerance    Numerical tolerance (default: " << DEFAULT_TOLERANCE << ")\n";
+        std::cout << "   --tolerances <l>   With -a: verdicts at every tolerance in l (e.g. 1e-4,1e-3,1e-2) in one pass\n";
         std::cout << "   -a, --search-all   Search all possible spin configurations (multithreaded)\n";
+        std::cout << "   --engine <name>    Search engine for -a: table (default) or reference\n";
+        std::cout << "   --no-gray          With -a: test ids in natural order instead of the incremental Gray-code walk\n";
+        std::cout << "   --spins <p|file>   Standard mode without prompts: u/d/n per atom or per magnetic atom\n";
+        std::cout << "   --magmom <file>    Spins from INCAR MAGMOM, OUTCAR final magnetization or vasprun.xml\n";
+        std::cout << "   --moment-threshold |m| below this (muB) counts as non-magnetic (default: 0.5)\n";
+        std::cout << "   --plan             Like -a, but only print configuration counts and runtime estimates\n";
+        std::cout << "   --exists           Like -a, but decide exactly (SAT solver) whether any ordering is altermagnetic\n";
+        std::cout << "   --sat-proof <stem> With --exists: write <stem>.cnf and the solver's DRAT proof <stem>.drat\n";
+        std::cout << "   --ternary          With -a: sites may also be non-magnetic (balanced up/down/none patterns)\n";
+        std::cout << "   --no-dedup         With --ternary: keep symmetry-equivalent patterns\n";
+        std::cout << "   --keep-duplicates  With -a and several inputs: also search files that repeat a structure\n";
+        std::cout << "   --constrain <s>    With -a: only patterns obeying s, e.g. \"fix 1:u; antiparallel 1 2; layers c\"\n";
+        std::cout << "   --constraints <f>  Read constraint statements from a file (fix, parallel, antiparallel,\n";
+        std::cout << "                      layers, ferro-orbit)\n";
+        std::cout << "   --verify-patterns <file>  Check every spin pattern in a results, text or packed file\n";
+        std::cout << "   --verify-output <file>    Verdict file for --verify-patterns (default: generated name)\n";
+        std::cout << "   --distort <file>          Check the --spins/--magmom pattern under displacement, strain or tilt modes\n";
+        std::cout << "   --amplitudes <list>       Mode amplitudes for --distort: a,b,c or start:stop:count (default: 0:1:11)\n";
+        std::cout << "   --substitute <h:d:n>      Search spins on the symmetry-distinct ways to put dopant d on n (or n-m) host h sites\n";
+        std::cout << "   --serve-stdio             Answer JSON-lines check/search requests on stdin (no input files)\n";
+        std::cout << "   --watch <dir>             Analyze POSCAR/CONTCAR, OUTCAR or BAND.dat files as they are written\n";
+        std::cout << "   --watch-summary <file>    Watch summary file (default: <dir>/amcheck_watch_summary.tsv)\n";
+        std::cout << "   --watch-once              Analyze the current contents of the --watch directory, then exit\n";
+        std::cout << "   --watch-poll <s>          Scan the --watch directory every s seconds instead of using inotify\n";
+        std::cout << "   --magnetic <list>  Only these elements carry spins, e.g. Fe,Mn (default: built-in list)\n";
+        std::cout << "   --magnetic-orbits  Only these orbits carry spins, e.g. 2,3 (numbers as printed by --plan)\n";
+        std::cout << "   --moments <list>   Moment priors in Bohr magnetons, e.g. O=0,Fe=4.5; below 0.5 = non-magnetic\n";
+        std::cout << "   -j, --threads <n>  Worker threads for -a (default: AMCHECK_NUM_THREADS or the CPUs\n";
+        std::cout << "                      allowed by the affinity mask and cgroup quota)\n";
+        std::cout << "   --pin-threads      Pin each search worker to its own CPU (Linux)\n";
+        std::cout << "   --time-budget <s>  With -a: stop after s seconds and report the partial result\n";
+        std::cout << "   --max-configs <n>  With -a: test at most n configurations (evenly spread)\n";
+        std::cout << "   --on-large <mode>  Over 20 magnetic atoms: ask (default), sample, exhaustive, abort\n";
+        std::cout << "   -q, --quiet        With -a: no per-hit or progress output while searching\n";
+        std::cout << "   --status-file <p>  With -a: keep a JSON status file (or named pipe) updated\n";
+        std::cout << "   --status-interval  Seconds between status updates (default: 1)\n";
         std::cout << "   -b, --band-analysis  Analyze BAND.dat file for altermagnetism with splitting arrows\n";
         std::cout << "   --band-threshold   Threshold for band analysis (default: 0.01 eV)\n";
         std::cout << "   --xmin, --xmax     Set custom X-axis limits for band plots (default: auto)\n";
         std::cout << "   --ymin, --ymax     Set custom Y-axis limits for band plots (default: auto)\n";
         std::cout << "   --ahc              Analyze Anomalous Hall Coefficient\n";
+        std::cout << "   --profile <file>   Write per-phase and per-thread wall/CPU times as JSON\n";
+        std::cout << "   --trace <file>     Write a Chrome trace-event file (chrome://tracing, Perfetto)\n";
+        std::cout << "   --perf-counters    Report IPC and cache/branch misses per configuration (Linux)\n";
 #ifdef HAVE_CUDA
         std::cout << "   --gpu              Enable GPU acceleration (currently disabled, falls back to CPU)\n";
         std::cout << "   --cpu, --no-gpu    Force CPU-only computation\n";
@@ -186,6 +262,7 @@ void print_usage(const std::string& program_name) {
         std::cout << "   " << program_name << " POSCAR                    # Basic altermagnet check\n";
         std::cout << "   " << program_name << " -v --symprec 1e-5 POSCAR  # Verbose with custom precision\n";
         std::cout << "   " << program_name << " -a POSCAR                 # Search all spin configurations\n";
+        std::cout << "   " << program_name << " -a --engine reference POSCAR  # Search with the original checker\n";
         std::cout << "   " << program_name << " -b BAND.dat               # Analyze band structure for altermagnetism\n";
         std::cout << "   " << program_name << " -b --band-threshold 0.05 BAND.dat  # Band analysis with custom threshold\n";
         std::cout << "   " << program_name << " -b --xmin 0 --xmax 1 --ymin -5 --ymax 5 BAND.dat  # With custom plot axes\n";
@@ -214,12 +291,52 @@ void print_usage(const std::string& program_name) {
         std::cout << "   --version          Show version and credits\n";
         std::cout << "   -s, --symprec      Symmetry precision (default: " << DEFAULT_TOLERANCE << ")\n";
         std::cout << "   -t, --tolerance    Numerical tolerance (default: " << DEFAULT_TOLERANCE << ")\n";
+        std::cout << "   --tolerances <l>   With -a: verdicts at every tolerance in l (e.g. 1e-4,1e-3,1e-2) in one pass\n";
         std::cout << "   -a, --search-all   Search all possible spin configurations (multithreaded)\n";
+        std::cout << "   --engine <name>    Search engine for -a: table (default) or reference\n";
+        std::cout << "   --no-gray          With -a: test ids in natural order instead of the incremental Gray-code walk\n";
+        std::cout << "   --spins <p|file>   Standard mode without prompts: u/d/n per atom or per magnetic atom\n";
+        std::cout << "   --magmom <file>    Spins from INCAR MAGMOM, OUTCAR final magnetization or vasprun.xml\n";
+        std::cout << "   --moment-threshold |m| below this (muB) counts as non-magnetic (default: 0.5)\n";
+        std::cout << "   --plan             Like -a, but only print configuration counts and runtime estimates\n";
+        std::cout << "   --exists           Like -a, but decide exactly (SAT solver) whether any ordering is altermagnetic\n";
+        std::cout << "   --sat-proof <stem> With --exists: write <stem>.cnf and the solver's DRAT proof <stem>.drat\n";
+        std::cout << "   --ternary          With -a: sites may also be non-magnetic (balanced up/down/none patterns)\n";
+        std::cout << "   --no-dedup         With --ternary: keep symmetry-equivalent patterns\n";
+        std::cout << "   --keep-duplicates  With -a and several inputs: also search files that repeat a structure\n";
+        std::cout << "   --constrain <s>    With -a: only patterns obeying s, e.g. \"fix 1:u; antiparallel 1 2; layers c\"\n";
+        std::cout << "   --constraints <f>  Read constraint statements from a file (fix, parallel, antiparallel,\n";
+        std::cout << "                      layers, ferro-orbit)\n";
+        std::cout << "   --verify-patterns <file>  Check every spin pattern in a results, text or packed file\n";
+        std::cout << "   --verify-output <file>    Verdict file for --verify-patterns (default: generated name)\n";
+        std::cout << "   --distort <file>          Check the --spins/--magmom pattern under displacement, strain or tilt modes\n";
+        std::cout << "   --amplitudes <list>       Mode amplitudes for --distort: a,b,c or start:stop:count (default: 0:1:11)\n";
+        std::cout << "   --substitute <h:d:n>      Search spins on the symmetry-distinct ways to put dopant d on n (or n-m) host h sites\n";
+        std::cout << "   --serve-stdio             Answer JSON-lines check/search requests on stdin (no input files)\n";
+        std::cout << "   --watch <dir>             Analyze POSCAR/CONTCAR, OUTCAR or BAND.dat files as they are written\n";
+        std::cout << "   --watch-summary <file>    Watch summary file (default: <dir>/amcheck_watch_summary.tsv)\n";
+        std::cout << "   --watch-once              Analyze the current contents of the --watch directory, then exit\n";
+        std::cout << "   --watch-poll <s>          Scan the --watch directory every s seconds instead of using inotify\n";
+        std::cout << "   --magnetic <list>  Only these elements carry spins, e.g. Fe,Mn (default: built-in list)\n";
+        std::cout << "   --magnetic-orbits  Only these orbits carry spins, e.g. 2,3 (numbers as printed by --plan)\n";
+        std::cout << "   --moments <list>   Moment priors in Bohr magnetons, e.g. O=0,Fe=4.5; below 0.5 = non-magnetic\n";
+        std::cout << "   -j, --threads <n>  Worker threads for -a (default: AMCHECK_NUM_THREADS or the CPUs\n";
+        std::cout << "                      allowed by the affinity mask and cgroup quota)\n";
+        std::cout << "   --pin-threads      Pin each search worker to its own CPU (Linux)\n";
+        std::cout << "   --time-budget <s>  With -a: stop after s seconds and report the partial result\n";
+        std::cout << "   --max-configs <n>  With -a: test at most n configurations (evenly spread)\n";
+        std::cout << "   --on-large <mode>  Over 20 magnetic atoms: ask (default), sample, exhaustive, abort\n";
+        std::cout << "   -q, --quiet        With -a: no per-hit or progress output while searching\n";
+        std::cout << "   --status-file <p>  With -a: keep a JSON status file (or named pipe) updated\n";
+        std::cout << "   --status-interval  Seconds between status updates (default: 1)\n";
         std::cout << "   -b, --band-analysis  Analyze BAND.dat file for altermagnetism with splitting arrows\n";
         std::cout << "   --band-threshold   Threshold for band analysis (default: 0.01 eV)\n";
         std::cout << "   --xmin, --xmax     Set custom X-axis limits for band plots (default: auto)\n";
         std::cout << "   --ymin, --ymax     Set custom Y-axis limits for band plots (default: auto)\n";
         std::cout << "   --ahc              Analyze Anomalous Hall Coefficient\n";
+        std::cout << "   --profile <file>   Write per-phase and per-thread wall/CPU times as JSON\n";
+        std::cout << "   --trace <file>     Write a Chrome trace-event file (chrome://tracing, Perfetto)\n";
+        std::cout << "   --perf-counters    Report IPC and cache/branch misses per configuration (Linux)\n";
 #ifdef HAVE_CUDA
         std::cout << "   --gpu              Enable GPU acceleration (currently disabled, falls back to CPU)\n";
         std::cout << "   --cpu, --no-gpu    Force CPU-only computation\n";
@@ -232,6 +349,7 @@ void print_usage(const std::string& program_name) {
         std::cout << "   " << program_name << " POSCAR                    # Basic altermagnet check\n";
         std::cout << "   " << program_name << " -v --symprec 1e-5 POSCAR  # Verbose with custom precision\n";
         std::cout << "   " << program_name << " -a POSCAR                 # Search all spin configurations\n";
+        std::cout << "   " << program_name << " -a --engine reference POSCAR  # Search with the original checker\n";
         std::cout << "   " << program_name << " -b BAND.dat               # Analyze band structure for altermagnetism\n";
         std::cout << "   " << program_name << " -b --band-threshold 0.05 BAND.dat  # Band analysis with custom threshold\n";
         std::cout << "   " << program_name << " -b --xmin 0 --xmax 1 --ymin -5 --ymax 5 BAND.dat  # With custom plot axes\n";
@@ -0,0 +1,457 @@
+#include "watch_dir.h"
+#include "spin_constraints.h"
+#include "ternary_space.h"
+#include "worker_pool.h"
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace amcheck {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int) {
+    stop_requested = 1;
+}
+
+enum class FileKind { NONE, STRUCTURE, OUTCAR, BAND };
+
+bool starts_with(const std::string& s, const std::string& prefix) {
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+FileKind classify(const fs::path& path) {
+    const std::string name = path.filename().string();
+    // Auxiliary structures, result files and the summary itself
+    if (name.find("_amcheck") != std::string::npos || name.empty() || name[0] == '.') return FileKind::NONE;
+    if (starts_with(name, "POSCAR") || starts_with(name, "CONTCAR") ||
+        ends_with(name, ".vasp") || ends_with(name, ".poscar")) {
+        return FileKind::STRUCTURE;
+    }
+    if (name == "OUTCAR") return FileKind::OUTCAR;
+    if (starts_with(name, "BAND") && ends_with(name, ".dat")) return FileKind::BAND;
+    return FileKind::NONE;
+}
+
+// "path@size:mtime", or empty when the file is gone
+std::string file_signature(const fs::path& path) {
+    std::error_code error;
+    const auto size = fs::file_size(path, error);
+    if (error) return "";
+    const auto modified = fs::last_write_time(path, error);
+    if (error) return "";
+    return path.string() + "@" + std::to_string(size) + ":" +
+           std::to_string(static_cast<long long>(modified.time_since_epoch().count()));
+}
+
+fs::path sibling(const fs::path& path, std::initializer_list<const char*> names) {
+    for (const char* name : names) {
+        const fs::path candidate = path.parent_path() / name;
+        std::error_code error;
+        if (fs::is_regular_file(candidate, error)) return candidate;
+    }
+    return fs::path();
+}
+
+const char* analysis_name(WatchAnalysis analysis) {
+    switch (analysis) {
+        case WatchAnalysis::STANDARD: return "standard";
+        case WatchAnalysis::SEARCH: return "search";
+        case WatchAnalysis::BAND: return "band";
+    }
+    return "standard";
+}
+
+struct WatchJob {
+    fs::path input;            // structure or BAND.dat
+    SpinSource spins;          // standard analysis
+    std::string key;
+    std::string skip_reason;   // recorded instead of analyzing
+};
+
+struct JobResult {
+    std::string result;        // altermagnet, not_altermagnet, invalid, skipped or error
+    std::string details;
+};
+
+class Watcher {
+public:
+    explicit Watcher(const WatchOptions& options)
+        : options_(options),
+          summary_file_(options.summary_file.empty()
+                            ? (fs::path(options.directory) / "amcheck_watch_summary.tsv").string()
+                            : options.summary_file),
+          pool_(options.analysis == WatchAnalysis::SEARCH ? 1 : resolve_thread_count(options.search.num_threads),
+                256) {
+        load_summary();
+    }
+
+    void run() {
+        std::cout << "Watching " << options_.directory << " (" << analysis_name(options_.analysis)
+                  << " analysis, " << done_.size() << " jobs already in " << summary_file_ << ")\n";
+        scan(options_.directory, true);
+        if (!options_.once) {
+#ifdef __linux__
+            if (!options_.poll && watch_inotify()) {
+                pool_.finish();
+                return;
+            }
+#endif
+            watch_polling();
+        }
+        pool_.finish();
+    }
+
+private:
+    void load_summary() {
+        std::ifstream in(summary_file_);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            done_.insert(line.substr(line.find_last_of('\t') + 1));
+        }
+    }
+
+    // Turns a finished file into a job, or returns false when it is not one
+    bool make_job(const fs::path& path, WatchJob& job) {
+        const FileKind kind = classify(path);
+        const WatchAnalysis analysis = options_.analysis;
+        std::string moments_signature;
+
+        if (analysis == WatchAnalysis::BAND) {
+            if (kind != FileKind::BAND) return false;
+            job.input = path;
+        } else if (kind == FileKind::STRUCTURE) {
+            // A run directory with an OUTCAR is analyzed once the OUTCAR is complete; CONTCAR is
+            // rewritten at every ionic step until then
+            if (!sibling(path, {"OUTCAR"}).empty()) return false;
+            job.input = path;
+            if (analysis == WatchAnalysis::STANDARD) {
+                job.spins = options_.spins;
+                if (job.spins.empty()) {
+                    const fs::path moments = sibling(path, {"vasprun.xml", "INCAR"});
+                    if (moments.empty()) {
+                        job.skip_reason = "no spins: use --spins/--magmom or add OUTCAR, vasprun.xml or INCAR";
+                    } else {
+                        job.spins.moments_file = moments.string();
+                        moments_signature = file_signature(moments);
+                    }
+                }
+            }
+        } else if (kind == FileKind::OUTCAR) {
+            job.input = sibling(path, {"CONTCAR", "POSCAR"});
+            if (job.input.empty()) {
+                job.input = path;
+                job.skip_reason = "no CONTCAR or POSCAR next to OUTCAR";
+            } else if (analysis == WatchAnalysis::STANDARD) {
+                job.spins = options_.spins;
+                if (job.spins.empty()) {
+                    job.spins.moments_file = path.string();
+                    moments_signature = file_signature(path);
+                }
+            }
+        } else {
+            return false;
+        }
+
+        const std::string input_signature = file_signature(job.input);
+        if (input_signature.empty()) return false;
+        job.key = std::string(analysis_name(analysis)) + "|" + input_signature;
+        if (!moments_signature.empty()) job.key += "|" + moments_signature;
+        return true;
+    }
+
+    void consider(const fs::path& path) {
+        WatchJob job;
+        if (!make_job(path, job) || !done_.insert(job.key).second) return;
+        pool_.submit([this, job] { record(job, job.skip_reason.empty() ? analyze(job) : JobResult{"skipped", job.skip_reason}); });
+    }
+
+    void scan(const fs::path& root, bool immediate) {
+        std::error_code error;
+        for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, error), end;
+             !error && it != end; it.increment(error)) {
+            std::error_code type_error;
+            if (!it->is_regular_file(type_error) || classify(it->path()) == FileKind::NONE) continue;
+            if (immediate) {
+                consider(it->path());
+                continue;
+            }
+            // Polling: a file is finished once it looks the same in two consecutive scans
+            const std::string signature = file_signature(it->path());
+            std::string& previous = last_seen_[it->path().string()];
+            if (signature == previous) {
+                consider(it->path());
+            } else {
+                previous = signature;
+            }
+        }
+    }
+
+    void watch_polling() {
+        std::cout << "Polling every " << options_.poll_interval_s << " s\n";
+        while (!stop_requested) {
+            const auto wake = std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(options_.poll_interval_s));
+            while (!stop_requested && std::chrono::steady_clock::now() < wake) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            if (!stop_requested) scan(options_.directory, false);
+        }
+    }
+
+#ifdef __linux__
+    // False when inotify is unavailable, so the caller falls back to polling
+    bool watch_inotify() {
+        const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) return false;
+
+        std::map<int, fs::path> directories;
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+        auto add_tree = [&](const fs::path& root) {
+            auto add = [&](const fs::path& dir) {
+                const int wd = inotify_add_watch(fd, dir.c_str(), mask);
+                if (wd >= 0) {
+                    directories[wd] = dir;
+                } else {
+                    std::cerr << "Warning: cannot watch " << dir.string() << " (" << std::strerror(errno) << ")\n";
+                }
+            };
+            add(root);
+            std::error_code error;
+            for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, error), end;
+                 !error && it != end; it.increment(error)) {
+                std::error_code type_error;
+                if (it->is_directory(type_error)) add(it->path());
+            }
+        };
+        add_tree(options_.directory);
+        // Files finished between the initial scan and the watches being in place
+        scan(options_.directory, true);
+        std::cout << "Watching " << directories.size() << " director" << (directories.size() == 1 ? "y" : "ies")
+                  << " with inotify\n";
+
+        alignas(struct inotify_event) char buffer[64 * 1024];
+        while (!stop_requested) {
+            pollfd ready{fd, POLLIN, 0};
+            if (::poll(&ready, 1, 500) <= 0) continue;
+            const ssize_t length = ::read(fd, buffer, sizeof(buffer));
+            for (ssize_t offset = 0; length > 0 && offset < length;) {
+                const auto* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    scan(options_.directory, true);
+                    continue;
+                }
+                if (event->mask & IN_IGNORED) {
+                    directories.erase(event->wd);
+                    continue;
+                }
+                const auto dir = directories.find(event->wd);
+                if (dir == directories.end() || event->len == 0) continue;
+                const fs::path path = dir->second / event->name;
+
+                if (event->mask & IN_ISDIR) {
+                    // New run directory: watch it and pick up anything written before the watch
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                        add_tree(path);
+                        scan(path, true);
+                    }
+                } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    consider(path);
+                }
+            }
+        }
+        close(fd);
+        return true;
+    }
+#endif
+
+    JobResult analyze(const WatchJob& job) {
+        try {
+            switch (options_.analysis) {
+                case WatchAnalysis::STANDARD: return analyze_standard(job);
+                case WatchAnalysis::SEARCH: return analyze_search(job);
+                case WatchAnalysis::BAND: return analyze_band(job);
+            }
+        } catch (const std::exception& e) {
+            return {"error", e.what()};
+        }
+        return {"error", "unknown analysis"};
+    }
+
+    JobResult analyze_standard(const WatchJob& job) {
+        const std::string filename = job.input.string();
+        CrystalStructure structure;
+        structure.read_from_file(filename);
+        analyze_symmetry(structure, options_.symprec);
+
+        std::string moments_path;
+        const std::vector<SpinType> spins =
+            spins_from_source(structure, job.spins, options_.search.magnetic, filename, &moments_path);
+        std::vector<std::string> chemical_symbols;
+        for (const auto& atom : structure.atoms) chemical_symbols.push_back(atom.chemical_symbol);
+
+        size_t up = 0, down = 0;
+        for (SpinType spin : spins) {
+            up += spin == SpinType::UP;
+            down += spin == SpinType::DOWN;
+        }
+        std::ostringstream details;
+        details << "spins from " << (moments_path.empty() ? "--spins" : moments_path)
+                << " (" << up << " up, " << down << " down)";
+
+        try {
+            const bool is_am = is_altermagnet(structure.symmetry_operations, structure.get_all_scaled_positions(),
+                                              structure.equivalent_atoms, chemical_symbols, spins,
+                                              options_.tolerance, false, true);
+            return {is_am ? "altermagnet" : "not_altermagnet", details.str()};
+        } catch (const std::invalid_argument& e) {
+            return {"invalid", details.str() + "; " + e.what()};
+        }
+    }
+
+    JobResult analyze_search(const WatchJob& job) {
+        const std::string filename = job.input.string();
+        CrystalStructure structure;
+        structure.read_from_file(filename);
+        analyze_symmetry(structure, options_.symprec);
+
+        const std::vector<size_t> magnetic_indices = get_magnetic_atom_indices(structure, options_.search.magnetic);
+        if (magnetic_indices.empty()) return {"skipped", "no magnetic atoms"};
+
+        SearchOptions run = options_.search;
+        run.quiet = true;
+        run.status_file.clear();
+        // Unattended: a large space is sampled unless --on-large says otherwise
+        if (run.max_configurations == 0 && magnetic_indices.size() > LARGE_SEARCH_MAGNETIC_ATOMS) {
+            if (run.on_large == LargeSearchPolicy::ABORT) {
+                return {"skipped", std::to_string(magnetic_indices.size()) + " magnetic atoms (--on-large abort)"};
+            }
+            if (run.on_large != LargeSearchPolicy::EXHAUSTIVE) {
+                run.spread_order = true;
+                run.max_configurations = DEFAULT_SAMPLE_CONFIGURATIONS;
+            }
+        }
+
+        std::unique_ptr<TernarySpace> ternary;
+        std::unique_ptr<ConstrainedSpace> constrained;
+        size_t space_size = 0;
+        if (run.ternary) {
+            ternary = std::make_unique<TernarySpace>(structure, magnetic_indices, options_.tolerance, run.symmetry_dedup);
+            space_size = ternary->size();
+        } else if (!run.constraints.empty()) {
+            constrained = std::make_unique<ConstrainedSpace>(structure, magnetic_indices, run.constraints);
+            space_size = constrained->size();
+        } else if (magnetic_indices.size() < 64) {
+            space_size = static_cast<size_t>(1) << magnetic_indices.size();
+        }
+
+        SearchProgress final_progress;
+        const std::vector<SpinConfiguration> found = run_spin_search(
+            structure, magnetic_indices, options_.tolerance, run, nullptr,
+            [&final_progress](const SearchProgress& progress) {
+                if (progress.finished) final_progress = progress;
+            },
+            ternary.get(), constrained.get());
+
+        std::ostringstream details;
+        details << found.size() << " of " << final_progress.completed << " configurations";
+        if (final_progress.completed < space_size) details << " (space " << space_size << ")";
+        if (!found.empty()) {
+            const fs::path results = job.input.parent_path() /
+                (output_file_stem(filename) + "_amcheck_results_" + output_timestamp() + ".txt");
+            write_search_results(results.string(), structure, found, final_progress.completed, options_.tolerance,
+                                 "CPU (watch)", space_size, ternary.get());
+            details << "; " << results.string();
+        }
+        return {found.empty() ? "not_altermagnet" : "altermagnet", details.str()};
+    }
+
+    JobResult analyze_band(const WatchJob& job) {
+        const BandAnalysisResult result = analyze_band_file(job.input.string(), options_.band_threshold, false);
+        std::ostringstream details;
+        details << "max splitting " << result.max_overall_difference << " eV (band "
+                << result.max_difference_band_index + 1 << ", threshold " << options_.band_threshold << " eV)";
+        return {result.is_altermagnetic_by_bands ? "altermagnet" : "not_altermagnet", details.str()};
+    }
+
+    // Appends one summary line and echoes it; the file is reopened per line so it can be rotated
+    void record(const WatchJob& job, const JobResult& result) {
+        std::lock_guard<std::mutex> lock(summary_mutex_);
+        const std::time_t now = std::time(nullptr);
+        std::ostringstream time;
+        time << std::put_time(std::localtime(&now), "%Y-%m-%d %H:%M:%S");
+
+        std::error_code error;
+        const bool fresh = !fs::exists(summary_file_, error) || fs::file_size(summary_file_, error) == 0;
+        std::ofstream out(summary_file_, std::ios::app);
+        if (fresh) {
+            out << "# AMCheck C++ - watch summary for " << options_.directory << "\n";
+            out << "# Time\tAnalysis\tInput\tResult\tDetails\tKey\n";
+        }
+        out << time.str() << '\t' << analysis_name(options_.analysis) << '\t' << job.input.string() << '\t'
+            << result.result << '\t' << result.details << '\t' << job.key << '\n';
+        if (!out) std::cerr << "Warning: could not append to " << summary_file_ << "\n";
+
+        std::cout << "[" << time.str() << "] " << job.input.string() << ": " << result.result
+                  << " (" << result.details << ")\n" << std::flush;
+    }
+
+    const WatchOptions& options_;
+    const std::string summary_file_;
+    std::set<std::string> done_;                    // job keys analyzed or queued
+    std::map<std::string, std::string> last_seen_;  // polling: signature from the previous scan
+    std::mutex summary_mutex_;
+    WorkerPool pool_;
+};
+
+} // namespace
+
+void watch_directory(const WatchOptions& options) {
+    std::error_code error;
+    if (!fs::is_directory(options.directory, error)) {
+        throw std::invalid_argument("--watch: not a directory: " + options.directory);
+    }
+
+    stop_requested = 0;
+    const auto previous_int = std::signal(SIGINT, request_stop);
+    const auto previous_term = std::signal(SIGTERM, request_stop);
+
+    Watcher(options).run();
+
+    std::signal(SIGINT, previous_int);
+    std::signal(SIGTERM, previous_term);
+}
+
+} // namespace amcheck
@@ -0,0 +1,839 @@
+// Differential fuzzer: random symmetry groups, orbits and spin patterns are fed to every
+// evaluation path and the verdicts are compared against the reference is_altermagnet().
+//
+// Checked per iteration:
+//   * AltermagnetChecker::evaluate() vs is_altermagnet() (an exception counts as INVALID)
+//   * the tolerance sweep (--tolerances) vs one checker per tolerance, and its flip tolerances
+//     vs checkers at and just above each flip
+//   * run_spin_search() with every engine, several thread counts and all visiting orders vs a
+//     serial reference enumeration (every --search-every iterations, small structures only)
+//   * constrained searches (random fix/parallel/antiparallel statements) vs the serial
+//     reference filtered by the same relations
+//   * the SAT existence query (--exists), with and without those statements, vs whether the
+//     reference found anything; a witness must be altermagnetic for is_altermagnet() too
+//   * the same for the ternary search, and for closed groups its symmetry-deduplicated result
+//     expanded by the site permutations and spin reversal (at most 7 magnetic sites)
+//   * distortion sweeps (--distort): at amplitude 0 and under isotropic strain every operation
+//     is kept and the verdict is the parent's
+//   * site substitution (--substitute): decoration multiplicities add up to the number of
+//     subsets, and replacing a whole orbit keeps every operation
+//
+// On the first disagreement the case is shrunk greedily (drop operations, orbits, sites,
+// magnetic moments) and the minimal counterexample is printed with the seed that reproduces
+// it. The process exits with status 1 so it can gate CI scripts.
+
+#include "amcheck.h"
+#include "altermagnet_checker.h"
+#include "altermagnet_sat.h"
+#include "distortion_sweep.h"
+#include "site_symmetry.h"
+#include "spin_constraints.h"
+#include "substitution.h"
+#include "ternary_space.h"
+#include "tolerance_sweep.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <random>
+#include <set>
+#include <stdexcept>
+
+using namespace amcheck;
+
+namespace {
+
+struct FuzzArguments {
+    uint64_t seed = 1;
+    size_t iterations = 2000;
+    double tolerance = DEFAULT_TOLERANCE;
+    size_t max_sites = 16;
+    size_t search_every = 10;
+    size_t max_search_sites = 10;
+    bool verbose = false;
+};
+
+struct FuzzCase {
+    std::vector<SymmetryOperation> symops;
+    std::vector<Vector3d> positions;
+    std::vector<int> equiv_atoms;
+    std::vector<SpinType> spins;
+};
+
+void print_usage() {
+    std::cout << "Usage: amcheck_fuzz [OPTIONS]\n"
+              << "   --seed <n>               Seed for the random generator (default: 1)\n"
+              << "   --iterations <n>         Number of random cases (default: 2000)\n"
+              << "   -t, --tolerance <value>  Numerical tolerance (default: " << DEFAULT_TOLERANCE << ")\n"
+              << "   --max-sites <n>          Upper bound on sites per case (default: 16)\n"
+              << "   --search-every <n>       Cross-check full searches every n cases, 0 = never (default: 10)\n"
+              << "   --max-search-sites <n>   Magnetic sites per full search (default: 10)\n"
+              << "   -v, --verbose            Print a line per case\n";
+}
+
+FuzzArguments parse_arguments(int argc, char* argv[]) {
+    FuzzArguments args;
+
+    auto require_value = [&](int& i, const std::string& name) -> std::string {
+        if (i + 1 >= argc) {
+            throw std::invalid_argument(name + " requires a value");
+        }
+        return argv[++i];
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            print_usage();
+            std::exit(0);
+        } else if (arg == "--seed") {
+            args.seed = std::stoull(require_value(i, arg));
+        } else if (arg == "--iterations") {
+            args.iterations = std::stoull(require_value(i, arg));
+        } else if (arg == "-t" || arg == "--tolerance") {
+            args.tolerance = std::stod(require_value(i, arg));
+        } else if (arg == "--max-sites") {
+            args.max_sites = std::stoull(require_value(i, arg));
+        } else if (arg == "--search-every") {
+            args.search_every = std::stoull(require_value(i, arg));
+        } else if (arg == "--max-search-sites") {
+            args.max_search_sites = std::stoull(require_value(i, arg));
+        } else if (arg == "-v" || arg == "--verbose") {
+            args.verbose = true;
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+
+    if (args.max_sites == 0 || args.max_search_sites >= 20) {
+        throw std::invalid_argument("--max-sites must be positive and --max-search-sites below 20");
+    }
+    return args;
+}
+
+// ---------------------------------------------------------------------------------------
+// Random structures
+// ---------------------------------------------------------------------------------------
+
+Vector3d wrap(const Vector3d& v) {
+    Vector3d w;
+    for (int k = 0; k < 3; ++k) {
+        w[k] = v[k] - std::floor(v[k]);
+        if (w[k] > 1.0 - 1e-9) w[k] = 0.0;
+    }
+    return w;
+}
+
+bool same_operation(const SymmetryOperation& a, const SymmetryOperation& b) {
+    return (a.first - b.first).norm() < 1e-9 && bring_in_cell(a.second - b.second, 1e-9).norm() < 1e-9;
+}
+
+std::vector<SymmetryOperation> generator_pool() {
+    const Matrix3d I = Matrix3d::Identity();
+    Matrix3d c2z = Matrix3d::Zero(), c4z = Matrix3d::Zero(), c3 = Matrix3d::Zero(), c2xy = Matrix3d::Zero();
+    c2z.diagonal() << -1, -1, 1;
+    c4z << 0, -1, 0, 1, 0, 0, 0, 0, 1;
+    c3 << 0, 0, 1, 1, 0, 0, 0, 1, 0;        // 3-fold about [111]
+    c2xy << 0, 1, 0, 1, 0, 0, 0, 0, -1;     // 2-fold about [110]
+    Matrix3d mz = I;
+    mz(2, 2) = -1;
+
+    const Vector3d zero = Vector3d::Zero();
+    return {
+        {-I, zero},                          // inversion
+        {-I, Vector3d(0.5, 0.5, 0.5)},       // inversion off the origin
+        {c2z, zero},
+        {c2z, Vector3d(0.5, 0.0, 0.5)},      // screw
+        {c4z, zero},
+        {c4z, Vector3d(0.5, 0.5, 0.5)},      // rutile-like 4_2
+        {c3, zero},
+        {c2xy, zero},
+        {mz, zero},
+        {mz, Vector3d(0.5, 0.5, 0.0)},       // glide
+        {I, Vector3d(0.5, 0.5, 0.5)},        // body centering
+        {I, Vector3d(0.5, 0.5, 0.0)},        // C centering
+        {I, Vector3d(0.0, 0.0, 0.5)},        // doubled cell
+    };
+}
+
+std::vector<SymmetryOperation> random_group(std::mt19937_64& rng, size_t max_order) {
+    static const std::vector<SymmetryOperation> pool = generator_pool();
+    std::vector<SymmetryOperation> group = {{Matrix3d::Identity(), Vector3d::Zero()}};
+
+    const size_t num_generators = std::uniform_int_distribution<size_t>(0, 3)(rng);
+    for (size_t g = 0; g < num_generators; ++g) {
+        group.push_back(pool[std::uniform_int_distribution<size_t>(0, pool.size() - 1)(rng)]);
+    }
+
+    // Close under composition; incompatible generators may produce an infinite set, so cap it
+    for (size_t i = 0; i < group.size() && group.size() < max_order; ++i) {
+        for (size_t j = 0; j < group.size() && group.size() < max_order; ++j) {
+            SymmetryOperation product(group[i].first * group[j].first,
+                                      wrap(group[i].first * group[j].second + group[i].second));
+            bool known = false;
+            for (const auto& op : group) {
+                if (same_operation(op, product)) {
+                    known = true;
+                    break;
+                }
+            }
+            if (!known) group.push_back(product);
+        }
+    }
+    std::shuffle(group.begin() + 1, group.end(), rng);
+    return group;
+}
+
+Vector3d random_position(std::mt19937_64& rng) {
+    // Mix of general and special positions so both generic and degenerate orbits appear
+    static const double special[] = {0.0, 0.25, 0.5, 0.75, 1.0 / 3.0};
+    Vector3d p;
+    for (int k = 0; k < 3; ++k) {
+        if (std::uniform_int_distribution<int>(0, 2)(rng) == 0) {
+            p[k] = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        } else {
+            p[k] = special[std::uniform_int_distribution<int>(0, 4)(rng)];
+        }
+    }
+    return p;
+}
+
+SpinType random_spin(std::mt19937_64& rng) {
+    switch (std::uniform_int_distribution<int>(0, 4)(rng)) {
+        case 0: return SpinType::NONE;
+        case 1:
+        case 2: return SpinType::UP;
+        default: return SpinType::DOWN;
+    }
+}
+
+FuzzCase random_case(std::mt19937_64& rng, const FuzzArguments& args) {
+    FuzzCase c;
+    c.symops = random_group(rng, 48);
+
+    const size_t num_orbits = std::uniform_int_distribution<size_t>(1, 3)(rng);
+    for (size_t o = 0; o < num_orbits && c.positions.size() < args.max_sites; ++o) {
+        const Vector3d seed = random_position(rng);
+        const int label = static_cast<int>(c.positions.size());
+        std::vector<Vector3d> images;
+        for (const auto& [R, t] : c.symops) {
+            Vector3d image = wrap(R * seed + t);
+            bool known = false;
+            for (const auto& q : images) {
+                if (bring_in_cell(image - q, 1e-9).norm() < 1e-9) {
+                    known = true;
+                    break;
+                }
+            }
+            if (!known) images.push_back(image);
+        }
+        for (const auto& image : images) {
+            if (c.positions.size() >= args.max_sites) break;
+            c.positions.push_back(image);
+            c.equiv_atoms.push_back(label);
+        }
+    }
+
+    // Perturb some cases around the tolerance so near-boundary comparisons are exercised
+    if (std::uniform_int_distribution<int>(0, 3)(rng) == 0) {
+        std::uniform_real_distribution<double> noise(-args.tolerance, args.tolerance);
+        for (auto& p : c.positions) {
+            p += Vector3d(noise(rng), noise(rng), noise(rng));
+        }
+    }
+
+    // Drop operations: the checkers must not assume they receive a closed group
+    if (std::uniform_int_distribution<int>(0, 4)(rng) == 0 && c.symops.size() > 1) {
+        std::vector<SymmetryOperation> kept;
+        for (const auto& op : c.symops) {
+            if (std::uniform_int_distribution<int>(0, 2)(rng) != 0) kept.push_back(op);
+        }
+        c.symops = kept;
+    }
+
+    // Spin patterns: balanced per orbit most of the time, otherwise unconstrained
+    c.spins.assign(c.positions.size(), SpinType::NONE);
+    const bool balanced = std::uniform_int_distribution<int>(0, 3)(rng) != 0;
+    for (size_t i = 0; i < c.positions.size(); ++i) {
+        c.spins[i] = random_spin(rng);
+    }
+    if (balanced) {
+        std::vector<int> labels = c.equiv_atoms;
+        std::sort(labels.begin(), labels.end());
+        labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+        for (int label : labels) {
+            std::vector<size_t> sites;
+            for (size_t i = 0; i < c.equiv_atoms.size(); ++i) {
+                if (c.equiv_atoms[i] == label) sites.push_back(i);
+            }
+            std::shuffle(sites.begin(), sites.end(), rng);
+            const bool magnetic = std::uniform_int_distribution<int>(0, 4)(rng) != 0;
+            for (size_t k = 0; k < sites.size(); ++k) {
+                if (!magnetic) {
+                    c.spins[sites[k]] = SpinType::NONE;
+                } else if (sites.size() % 2 == 1 && k == sites.size() - 1) {
+                    c.spins[sites[k]] = SpinType::NONE;  // odd orbit: leave one site unpolarized
+                } else {
+                    c.spins[sites[k]] = (k % 2 == 0) ? SpinType::UP : SpinType::DOWN;
+                }
+            }
+        }
+    }
+    return c;
+}
+
+// ---------------------------------------------------------------------------------------
+// Evaluation paths
+// ---------------------------------------------------------------------------------------
+
+std::vector<std::string> placeholder_symbols(size_t n) {
+    return std::vector<std::string>(n, "Fe");
+}
+
+CheckOutcome reference_outcome(const FuzzCase& c, double tol) {
+    try {
+        return is_altermagnet(c.symops, c.positions, c.equiv_atoms, placeholder_symbols(c.positions.size()),
+                              c.spins, tol, false, true)
+            ? CheckOutcome::ALTERMAGNET : CheckOutcome::NOT_ALTERMAGNET;
+    } catch (const std::exception&) {
+        return CheckOutcome::INVALID;
+    }
+}
+
+CheckOutcome table_outcome(const FuzzCase& c, double tol) {
+    return AltermagnetChecker(c.symops, c.positions, c.equiv_atoms, tol).evaluate(c.spins);
+}
+
+bool outcomes_disagree(const FuzzCase& c, double tol) {
+    return reference_outcome(c, tol) != table_outcome(c, tol);
+}
+
+// ---------------------------------------------------------------------------------------
+// Shrinking
+// ---------------------------------------------------------------------------------------
+
+FuzzCase remove_site(const FuzzCase& c, size_t site) {
+    FuzzCase r = c;
+    r.positions.erase(r.positions.begin() + site);
+    r.equiv_atoms.erase(r.equiv_atoms.begin() + site);
+    r.spins.erase(r.spins.begin() + site);
+    return r;
+}
+
+FuzzCase shrink(FuzzCase c, double tol) {
+    bool progress = true;
+    while (progress) {
+        progress = false;
+
+        for (size_t k = 0; k < c.symops.size(); ++k) {
+            FuzzCase candidate = c;
+            candidate.symops.erase(candidate.symops.begin() + k);
+            if (outcomes_disagree(candidate, tol)) {
+                c = candidate;
+                progress = true;
+                --k;
+            }
+        }
+
+        std::vector<int> labels = c.equiv_atoms;
+        std::sort(labels.begin(), labels.end());
+        labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+        for (int label : labels) {
+            FuzzCase candidate = c;
+            for (size_t i = candidate.positions.size(); i-- > 0;) {
+                if (candidate.equiv_atoms[i] == label) candidate = remove_site(candidate, i);
+            }
+            if (!candidate.positions.empty() && outcomes_disagree(candidate, tol)) {
+                c = candidate;
+                progress = true;
+            }
+        }
+
+        for (size_t i = 0; i < c.positions.size() && c.positions.size() > 1; ++i) {
+            FuzzCase candidate = remove_site(c, i);
+            if (outcomes_disagree(candidate, tol)) {
+                c = candidate;
+                progress = true;
+                --i;
+            }
+        }
+
+        for (size_t i = 0; i < c.spins.size(); ++i) {
+            if (c.spins[i] == SpinType::NONE) continue;
+            FuzzCase candidate = c;
+            candidate.spins[i] = SpinType::NONE;
+            if (outcomes_disagree(candidate, tol)) {
+                c = candidate;
+                progress = true;
+            }
+        }
+    }
+    return c;
+}
+
+void print_case(std::ostream& out, const FuzzCase& c, double tol) {
+    out << std::setprecision(17);
+    out << "Symmetry operations (" << c.symops.size() << "):\n";
+    for (size_t k = 0; k < c.symops.size(); ++k) {
+        const auto& [R, t] = c.symops[k];
+        out << "  #" << k << " R = [";
+        for (int r = 0; r < 3; ++r) {
+            out << (r ? "; " : "") << R(r, 0) << " " << R(r, 1) << " " << R(r, 2);
+        }
+        out << "]  t = [" << t.transpose() << "]\n";
+    }
+    out << "Sites (" << c.positions.size() << "):\n";
+    for (size_t i = 0; i < c.positions.size(); ++i) {
+        out << "  " << i << ": [" << c.positions[i].transpose() << "]  orbit " << c.equiv_atoms[i]
+            << "  spin " << spin_to_string(c.spins[i]) << "\n";
+    }
+    out << "Reference: " << outcome_to_string(reference_outcome(c, tol))
+        << "   Table: " << outcome_to_string(table_outcome(c, tol)) << "\n";
+}
+
+// ---------------------------------------------------------------------------------------
+// Full-search cross-check
+// ---------------------------------------------------------------------------------------
+
+CrystalStructure to_structure(const FuzzCase& c) {
+    CrystalStructure structure;
+    structure.cell = Matrix3d::Identity();
+    for (size_t i = 0; i < c.positions.size(); ++i) {
+        structure.atoms.emplace_back(c.positions[i], "Fe", 26);
+    }
+    structure.equivalent_atoms = c.equiv_atoms;
+    structure.symmetry_operations = c.symops;
+    return structure;
+}
+
+std::vector<size_t> serial_reference_search(const FuzzCase& c, const std::vector<size_t>& magnetic_indices, double tol) {
+    std::vector<size_t> found;
+    std::vector<SpinType> spins(c.positions.size(), SpinType::NONE);
+    FuzzCase probe = c;
+    for (size_t id = 0; id < (static_cast<size_t>(1) << magnetic_indices.size()); ++id) {
+        decode_configuration_id(id, magnetic_indices, spins);
+        probe.spins = spins;
+        if (reference_outcome(probe, tol) == CheckOutcome::ALTERMAGNET) {
+            found.push_back(id);
+        }
+    }
+    return found;
+}
+
+// Ternary ids (digit i of magnetic site i: 0 = up, 1 = down, 2 = none) of every altermagnetic
+// pattern, by brute force over all 3^N patterns
+std::vector<size_t> serial_ternary_search(const FuzzCase& c, const std::vector<size_t>& magnetic_indices, double tol) {
+    static const SpinType states[3] = {SpinType::UP, SpinType::DOWN, SpinType::NONE};
+    size_t space = 1;
+    for (size_t i = 0; i < magnetic_indices.size(); ++i) space *= 3;
+
+    std::vector<size_t> found;
+    FuzzCase probe = c;
+    probe.spins.assign(c.positions.size(), SpinType::NONE);
+    for (size_t id = 0; id < space; ++id) {
+        for (size_t i = 0, rest = id; i < magnetic_indices.size(); ++i, rest /= 3) {
+            probe.spins[magnetic_indices[i]] = states[rest % 3];
+        }
+        if (reference_outcome(probe, tol) == CheckOutcome::ALTERMAGNET) {
+            found.push_back(id);
+        }
+    }
+    return found;
+}
+
+// Every image of the representatives under the site permutations and global spin reversal
+std::vector<size_t> expand_ternary_classes(const std::vector<size_t>& representatives,
+                                           const SitePermutationGroup& group, size_t num_sites) {
+    std::set<size_t> expanded;
+    for (size_t id : representatives) {
+        std::vector<size_t> digits(num_sites);
+        for (size_t i = 0, rest = id; i < num_sites; ++i, rest /= 3) digits[i] = rest % 3;
+        for (const auto& g : group.elements) {
+            for (int flip = 0; flip < 2; ++flip) {
+                size_t image = 0;
+                for (size_t i = 0, place = 1; i < num_sites; ++i, place *= 3) {
+                    // Site i of the image carries the digit of the site g maps onto i
+                    size_t source = 0;
+                    while (g[source] != i) ++source;
+                    const size_t d = digits[source];
+                    image += (flip && d < 2 ? 1 - d : d) * place;
+                }
+                expanded.insert(image);
+            }
+        }
+    }
+    return std::vector<size_t>(expanded.begin(), expanded.end());
+}
+
+std::string cross_check_ternary_search(const FuzzCase& c, const std::vector<size_t>& magnetic_indices, double tol) {
+    const CrystalStructure structure = to_structure(c);
+    const std::vector<size_t> expected = serial_ternary_search(c, magnetic_indices, tol);
+
+    auto found_ids = [&](SearchOptions options) {
+        options.ternary = true;
+        std::vector<size_t> ids;
+        for (const auto& config : run_spin_search(structure, magnetic_indices, tol, options)) {
+            ids.push_back(config.configuration_id);
+        }
+        return ids;
+    };
+
+    for (SearchEngine engine : {SearchEngine::REFERENCE, SearchEngine::TABLE}) {
+        for (unsigned int threads : {1u, 3u}) {
+            for (bool spread : {false, true}) {
+                SearchOptions options;
+                options.engine = engine;
+                options.num_threads = threads;
+                options.spread_order = spread;
+                options.symmetry_dedup = false;
+                const std::vector<size_t> ids = found_ids(options);
+                if (ids != expected) {
+                    std::ostringstream msg;
+                    msg << "ternary run_spin_search(engine=" << engine_to_string(engine) << ", threads=" << threads
+                        << (spread ? ", spread order" : "") << ") found " << ids.size()
+                        << " configurations, serial reference found " << expected.size()
+                        << " (" << magnetic_indices.size() << " magnetic sites)";
+                    return msg.str();
+                }
+            }
+        }
+    }
+
+    // Deduplication is only applied when the operations form a group and the geometry is
+    // symmetric within the tolerance
+    if (!TernarySpace(structure, magnetic_indices, tol, true).symmetry_dedup()) return "";
+    SearchOptions options;
+    options.num_threads = 2;
+    const std::vector<size_t> representatives = found_ids(options);
+    const std::vector<size_t> expanded = expand_ternary_classes(
+        representatives, magnetic_site_group(structure, magnetic_indices, tol), magnetic_indices.size());
+    if (expanded != expected) {
+        std::ostringstream msg;
+        msg << "deduplicated ternary search found " << representatives.size() << " representatives covering "
+            << expanded.size() << " configurations, serial reference found " << expected.size()
+            << " (" << magnetic_indices.size() << " magnetic sites)";
+        return msg.str();
+    }
+    return "";
+}
+
+// Existence query over exactly the fuzzer's magnetic sites: the other atoms become Zn and only
+// Fe is selected. Returns an empty string when it agrees with the enumeration.
+std::string cross_check_existence(const FuzzCase& c, const std::vector<size_t>& magnetic_indices,
+                                  bool expected, const std::string& constraints, double tol) {
+    CrystalStructure structure = to_structure(c);
+    for (auto& atom : structure.atoms) atom.chemical_symbol = "Zn";
+    for (size_t i : magnetic_indices) structure.atoms[i].chemical_symbol = "Fe";
+    SearchOptions options;
+    options.magnetic.species = {"Fe"};
+    options.constraints = constraints;
+
+    ExistenceResult result;
+    try {
+        result = find_altermagnetic_ordering(structure, tol, options);
+    } catch (const std::runtime_error& e) {
+        return std::string("existence query: ") + e.what();
+    }
+    const bool found = result.status == ExistenceStatus::WITNESS;
+    if (result.status == ExistenceStatus::UNKNOWN || found != expected) {
+        std::ostringstream msg;
+        msg << "existence query answered " << (found ? "exists" : result.status == ExistenceStatus::UNKNOWN ? "unknown" : "none")
+            << ", enumeration found " << (expected ? "altermagnets" : "none")
+            << " (" << magnetic_indices.size() << " magnetic sites)"
+            << (constraints.empty() ? "" : " for statements:\n" + constraints);
+        return msg.str();
+    }
+    if (found) {
+        FuzzCase probe = c;
+        probe.spins = result.spins;
+        if (reference_outcome(probe, tol) != CheckOutcome::ALTERMAGNET) {
+            return "existence witness rejected by is_altermagnet()";
+        }
+    }
+    return "";
+}
+
+// Random statements over the magnetic sites; each relation is also kept as (a, b, parity) with
+// b == SIZE_MAX for a fixed spin, so the expected result is filtered independently of the
+// union-find
+std::string cross_check_constrained_search(const FuzzCase& c, const std::vector<size_t>& magnetic_indices,
+                                           const std::vector<size_t>& expected, std::mt19937_64& rng, double tol) {
+    struct Relation { size_t a, b; int parity; };
+    std::vector<Relation> relations;
+    std::ostringstream spec;
+    const size_t n = magnetic_indices.size();
+    std::uniform_int_distribution<size_t> pick(0, n - 1);
+    const size_t count = std::uniform_int_distribution<size_t>(1, 3)(rng);
+    for (size_t k = 0; k < count; ++k) {
+        const size_t a = pick(rng), b = pick(rng);
+        const int kind = std::uniform_int_distribution<int>(0, 2)(rng);
+        if (kind == 0) {
+            const int down = std::uniform_int_distribution<int>(0, 1)(rng);
+            spec << "fix " << magnetic_indices[a] + 1 << ":" << (down ? "d" : "u") << "\n";
+            relations.push_back({a, SIZE_MAX, down});
+        } else if (a != b) {
+            spec << (kind == 1 ? "parallel " : "antiparallel ") << magnetic_indices[a] + 1 << " "
+                 << magnetic_indices[b] + 1 << "\n";
+            relations.push_back({a, b, kind == 2 ? 1 : 0});
+        }
+    }
+
+    std::vector<size_t> filtered;
+    for (size_t id : expected) {
+        bool allowed = true;
+        for (const auto& r : relations) {
+            const int bit_a = (id >> r.a) & 1;
+            const int bit_b = r.b == SIZE_MAX ? 0 : (id >> r.b) & 1;
+            allowed = allowed && (bit_a ^ bit_b) == r.parity;
+        }
+        if (allowed) filtered.push_back(id);
+    }
+
+    const CrystalStructure structure = to_structure(c);
+    SearchOptions options;
+    options.constraints = spec.str();
+    options.num_threads = 2;
+    options.spread_order = std::uniform_int_distribution<int>(0, 1)(rng) == 1;
+    std::vector<size_t> ids;
+    try {
+        for (const auto& config : run_spin_search(structure, magnetic_indices, tol, options)) {
+            ids.push_back(config.configuration_id);
+        }
+    } catch (const std::invalid_argument&) {
+        // Contradictory statements: every pattern violates one of them
+        return filtered.empty() ? "" : "constrained search rejected satisfiable statements:\n" + spec.str();
+    }
+    if (ids != filtered) {
+        std::ostringstream msg;
+        msg << "constrained search found " << ids.size() << " configurations, filtered reference found "
+            << filtered.size() << " for statements:\n" << spec.str();
+        return msg.str();
+    }
+    return cross_check_existence(c, magnetic_indices, !filtered.empty(), spec.str(), tol);
+}
+
+// Returns an empty string when every engine and thread count agrees with the serial reference
+std::string cross_check_search(const FuzzCase& c, std::mt19937_64& rng, const FuzzArguments& args) {
+    std::vector<size_t> magnetic_indices;
+    for (size_t i = 0; i < c.positions.size() && magnetic_indices.size() < args.max_search_sites; ++i) {
+        if (std::uniform_int_distribution<int>(0, 5)(rng) != 0) magnetic_indices.push_back(i);
+    }
+    if (magnetic_indices.empty()) return "";
+
+    const CrystalStructure structure = to_structure(c);
+    const std::vector<size_t> expected = serial_reference_search(c, magnetic_indices, args.tolerance);
+
+    for (SearchEngine engine : {SearchEngine::REFERENCE, SearchEngine::TABLE}) {
+        for (unsigned int threads : {1u, 3u}) {
+            // Spread order visits the same ids in a scrambled order, and the table engine walks
+            // them in Gray-code order by default; the sorted result must not change
+            for (int order = 0; order < 3; ++order) {
+                const bool spread = order == 1;
+                const bool gray = order == 2;
+                if (gray && engine != SearchEngine::TABLE) continue;
+                SearchOptions options;
+                options.engine = engine;
+                options.num_threads = threads;
+                options.spread_order = spread;
+                options.gray_walk = gray;
+                std::vector<size_t> ids;
+                for (const auto& config : run_spin_search(structure, magnetic_indices, args.tolerance, options)) {
+                    ids.push_back(config.configuration_id);
+                }
+                if (ids != expected) {
+                    std::ostringstream msg;
+                    msg << "run_spin_search(engine=" << engine_to_string(engine) << ", threads=" << threads
+                        << (spread ? ", spread order" : "") << (gray ? ", Gray-code walk" : "") << ") found " << ids.size()
+                        << " configurations, serial reference found " << expected.size()
+                        << " (" << magnetic_indices.size() << " magnetic sites)";
+                    return msg.str();
+                }
+            }
+        }
+    }
+
+    const std::string existence = cross_check_existence(c, magnetic_indices, !expected.empty(), "", args.tolerance);
+    if (!existence.empty()) return existence;
+
+    const std::string constrained = cross_check_constrained_search(c, magnetic_indices, expected, rng, args.tolerance);
+    if (!constrained.empty()) return constrained;
+
+    if (magnetic_indices.size() <= 7) {
+        return cross_check_ternary_search(c, magnetic_indices, args.tolerance);
+    }
+    return "";
+}
+
+// Verdicts at tol / 4, tol and 4 tol from one sweep evaluation vs a checker per tolerance; at a
+// flip tolerance the lower verdict must still hold and just above it the upper one
+std::string cross_check_tolerance_sweep(const FuzzCase& c, double tol) {
+    const CrystalStructure structure = to_structure(c);
+    const ToleranceSweep sweep(structure, {tol / 4, tol, std::min(4 * tol, 0.49)});
+    const std::vector<double>& tolerances = sweep.tolerances();
+    auto altermagnetic_at = [&](double t) {
+        return AltermagnetChecker(structure, t).evaluate(c.spins) == CheckOutcome::ALTERMAGNET;
+    };
+
+    std::vector<double> flips;
+    const uint64_t verdicts = sweep.evaluate(c.spins, &flips);
+    for (size_t k = 0; k < tolerances.size(); ++k) {
+        if (((verdicts >> k) & 1) != altermagnetic_at(tolerances[k])) {
+            std::ostringstream msg;
+            msg << "tolerance sweep verdict at " << tolerances[k] << " differs from a checker at that tolerance";
+            return msg.str();
+        }
+    }
+
+    size_t flip = 0;
+    for (size_t k = 0; k + 1 < tolerances.size(); ++k) {
+        const bool lower = (verdicts >> k) & 1;
+        if (lower == (((verdicts >> (k + 1)) & 1) != 0)) continue;
+        if (flip >= flips.size()) return "tolerance sweep reported too few flip tolerances";
+        const double at = flips[flip++];
+        if (!(at >= tolerances[k] && at < tolerances[k + 1]) || altermagnetic_at(at) != lower ||
+            altermagnetic_at(std::nextafter(at, 1.0)) == lower) {
+            std::ostringstream msg;
+            msg << std::setprecision(17) << "tolerance sweep flip " << at << " between " << tolerances[k]
+                << " and " << tolerances[k + 1] << " does not match the checkers";
+            return msg.str();
+        }
+    }
+    if (flip != flips.size()) return "tolerance sweep reported too many flip tolerances";
+    return "";
+}
+
+// Neither a zero displacement nor a uniform scaling of the cell can break a symmetry, so the
+// sweep must keep every operation and reproduce the parent verdict
+std::string cross_check_distortion(const FuzzCase& c, double tol) {
+    const CrystalStructure structure = to_structure(c);
+    std::vector<DistortionMode> modes(2);
+    modes[0].name = "displacement";
+    modes[0].kind = DistortionKind::DISPLACEMENT;
+    for (size_t i = 0; i < c.positions.size(); ++i) {
+        modes[0].displacements.push_back(Vector3d(0.1 * static_cast<double>(i % 3), 0.05, -0.1));
+    }
+    modes[1].name = "isotropic";
+    modes[1].kind = DistortionKind::STRAIN;
+    modes[1].strain = Matrix3d::Identity();
+    const std::vector<double> amplitudes = {0.0, 0.05};
+
+    const CheckOutcome expected = table_outcome(c, tol);
+    for (const auto& step : run_distortion_sweep(structure, modes, amplitudes, c.spins, tol, 2)) {
+        if (step.mode == 0 && step.amplitude != 0.0) continue;
+        if (step.operations != c.symops.size() || step.outcome != expected) {
+            std::ostringstream msg;
+            msg << "distortion " << modes[step.mode].name << " at amplitude " << step.amplitude << " kept "
+                << step.operations << " of " << c.symops.size() << " operations, verdict "
+                << outcome_to_string(step.outcome) << ", parent " << outcome_to_string(expected);
+            return msg.str();
+        }
+    }
+    return "";
+}
+
+// Decorations of every site by a dopant: the classes must partition the subsets, and a dopant on
+// a whole orbit must not cost the derived structure any operation
+std::string cross_check_substitution(const FuzzCase& c, double tol) {
+    const CrystalStructure structure = to_structure(c);
+    const size_t n = c.positions.size();
+    for (size_t count : {static_cast<size_t>(1), std::max<size_t>(1, n / 2)}) {
+        SubstitutionSpec spec;
+        spec.host = "Fe";
+        spec.dopant = "Mn";
+        spec.min_count = spec.max_count = count;
+        const DecorationSet decorations = enumerate_decorations(structure, spec, tol);
+        if (decorations.group_truncated) continue;
+        size_t covered = 0;
+        for (const auto& decoration : decorations.distinct) covered += decoration.multiplicity;
+        if (covered != decorations.total) {
+            std::ostringstream msg;
+            msg << "substitution of " << count << " of " << n << " sites: multiplicities add up to " << covered
+                << ", expected " << decorations.total << " (" << decorations.distinct.size()
+                << " classes, group order " << decorations.group_order << ")";
+            return msg.str();
+        }
+    }
+
+    std::set<int> labels(c.equiv_atoms.begin(), c.equiv_atoms.end());
+    for (int label : labels) {
+        Decoration orbit;
+        for (size_t i = 0; i < n; ++i) {
+            if (c.equiv_atoms[i] == label) orbit.sites.push_back(i);
+        }
+        CrystalStructure derived = decorate(structure, orbit, "Mn");
+        const size_t kept = inherit_subgroup_symmetry(structure, derived, tol);
+        if (kept != c.symops.size()) {
+            std::ostringstream msg;
+            msg << "substituting orbit " << label << " (" << orbit.sites.size() << " sites) kept " << kept << " of "
+                << c.symops.size() << " operations";
+            return msg.str();
+        }
+    }
+    return "";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        FuzzArguments args = parse_arguments(argc, argv);
+        std::mt19937_64 rng(args.seed);
+
+        size_t counts[3] = {0, 0, 0};
+        size_t searches = 0;
+
+        for (size_t iteration = 0; iteration < args.iterations; ++iteration) {
+            FuzzCase c = random_case(rng, args);
+            const CheckOutcome expected = reference_outcome(c, args.tolerance);
+            const CheckOutcome actual = table_outcome(c, args.tolerance);
+            counts[static_cast<int>(expected)]++;
+
+            if (args.verbose) {
+                std::cout << "case " << iteration << ": " << c.symops.size() << " ops, "
+                          << c.positions.size() << " sites -> " << outcome_to_string(expected) << "\n";
+            }
+
+            if (expected != actual) {
+                std::cout << "MISMATCH at iteration " << iteration << " (reproduce with --seed "
+                          << args.seed << " --iterations " << iteration + 1 << ")\n";
+                print_case(std::cout, shrink(c, args.tolerance), args.tolerance);
+                return 1;
+            }
+
+            const std::string sweep = cross_check_tolerance_sweep(c, args.tolerance);
+            if (!sweep.empty()) {
+                std::cout << "SWEEP MISMATCH at iteration " << iteration << " (reproduce with --seed "
+                          << args.seed << " --iterations " << iteration + 1 << ")\n"
+                          << sweep << "\n";
+                print_case(std::cout, c, args.tolerance);
+                return 1;
+            }
+
+            if (args.search_every > 0 && iteration % args.search_every == 0) {
+                std::string failure = cross_check_search(c, rng, args);
+                if (failure.empty()) failure = cross_check_distortion(c, args.tolerance);
+                if (failure.empty()) failure = cross_check_substitution(c, args.tolerance);
+                searches++;
+                if (!failure.empty()) {
+                    std::cout << "SEARCH MISMATCH at iteration " << iteration << " (reproduce with --seed "
+                              << args.seed << " --iterations " << iteration + 1 << ")\n"
+                              << failure << "\n";
+                    print_case(std::cout, c, args.tolerance);
+                    return 1;
+                }
+            }
+        }
+
+        std::cout << "amcheck_fuzz: " << args.iterations << " cases, " << searches << " full searches, seed "
+                  << args.seed << " - no mismatches\n"
+                  << "  altermagnet: " << counts[static_cast<int>(CheckOutcome::ALTERMAGNET)]
+                  << "  not altermagnet: " << counts[static_cast<int>(CheckOutcome::NOT_ALTERMAGNET)]
+                  << "  invalid: " << counts[static_cast<int>(CheckOutcome::INVALID)] << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}